@@ -0,0 +1,195 @@
+// Measures the cost of crossing the N-API boundary: every parameter setter,
+// the batched setParameters() forms, the meter/spectrum getters and
+// processAudio() at each block size. Results are written as JSON in the same
+// layout as process_block_benchmark, so the processAudio cases can be set
+// against processBlock/dry/<blockSize>/44100 to get the per-call overhead.
+//
+//   node bench/napi-benchmark.js [--json results.json] [--filter setVolume] [--min-time 0.1]
+
+const fs = require("fs");
+const os = require("os");
+const path = require("path");
+
+const addonPath = path.join(__dirname, "../build/Release/juce_audio_processor.node");
+const { JUCEAudioProcessor } = require(addonPath);
+
+const blockSizes = [32, 64, 128, 256, 512, 1024, 2048, 4096];
+const sampleRate = 44100;
+const callsPerBatch = 1000;
+
+// The neutral setup of processBlock/dry in the native benchmark
+const dryParameters = {
+  pitchBend: 0,
+  flangerEnabled: false,
+  filterCutoff: 20000,
+  filterResonance: 1,
+  volume: 1,
+  jogWheelTouched: false,
+  playbackRate: 1,
+};
+
+function parseOptions(args) {
+  const options = { json: null, filter: "", minTime: 0.1 };
+  for (let i = 0; i < args.length; i++) {
+    if (args[i] === "--json" && i + 1 < args.length) {
+      options.json = args[++i];
+    } else if (args[i] === "--filter" && i + 1 < args.length) {
+      options.filter = args[++i];
+    } else if (args[i] === "--min-time" && i + 1 < args.length) {
+      options.minTime = Math.max(0.001, Number(args[++i]));
+    } else {
+      throw new Error("Usage: napi-benchmark.js [--json file] [--filter text] [--min-time seconds]");
+    }
+  }
+  return options;
+}
+
+function percentile(sorted, fraction) {
+  return sorted[Math.min(sorted.length - 1, Math.round(fraction * (sorted.length - 1)))];
+}
+
+// Times call() in batches of callsPerBatch until minTime has passed. Each
+// sample is the mean time of one call within a batch, so timer overhead
+// doesn't swamp calls that take well under a microsecond.
+function measure(name, call, minTime, batchSize = callsPerBatch) {
+  for (let i = 0; i < batchSize; i++) {
+    call(i);
+  }
+
+  const samples = [];
+  const cpuStart = process.cpuUsage();
+  const start = process.hrtime.bigint();
+  const minNanoseconds = BigInt(Math.round(minTime * 1e9));
+
+  do {
+    const before = process.hrtime.bigint();
+    for (let i = 0; i < batchSize; i++) {
+      call(i);
+    }
+    samples.push(Number(process.hrtime.bigint() - before) / batchSize);
+  } while (process.hrtime.bigint() - start < minNanoseconds || samples.length < 16);
+
+  const cpu = process.cpuUsage(cpuStart);
+  const iterations = samples.length * batchSize;
+  const mean = samples.reduce((total, sample) => total + sample, 0) / samples.length;
+  samples.sort((a, b) => a - b);
+
+  return {
+    name,
+    run_name: name,
+    run_type: "iteration",
+    iterations,
+    real_time: mean,
+    cpu_time: ((cpu.user + cpu.system) * 1000) / iterations,
+    time_unit: "ns",
+    median_time: percentile(samples, 0.5),
+    p99_time: percentile(samples, 0.99),
+    max_time: samples[samples.length - 1],
+  };
+}
+
+function getCases(processor) {
+  const setters = {
+    setPitchBend: (i) => processor.setPitchBend((i & 7) * 0.25),
+    setFlangerEnabled: (i) => processor.setFlangerEnabled((i & 1) === 1),
+    setFlangerRate: (i) => processor.setFlangerRate(0.5 + (i & 7) * 0.1),
+    setFlangerDepth: (i) => processor.setFlangerDepth((i & 7) * 0.1),
+    setFilterCutoff: (i) => processor.setFilterCutoff(200 + (i & 7) * 1000),
+    setFilterResonance: (i) => processor.setFilterResonance(0.7 + (i & 7) * 0.1),
+    setJogWheelPosition: (i) => processor.setJogWheelPosition(i * 0.01),
+    setVolume: (i) => processor.setVolume((i & 7) * 0.125),
+    setJogWheelTouched: (i) => processor.setJogWheelTouched((i & 1) === 1),
+    setPlaybackRate: (i) => processor.setPlaybackRate(1 + (i & 7) * 0.01),
+  };
+
+  const { Parameters } = JUCEAudioProcessor;
+  const changes = { filterCutoff: 800, filterResonance: 1.2, volume: 0.8 };
+  const packedChanges = new Float32Array([
+    Parameters.filterCutoff, 800, Parameters.filterResonance, 1.2, Parameters.volume, 0.8,
+  ]);
+
+  const cases = [
+    // A call that does nothing but cross the boundary, as the baseline
+    { name: "napi/isInitialized", call: () => processor.isInitialized() },
+    ...Object.entries(setters).map(([method, call]) => ({ name: `napi/${method}`, call })),
+    { name: "napi/setParameters/object/3", call: () => processor.setParameters(changes) },
+    { name: "napi/setParameters/float32/3", call: () => processor.setParameters(packedChanges) },
+    { name: "napi/getLevels", call: () => processor.getLevels() },
+    { name: "napi/getSpectrum", call: () => processor.getSpectrum() },
+    { name: "napi/getPlayPosition", call: () => processor.getPlayPosition() },
+  ];
+
+  for (const blockSize of blockSizes) {
+    const block = new Float32Array(2 * blockSize);
+    for (let i = 0; i < block.length; i++) {
+      block[i] = (Math.random() * 2 - 1) * 0.25;
+    }
+    cases.push({
+      name: `napi/processAudio/${blockSize}/${sampleRate}`,
+      call: () => processor.processAudio(block),
+      batchSize: Math.max(1, Math.round(1024 / blockSize)),
+      blockSize,
+      // Undo the setter cases and run past the parameter ramps
+      prepare: () => {
+        processor.setParameters(dryParameters);
+        for (let done = 0; done < sampleRate; done += blockSize) {
+          processor.processAudio(block);
+        }
+      },
+    });
+  }
+
+  return cases;
+}
+
+function main() {
+  const options = parseOptions(process.argv.slice(2));
+  const processor = new JUCEAudioProcessor();
+
+  processor.prepareToPlay(sampleRate, Math.max(...blockSizes));
+  processor.setParameters(dryParameters);
+
+  const benchmarks = [];
+
+  for (const { name, call, batchSize, blockSize, prepare } of getCases(processor)) {
+    if (options.filter && !name.includes(options.filter)) {
+      continue;
+    }
+
+    if (prepare) {
+      prepare();
+    }
+
+    const result = measure(name, call, options.minTime, batchSize);
+    if (blockSize) {
+      result.block_size = blockSize;
+      result.sample_rate = sampleRate;
+      result.ns_per_sample = result.real_time / blockSize;
+    }
+    process.stderr.write(`${name.padEnd(40)} ${result.real_time.toFixed(1).padStart(12)} ns\n`);
+    benchmarks.push(result);
+  }
+
+  const report = {
+    context: {
+      date: new Date().toISOString(),
+      host_name: os.hostname(),
+      executable: `${process.execPath} ${__filename}`,
+      num_cpus: os.cpus().length,
+      mhz_per_cpu: os.cpus()[0] ? os.cpus()[0].speed : 0,
+      cpu_model: os.cpus()[0] ? os.cpus()[0].model : "",
+      node_version: process.version,
+      napi_version: process.versions.napi,
+    },
+    benchmarks,
+  };
+
+  const json = JSON.stringify(report, null, 2);
+  if (options.json) {
+    fs.writeFileSync(options.json, json);
+  } else {
+    process.stdout.write(json + "\n");
+  }
+}
+
+main();
@@ -0,0 +1,263 @@
+// Times JUCEAudioProcessor::processBlock across block sizes, sample rates and
+// effect setups, and writes the results as JSON in the layout Google Benchmark
+// uses ({ context, benchmarks: [{ name, iterations, real_time, cpu_time,
+// time_unit, ... }] }), so its compare tools can diff two releases.
+//
+//   process_block_benchmark [--json results.json] [--filter flanger/512/] [--min-time 0.1]
+//                           [--precision double] [--stems 4] [--oversample-filter 4]
+
+#include "../src/juce_audio_processor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <vector>
+
+namespace
+{
+    const int blockSizes[] = { 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+    const double sampleRates[] = { 44100.0, 48000.0, 96000.0, 192000.0 };
+
+    // An effect setup: the parameters it sets on a fresh processor and the
+    // level of the noise fed in. "dry" leaves every effect neutral - the pitch
+    // shifter, isolator and filter still run, but at 0 semitones, unity gain
+    // and fully open. "idle" is a deck with nothing playing, past its tail.
+    struct Setup
+    {
+        const char* name;
+        std::vector<std::pair<JUCEAudioProcessor::ParameterId, float>> parameters;
+        float inputLevel = 0.25f;
+    };
+
+    const Setup setups[] = {
+        { "dry",        { { JUCEAudioProcessor::filterCutoffId, 20000.0f } } },
+        { "pitchShift", { { JUCEAudioProcessor::filterCutoffId, 20000.0f }, { JUCEAudioProcessor::pitchBendId, 3.0f } } },
+        { "flanger",    { { JUCEAudioProcessor::filterCutoffId, 20000.0f }, { JUCEAudioProcessor::flangerEnabledId, 1.0f } } },
+        { "eq",         { { JUCEAudioProcessor::filterCutoffId, 20000.0f }, { JUCEAudioProcessor::eqLowId, 0.0f },
+                          { JUCEAudioProcessor::eqHighId, 1.5f } } },
+        { "filter",     { { JUCEAudioProcessor::filterCutoffId, 800.0f }, { JUCEAudioProcessor::filterResonanceId, 2.0f } } },
+        { "all",        { { JUCEAudioProcessor::pitchBendId, 3.0f }, { JUCEAudioProcessor::flangerEnabledId, 1.0f },
+                          { JUCEAudioProcessor::filterCutoffId, 800.0f }, { JUCEAudioProcessor::filterResonanceId, 2.0f } } },
+        { "idle",       { { JUCEAudioProcessor::pitchBendId, 3.0f }, { JUCEAudioProcessor::flangerEnabledId, 1.0f },
+                          { JUCEAudioProcessor::filterCutoffId, 800.0f }, { JUCEAudioProcessor::filterResonanceId, 2.0f } }, 0.0f }
+    };
+
+    struct Options
+    {
+        juce::File jsonFile;
+        juce::String filter;
+        double minSeconds = 0.1;
+        bool doublePrecision = false;
+        int numStems = 1;
+        int filterOversampling = 1;
+    };
+
+    // e.g. "processBlock/flanger/512/48000", which --filter matches against
+    juce::String getCaseName(const Setup& setup, int blockSize, double sampleRate)
+    {
+        return juce::String("processBlock/") + setup.name + "/" + juce::String(blockSize) + "/"
+               + juce::String(juce::roundToInt(sampleRate));
+    }
+
+    double percentile(std::vector<double>& sorted, double fraction)
+    {
+        const auto index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[juce::jmin(index, sorted.size() - 1)];
+    }
+
+    // Runs one case: warms the processor up past its latency and the parameter
+    // ramps, then times single blocks until minSeconds of wall time has passed
+    template <typename SampleType>
+    juce::var runCase(const Setup& setup, int blockSize, double sampleRate, const Options& options)
+    {
+        const int numChannels = 2 * options.numStems;
+        const double minSeconds = options.minSeconds;
+
+        JUCEAudioProcessor processor;
+        processor.setNumStems(options.numStems);
+
+        if (options.filterOversampling > 1) {
+            processor.setFilterOversamplingFactor(options.filterOversampling);
+            processor.setFilterOversampled(true);
+        }
+
+        processor.setProcessingPrecision(std::is_same_v<SampleType, double> ? juce::AudioProcessor::doublePrecision
+                                                                            : juce::AudioProcessor::singlePrecision);
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        for (const auto& [parameter, value] : setup.parameters)
+            processor.setParameter(parameter, value);
+
+        // Noise at -12 dBFS (or silence for idle), copied in before every block
+        juce::Random random(1);
+        juce::AudioBuffer<SampleType> source(numChannels, blockSize);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < blockSize; ++i)
+                source.setSample(channel, i, static_cast<SampleType>((random.nextFloat() * 2.0f - 1.0f) * setup.inputLevel));
+
+        juce::AudioBuffer<SampleType> buffer(numChannels, blockSize);
+        juce::MidiBuffer midi;
+
+        const int warmUpBlocks = juce::jmax(16, static_cast<int>(sampleRate / blockSize));
+
+        for (int block = 0; block < warmUpBlocks; ++block) {
+            buffer.makeCopyOf(source, true);
+            processor.processBlock(buffer, midi);
+        }
+
+        std::vector<double> blockNanoseconds;
+        blockNanoseconds.reserve(static_cast<size_t>(minSeconds * sampleRate / blockSize * 4.0) + 16);
+
+        // Nanosecond resolution - JUCE's high resolution ticks are microseconds on some platforms
+        using Clock = std::chrono::steady_clock;
+        const auto minDuration = std::chrono::duration<double>(minSeconds);
+        const auto startTime = Clock::now();
+        const auto startClock = std::clock();
+        double totalNanoseconds = 0.0;
+
+        do {
+            buffer.makeCopyOf(source, true);
+
+            const auto before = Clock::now();
+            processor.processBlock(buffer, midi);
+            const auto after = Clock::now();
+
+            const double nanoseconds = std::chrono::duration<double, std::nano>(after - before).count();
+            blockNanoseconds.push_back(nanoseconds);
+            totalNanoseconds += nanoseconds;
+        } while (Clock::now() - startTime < minDuration || blockNanoseconds.size() < 16);
+
+        const double cpuNanoseconds = static_cast<double>(std::clock() - startClock) * 1.0e9 / CLOCKS_PER_SEC;
+        const auto iterations = blockNanoseconds.size();
+        const double meanNanoseconds = totalNanoseconds / static_cast<double>(iterations);
+        const double blockDurationNanoseconds = blockSize * 1.0e9 / sampleRate;
+
+        std::sort(blockNanoseconds.begin(), blockNanoseconds.end());
+
+        const auto name = getCaseName(setup, blockSize, sampleRate);
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("name", name);
+        result->setProperty("run_name", name);
+        result->setProperty("run_type", "iteration");
+        result->setProperty("iterations", static_cast<juce::int64>(iterations));
+        result->setProperty("real_time", meanNanoseconds);
+        result->setProperty("cpu_time", cpuNanoseconds / static_cast<double>(iterations));
+        result->setProperty("time_unit", "ns");
+        result->setProperty("effects", setup.name);
+        result->setProperty("precision", std::is_same_v<SampleType, double> ? "double" : "single");
+        result->setProperty("stems", options.numStems);
+        result->setProperty("filter_oversampling", options.filterOversampling);
+        result->setProperty("block_size", blockSize);
+        result->setProperty("sample_rate", sampleRate);
+        result->setProperty("median_time", percentile(blockNanoseconds, 0.5));
+        result->setProperty("p99_time", percentile(blockNanoseconds, 0.99));
+        result->setProperty("max_time", blockNanoseconds.back());
+        result->setProperty("ns_per_sample", meanNanoseconds / blockSize);
+
+        // Fraction of the real-time budget one block takes on average
+        result->setProperty("load", meanNanoseconds / blockDurationNanoseconds);
+        return juce::var(result);
+    }
+
+    juce::var getContext()
+    {
+        auto* context = new juce::DynamicObject();
+        context->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+        context->setProperty("host_name", juce::SystemStats::getComputerName());
+        context->setProperty("executable", juce::File::getSpecialLocation(juce::File::currentExecutableFile).getFullPathName());
+        context->setProperty("num_cpus", juce::SystemStats::getNumCpus());
+        context->setProperty("mhz_per_cpu", juce::SystemStats::getCpuSpeedInMegahertz());
+        context->setProperty("cpu_model", juce::SystemStats::getCpuModel());
+        context->setProperty("juce_version", juce::SystemStats::getJUCEVersion());
+       #if JUCE_DEBUG
+        context->setProperty("library_build_type", "debug");
+       #else
+        context->setProperty("library_build_type", "release");
+       #endif
+        return juce::var(context);
+    }
+
+    bool parseOptions(const juce::StringArray& arguments, Options& options)
+    {
+        for (int i = 0; i < arguments.size(); ++i) {
+            const auto& argument = arguments[i];
+            const bool hasValue = i + 1 < arguments.size();
+
+            if (argument == "--json" && hasValue) {
+                options.jsonFile = juce::File::getCurrentWorkingDirectory().getChildFile(arguments[++i]);
+            } else if (argument == "--filter" && hasValue) {
+                options.filter = arguments[++i];
+            } else if (argument == "--min-time" && hasValue) {
+                options.minSeconds = juce::jmax(0.001, arguments[++i].getDoubleValue());
+            } else if (argument == "--stems" && hasValue
+                       && juce::isPositiveAndNotGreaterThan(arguments[i + 1].getIntValue(), JUCEAudioProcessor::maxStems)) {
+                options.numStems = arguments[++i].getIntValue();
+            } else if (argument == "--oversample-filter" && hasValue
+                       && (arguments[i + 1] == "1" || arguments[i + 1] == "2" || arguments[i + 1] == "4")) {
+                options.filterOversampling = arguments[++i].getIntValue();
+            } else if (argument == "--precision" && hasValue && (arguments[i + 1] == "single" || arguments[i + 1] == "double")) {
+                options.doublePrecision = arguments[++i] == "double";
+            } else {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::StringArray arguments;
+
+    for (int i = 1; i < argc; ++i)
+        arguments.add(argv[i]);
+
+    Options options;
+
+    if (!parseOptions(arguments, options)) {
+        std::fprintf(stderr, "Usage: process_block_benchmark [--json file] [--filter text] [--min-time seconds] [--precision single|double] [--stems count] [--oversample-filter 1|2|4]\n");
+        return 1;
+    }
+
+    juce::Array<juce::var> benchmarks;
+
+    for (const auto& setup : setups) {
+        for (const auto sampleRate : sampleRates) {
+            for (const auto blockSize : blockSizes) {
+                const auto name = getCaseName(setup, blockSize, sampleRate);
+
+                if (options.filter.isNotEmpty() && !name.contains(options.filter))
+                    continue;
+
+                const auto result = options.doublePrecision ? runCase<double>(setup, blockSize, sampleRate, options)
+                                                            : runCase<float>(setup, blockSize, sampleRate, options);
+                std::fprintf(stderr, "%-40s %12.0f ns %8.3f ns/sample %7.2f%% load\n", name.toRawUTF8(),
+                             static_cast<double>(result["real_time"]), static_cast<double>(result["ns_per_sample"]),
+                             static_cast<double>(result["load"]) * 100.0);
+                benchmarks.add(result);
+            }
+        }
+    }
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("context", getContext());
+    report->setProperty("benchmarks", benchmarks);
+
+    const auto json = juce::JSON::toString(juce::var(report));
+
+    if (options.jsonFile != juce::File()) {
+        if (!options.jsonFile.replaceWithText(json)) {
+            std::fprintf(stderr, "Couldn't write %s\n", options.jsonFile.getFullPathName().toRawUTF8());
+            return 1;
+        }
+    } else {
+        std::printf("%s\n", json.toRawUTF8());
+    }
+
+    return 0;
+}
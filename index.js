@@ -67,7 +67,10 @@ function getBinaryPath() {
       try {
         const MockProcessor = require("./src/audio-processor-mock");
         logMessage("✓ Mock implementation loaded for Node.js");
-        return { JUCEAudioProcessor: MockProcessor };
+        return {
+          JUCEAudioProcessor: MockProcessor,
+          DeckEngine: MockProcessor.DeckEngine,
+        };
       } catch (mockErr) {
         logMessage(
           `✗ Failed to load mock implementation: ${mockErr.message}`,
@@ -95,6 +98,8 @@ if (process.versions.electron) {
   if (nativeAddon.JUCEAudioProcessor) {
     logMessage("✓ JUCEAudioProcessor class found in native addon");
     module.exports = nativeAddon.JUCEAudioProcessor;
+    module.exports.DeckEngine = nativeAddon.DeckEngine;
+    module.exports.SharedMemoryChannel = nativeAddon.SharedMemoryChannel;
   } else {
     logMessage(
       "✗ JUCEAudioProcessor not found in native addon exports",
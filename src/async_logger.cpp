@@ -0,0 +1,177 @@
+#include "async_logger.h"
+
+#include <cstdio>
+
+static_assert((AsyncLogger::numSlots & (AsyncLogger::numSlots - 1)) == 0, "numSlots must be a power of two");
+
+AsyncLogger& AsyncLogger::getInstance()
+{
+    static AsyncLogger instance;
+    return instance;
+}
+
+AsyncLogger::AsyncLogger()
+    : juce::Thread("JUCE Audio Processor Logger"),
+      slots(new Slot[numSlots]),
+      logFile(juce::File::getCurrentWorkingDirectory().getChildFile("juce_debug.log"))
+{
+    for (size_t i = 0; i < static_cast<size_t>(numSlots); ++i)
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+
+    startThread(juce::Thread::Priority::low);
+}
+
+AsyncLogger::~AsyncLogger()
+{
+    stopThread(2000);
+    flush();
+}
+
+void AsyncLogger::setLevel(Level newLevel)
+{
+    minimumLevel.store(newLevel);
+}
+
+AsyncLogger::Level AsyncLogger::getLevel() const
+{
+    return static_cast<Level>(minimumLevel.load());
+}
+
+void AsyncLogger::setLogFile(const juce::File& newFile)
+{
+    const juce::ScopedLock sl(writeLock);
+    logFile = newFile;
+    logFileChanged = true;
+}
+
+void AsyncLogger::setEchoToConsole(bool shouldEcho)
+{
+    echoToConsole.store(shouldEcho);
+}
+
+int AsyncLogger::getNumDroppedMessages() const
+{
+    return numDropped.load();
+}
+
+// Claims a slot with a bounded multi-producer ring: a slot is free for the
+// producer at position p once its sequence equals p, and ready for the writer
+// once the producer has published p + 1
+void AsyncLogger::log(Level level, const char* format, ...)
+{
+    if (!isEnabled(level))
+        return;
+
+    size_t position = writePosition.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+
+    for (;;) {
+        slot = &slots[position & static_cast<size_t>(numSlots - 1)];
+        const auto sequence = slot->sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+
+        if (difference == 0) {
+            if (writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        } else if (difference < 0) {
+            // The writer hasn't caught up - never block the caller
+            numDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            position = writePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->level = level;
+    slot->timeMillis = juce::Time::currentTimeMillis();
+
+    va_list args;
+    va_start(args, format);
+    std::vsnprintf(slot->text, maxMessageLength, format, args);
+    va_end(args);
+
+    slot->sequence.store(position + 1, std::memory_order_release);
+}
+
+void AsyncLogger::flush()
+{
+    const juce::ScopedLock sl(writeLock);
+    writePendingMessages();
+}
+
+void AsyncLogger::run()
+{
+    while (!threadShouldExit()) {
+        wait(pollIntervalMs);
+
+        const juce::ScopedLock sl(writeLock);
+        writePendingMessages();
+    }
+}
+
+void AsyncLogger::writePendingMessages()
+{
+    pendingText.reset();
+
+    for (;;) {
+        Slot& slot = slots[readPosition & static_cast<size_t>(numSlots - 1)];
+
+        if (slot.sequence.load(std::memory_order_acquire) != readPosition + 1)
+            break;
+
+        pendingText << "[" << juce::Time(slot.timeMillis).formatted("%Y-%m-%d %H:%M:%S") << "] ["
+                    << juce::String(getLevelName(slot.level)).toUpperCase() << "] " << slot.text << "\n";
+
+        slot.sequence.store(readPosition + static_cast<size_t>(numSlots), std::memory_order_release);
+        ++readPosition;
+    }
+
+    const int dropped = numDropped.load();
+
+    if (dropped != numDroppedReported) {
+        pendingText << "[" << juce::Time::getCurrentTime().formatted("%Y-%m-%d %H:%M:%S") << "] [WARNING] "
+                    << (dropped - numDroppedReported) << " log messages dropped\n";
+        numDroppedReported = dropped;
+    }
+
+    if (pendingText.getDataSize() == 0)
+        return;
+
+    if (logFileChanged) {
+        stream = std::make_unique<juce::FileOutputStream>(logFile);
+        logFileChanged = false;
+    }
+
+    if (stream != nullptr && stream->openedOk()) {
+        stream->write(pendingText.getData(), pendingText.getDataSize());
+        stream->flush();
+    }
+
+    if (echoToConsole.load()) {
+        std::fwrite(pendingText.getData(), 1, pendingText.getDataSize(), stderr);
+        std::fflush(stderr);
+    }
+}
+
+const char* AsyncLogger::getLevelName(Level level)
+{
+    switch (level) {
+        case debug:   return "debug";
+        case info:    return "info";
+        case warning: return "warning";
+        case error:   return "error";
+        default:      return "off";
+    }
+}
+
+bool AsyncLogger::getLevelForName(juce::StringRef name, Level& level)
+{
+    for (auto candidate : { debug, info, warning, error, off }) {
+        if (name == juce::StringRef(getLevelName(candidate))) {
+            level = candidate;
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <atomic>
+#include <cstdarg>
+#include <memory>
+
+// Process-wide logger that never touches the disk on the calling thread.
+// Messages are formatted straight into a preallocated ring of fixed-size slots
+// (lock-free, any number of producer threads) and a background thread writes
+// them to the log file in batches. Messages below the current level return
+// before any formatting, so disabled logging costs one atomic load.
+class AsyncLogger : private juce::Thread
+{
+public:
+    enum Level
+    {
+        debug,
+        info,
+        warning,
+        error,
+        off
+    };
+
+    static constexpr int numSlots = 1024;
+    static constexpr int maxMessageLength = 240;
+
+    static AsyncLogger& getInstance();
+
+    ~AsyncLogger() override;
+
+    void setLevel(Level newLevel);
+    Level getLevel() const;
+    bool isEnabled(Level level) const noexcept { return level >= minimumLevel.load(std::memory_order_relaxed); }
+
+    // The file is opened once by the writer thread and kept open
+    void setLogFile(const juce::File& newFile);
+
+    // Also copies every written line to stderr
+    void setEchoToConsole(bool shouldEcho);
+
+    // printf-style. Messages longer than maxMessageLength are truncated, and
+    // messages arriving while the ring is full are dropped and counted.
+    void log(Level level, const char* format, ...);
+
+    // Blocks until everything logged so far has been written - control threads only
+    void flush();
+
+    int getNumDroppedMessages() const;
+
+    static const char* getLevelName(Level level);
+    static bool getLevelForName(juce::StringRef name, Level& level);
+
+private:
+    AsyncLogger();
+
+    struct Slot
+    {
+        std::atomic<size_t> sequence { 0 };
+        Level level = info;
+        juce::int64 timeMillis = 0;
+        char text[maxMessageLength];
+    };
+
+    static constexpr int pollIntervalMs = 50;
+
+    void run() override;
+    void writePendingMessages();
+
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<size_t> writePosition { 0 };
+    std::atomic<int> minimumLevel { info };
+    std::atomic<int> numDropped { 0 };
+    std::atomic<bool> echoToConsole { false };
+
+    // Only touched while holding writeLock, by the writer thread or flush()
+    juce::CriticalSection writeLock;
+    size_t readPosition = 0;
+    int numDroppedReported = 0;
+    juce::File logFile;
+    bool logFileChanged = true;
+    std::unique_ptr<juce::FileOutputStream> stream;
+    juce::MemoryOutputStream pendingText;
+
+    JUCE_DECLARE_NON_COPYABLE(AsyncLogger)
+};
@@ -19,29 +19,157 @@ function logMessage(message, level = "INFO") {
 }
 
 let JUCEAudioProcessor;
+let SharedMemoryChannel = null;
+let implementation;
 
-// Skip native addon loading entirely in child process for now
-// This avoids the crashpad issues
-logMessage(
-  "Skipping native addon loading in child process to avoid crashes..."
-);
-logMessage("Using mock implementation directly...");
-
-try {
-  // Go straight to mock implementation
-  JUCEAudioProcessor = require("./audio-processor-mock");
-  logMessage("✓ Mock implementation loaded in child process");
-} catch (mockError) {
-  logMessage(
-    `✗ Failed to load mock implementation: ${mockError.message}`,
-    "ERROR"
+// A forked child runs on the parent's runtime, so under Electron this loads
+// the Electron build of the addon. JUCE_AUDIO_PROCESSOR_MOCK=1 forces the mock.
+if (process.env.JUCE_AUDIO_PROCESSOR_MOCK !== "1") {
+  try {
+    const nativeAddon = require("../build/Release/juce_audio_processor.node");
+    JUCEAudioProcessor = nativeAddon.JUCEAudioProcessor;
+    SharedMemoryChannel = nativeAddon.SharedMemoryChannel || null;
+    implementation = "native";
+    logMessage("✓ Native addon loaded in child process");
+  } catch (nativeError) {
+    logMessage(
+      `✗ Failed to load native addon: ${nativeError.message}`,
+      "WARN"
+    );
+  }
+}
+
+if (!JUCEAudioProcessor) {
+  try {
+    JUCEAudioProcessor = require("./audio-processor-mock");
+    implementation = "mock";
+    logMessage("✓ Mock implementation loaded in child process");
+  } catch (mockError) {
+    logMessage(
+      `✗ Failed to load mock implementation: ${mockError.message}`,
+      "ERROR"
+    );
+    process.exit(1);
+  }
+}
+
+// Shared memory channel to the parent, when it offered one and the native addon is loaded
+let channel = null;
+
+// IPC messages handled so far, and a shared memory request held back until more have been
+let ipcReceived = 0;
+let heldMessage = null;
+let listening = false;
+
+// The listener is paused while a message is held back, so it doesn't keep
+// waking up for messages that can't be handled until the next IPC message
+function setListening(shouldListen) {
+  if (listening !== shouldListen) {
+    channel.onReceive(shouldListen ? drainChannel : null);
+    listening = shouldListen;
+  }
+}
+
+function openChannel(name) {
+  if (!name || !SharedMemoryChannel) {
+    return false;
+  }
+
+  try {
+    channel = SharedMemoryChannel.open(name);
+    setListening(true);
+    return true;
+  } catch (error) {
+    logMessage(`Cannot open shared memory channel: ${error.message}`, "WARN");
+    channel = null;
+    return false;
+  }
+}
+
+// Handles shared memory messages in the order they were written: parameter
+// changes, audio requests, and fences that hold everything after them back
+// until the IPC messages sent before them have been handled
+function drainChannel() {
+  if (!channel || !process.processor) {
+    return;
+  }
+
+  let message;
+
+  while ((message = heldMessage || channel.receive()) !== null) {
+    heldMessage = null;
+
+    try {
+      if (typeof message !== "string") {
+        process.processor.setParameters(message);
+        continue;
+      }
+
+      const request = JSON.parse(message);
+
+      if (request.after !== undefined) {
+        if (request.after > ipcReceived) {
+          heldMessage = message;
+          setListening(false);
+          return;
+        }
+        continue;
+      }
+
+      processChannelRequest(request);
+    } catch (error) {
+      logMessage(`Error handling shared memory message: ${error.message}`, "ERROR");
+    }
+  }
+
+  setListening(true);
+}
+
+// Reads the block for an audio request and sends it back processed, falling
+// back to an IPC reply for errors or if the block doesn't fit
+function processChannelRequest({ id, method, numChannels, interleaved, length }) {
+  const reply = (result, error) => {
+    if (error) {
+      logMessage(`Method ${method} failed: ${error.message}`, "ERROR");
+      process.send({ type: "method_result", id, error: error.message, success: false });
+    } else if (!(result instanceof Float32Array) || !channel || !channel.writeAudio(result, id)) {
+      process.send({ type: "method_result", id, result, success: true });
+    }
+  };
+
+  let result;
+  try {
+    // Blocks left behind by a request that couldn't be sent are skipped
+    const buffer = new Float32Array(length);
+    let block;
+
+    do {
+      block = channel.readAudio(buffer);
+    } while (block !== null && block.tag !== id);
+
+    if (block === null) {
+      throw new Error("Audio block missing from shared memory");
+    }
+
+    result = process.processor[method](buffer, numChannels, interleaved);
+  } catch (error) {
+    reply(undefined, error);
+    return;
+  }
+
+  Promise.resolve(result).then(
+    (value) => reply(value),
+    (error) => reply(undefined, error)
   );
-  process.exit(1);
 }
 
 // Handle IPC messages from parent process
 process.on("message", (msg) => {
   try {
+    // Shared memory messages written before this one come first
+    drainChannel();
+    ipcReceived++;
+
     if (msg.type === "create") {
       logMessage("Creating processor instance...");
       const processor = new JUCEAudioProcessor();
@@ -53,29 +181,52 @@ process.on("message", (msg) => {
         type: "created",
         success: true,
         initialized: processor.isInitialized(),
+        implementation,
+        sharedMemory: openChannel(msg.channel),
       });
+    } else if (msg.type === "parameters") {
+      // Coalesced parameter changes, which are never answered
+      if (!process.processor) {
+        throw new Error("Processor not created yet");
+      }
+
+      process.processor.setParameters(msg.changes);
     } else if (msg.type === "method") {
-      const { method, args } = msg;
+      const { id, method, args } = msg;
 
       if (!process.processor) {
         throw new Error("Processor not created yet");
       }
 
-      logMessage(`Calling method: ${method} with args:`, args);
+      // Replies carry the request's sequence number, and asynchronous methods
+      // are answered once they settle, so calls can finish out of order.
+      // Calls without a number are not answered. The method itself runs
+      // straight away, keeping it in order with the messages around it.
+      const reply = (result, error) => {
+        if (error) {
+          logMessage(`Method ${method} failed: ${error.message}`, "ERROR");
+        }
+        if (id !== undefined) {
+          process.send(
+            error
+              ? { type: "method_result", id, error: error.message, success: false }
+              : { type: "method_result", id, result, success: true }
+          );
+        }
+      };
 
       let result;
-      if (args && args.length > 0) {
-        result = process.processor[method](...args);
-      } else {
-        result = process.processor[method]();
+      try {
+        result = process.processor[method](...(args || []));
+      } catch (error) {
+        reply(undefined, error);
+        return;
       }
 
-      process.send({
-        type: "method_result",
-        method: method,
-        result: result,
-        success: true,
-      });
+      Promise.resolve(result).then(
+        (value) => reply(value),
+        (error) => reply(undefined, error)
+      );
     } else if (msg.type === "ping") {
       process.send({ type: "pong" });
     }
@@ -87,6 +238,18 @@ process.on("message", (msg) => {
       success: false,
     });
   }
+
+  // Release shared memory messages that were waiting for this one
+  drainChannel();
+});
+
+// The channel's listener would otherwise keep an orphaned child alive
+process.on("disconnect", () => {
+  if (channel) {
+    channel.close();
+    channel = null;
+    listening = false;
+  }
 });
 
 // Handle uncaught exceptions
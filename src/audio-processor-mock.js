@@ -3,22 +3,158 @@
 
 const fs = require("fs");
 
+const logLevels = ["debug", "info", "warning", "error", "off"];
+let logLevel = "info";
+let logFile = "juce_debug.log";
+let logToConsole = true;
+
 // Enhanced logging function
 function logMessage(message, level = "INFO") {
+  if (logLevels.indexOf(level.toLowerCase()) < logLevels.indexOf(logLevel)) {
+    return;
+  }
+
   const timestamp = new Date().toISOString();
   const logEntry = `[${timestamp}] [${level}] [MOCK] ${message}\n`;
 
   // Log to console
-  console.log(logEntry.trim());
+  if (logToConsole) {
+    console.log(logEntry.trim());
+  }
 
   // Log to file
   try {
-    fs.appendFileSync("juce_debug.log", logEntry);
+    fs.appendFileSync(logFile, logEntry);
   } catch (err) {
     console.error("Failed to write to log file:", err.message);
   }
 }
 
+// Parameter IDs for the Float32Array form of setParameters()
+const Parameters = Object.freeze({
+  pitchBend: 0,
+  flangerEnabled: 1,
+  flangerRate: 2,
+  flangerDepth: 3,
+  filterCutoff: 4,
+  filterResonance: 5,
+  jogWheelPosition: 6,
+  volume: 7,
+  jogWheelTouched: 8,
+  playing: 9,
+  playbackRate: 10,
+  seekPosition: 11,
+  eqLow: 12,
+  eqMid: 13,
+  eqHigh: 14,
+});
+
+// Effect settings saved by getState() and held by presets
+const stateParameters = [
+  "pitchBend",
+  "flangerEnabled",
+  "flangerRate",
+  "flangerDepth",
+  "filterCutoff",
+  "filterResonance",
+  "volume",
+  "eqLow",
+  "eqMid",
+  "eqHigh",
+];
+const numPresetSlots = 16;
+
+// Offsets of the values setMeterBuffer() writes, in floats
+const MeterFields = Object.freeze({
+  sequence: 0,
+  peakLeft: 1,
+  peakRight: 2,
+  rmsLeft: 3,
+  rmsRight: 4,
+  momentaryLoudness: 5,
+  shortTermLoudness: 6,
+  integratedLoudness: 7,
+  correlation: 8,
+  length: 9,
+});
+
+// Layout of the frames setSpectrumBuffer() writes, in floats
+const numSpectrumBands = 64;
+const SpectrumFields = Object.freeze({
+  sequence: 0,
+  levels: 1,
+  peaks: 1 + numSpectrumBands,
+  numBands: numSpectrumBands,
+  length: 1 + 2 * numSpectrumBands,
+});
+
+// The mock doesn't analyse anything: every band stays at the -100 dB floor
+function silentSpectrum() {
+  const frequencies = new Float32Array(numSpectrumBands).map(
+    (_, band) => 20 * Math.pow(1000, (band + 0.5) / numSpectrumBands)
+  );
+  return {
+    frequencies,
+    levels: new Float32Array(numSpectrumBands).fill(-100),
+    peaks: new Float32Array(numSpectrumBands).fill(-100),
+  };
+}
+
+function checkSpectrumBuffer(buffer) {
+  if (buffer !== null && buffer !== undefined && !(buffer instanceof Float32Array)) {
+    throw new TypeError("Expected a Float32Array or null");
+  }
+  if (buffer && buffer.length < SpectrumFields.length) {
+    throw new RangeError(`The spectrum buffer needs at least ${SpectrumFields.length} floats`);
+  }
+  if (buffer) {
+    buffer.fill(-100, SpectrumFields.levels, SpectrumFields.length);
+  }
+}
+
+// Saved states match the native format: "JAPS", a version byte and a count
+// byte, then a parameter ID byte and a little-endian float for each setting
+function encodeState(values) {
+  const state = Buffer.alloc(6 + 5 * stateParameters.length);
+  state.write("JAPS", 0, "latin1");
+  state[4] = 1;
+  state[5] = stateParameters.length;
+  stateParameters.forEach((name, i) => {
+    state[6 + 5 * i] = Parameters[name];
+    state.writeFloatLE(Number(values[name]), 7 + 5 * i);
+  });
+  return state;
+}
+
+// Returns the settings in a saved state keyed by name, or null if it isn't one
+function decodeState(state) {
+  const bytes = ArrayBuffer.isView(state)
+    ? Buffer.from(state.buffer, state.byteOffset, state.byteLength)
+    : Buffer.from(state);
+  if (bytes.length < 6 || bytes.toString("latin1", 0, 4) !== "JAPS" || bytes[4] < 1 ||
+      bytes.length < 6 + 5 * bytes[5]) {
+    return null;
+  }
+  const names = Object.keys(Parameters);
+  const values = {};
+  for (let i = 0; i < bytes[5]; i++) {
+    const name = names[bytes[6 + 5 * i]];
+    if (stateParameters.includes(name)) {
+      values[name] = bytes.readFloatLE(7 + 5 * i);
+    }
+  }
+  return values;
+}
+
+function checkPresetSlot(slot) {
+  if (typeof slot !== "number") {
+    throw new TypeError("Preset slot expected");
+  }
+  if (!(slot >= 0 && slot < numPresetSlots)) {
+    throw new RangeError(`Preset slot must be between 0 and ${numPresetSlots - 1}`);
+  }
+}
+
 class JUCEAudioProcessorMock {
   constructor() {
     this.isInitializedFlag = false;
@@ -29,7 +165,11 @@ class JUCEAudioProcessorMock {
     this.filterCutoff = 1000;
     this.filterResonance = 1.0;
     this.pitchBend = 0;
-    this.jogWheelPosition = 0.5;
+    this.jogWheelPosition = 0;
+    this.playbackRate = 1.0;
+    this.eqLow = 1.0;
+    this.eqMid = 1.0;
+    this.eqHigh = 1.0;
 
     logMessage("Mock JUCEAudioProcessor created");
 
@@ -74,24 +214,424 @@ class JUCEAudioProcessorMock {
     logMessage(`Filter resonance set to: ${this.filterResonance}`);
   }
 
+  setEqLow(gain) {
+    this.eqLow = Math.max(0, Math.min(2, gain));
+    logMessage(`EQ low set to: ${this.eqLow}`);
+  }
+
+  setEqMid(gain) {
+    this.eqMid = Math.max(0, Math.min(2, gain));
+    logMessage(`EQ mid set to: ${this.eqMid}`);
+  }
+
+  setEqHigh(gain) {
+    this.eqHigh = Math.max(0, Math.min(2, gain));
+    logMessage(`EQ high set to: ${this.eqHigh}`);
+  }
+
   setPitchBend(semitones) {
     this.pitchBend = semitones;
     logMessage(`Pitch bend set to: ${this.pitchBend} semitones`);
   }
 
-  setJogWheelPosition(position) {
-    this.jogWheelPosition = Math.max(0, Math.min(1, position));
+  setJogWheelPosition(revolutions) {
+    this.jogWheelPosition = revolutions;
     logMessage(`Jog wheel position set to: ${this.jogWheelPosition}`);
   }
 
-  processAudio(buffer) {
+  setJogWheelTouched(touched) {
+    this.jogWheelTouched = Boolean(touched);
+    logMessage(`Jog wheel touched: ${this.jogWheelTouched}`);
+  }
+
+  // The mock only keeps track of the play position, it doesn't render the track
+  loadTrack(buffer, sampleRate, numChannels = 2, interleaved = false) {
+    const numSamples = Array.isArray(buffer)
+      ? buffer[0].length
+      : buffer.length / numChannels;
+    this.trackLength = numSamples / sampleRate;
+    this.playPosition = 0;
+    this.playing = false;
+    logMessage(`Track loaded: ${this.trackLength}s`);
+  }
+
+  unloadTrack() {
+    this.trackLength = 0;
+    this.playPosition = 0;
+    this.playing = false;
+    logMessage("Track unloaded");
+  }
+
+  play() {
+    this.playing = true;
+    logMessage("Playing");
+  }
+
+  pause() {
+    this.playing = false;
+    logMessage("Paused");
+  }
+
+  setPlaybackRate(rate) {
+    this.playbackRate = Math.max(-8, Math.min(8, rate));
+    logMessage(`Playback rate set to: ${this.playbackRate}`);
+  }
+
+  seek(seconds) {
+    this.playPosition = Math.max(0, seconds);
+    logMessage(`Seek to: ${this.playPosition}s`);
+  }
+
+  getPlayPosition() {
+    return this.playPosition || 0;
+  }
+
+  getTrackLength() {
+    return this.trackLength || 0;
+  }
+
+  setPitchShiftQuality(quality) {
+    if (!["fast", "normal", "high"].includes(quality)) {
+      throw new TypeError(`Unknown pitch shift quality: ${quality}`);
+    }
+    this.pitchShiftQuality = quality;
+    logMessage(`Pitch shift quality set to: ${quality}`);
+  }
+
+  getLatencySamples() {
+    return 0;
+  }
+
+  setStemCount(numStems) {
+    if (!Number.isInteger(numStems) || numStems < 1 || numStems > 8) {
+      throw new RangeError("The stem count must be between 1 and 8");
+    }
+    this.numStems = numStems;
+    logMessage(`Stem count set to: ${numStems}`);
+  }
+
+  getStemCount() {
+    return this.numStems || 1;
+  }
+
+  setFilterOversamplingFactor(factor) {
+    if (factor !== 2 && factor !== 4) {
+      throw new RangeError("The oversampling factor must be 2 or 4");
+    }
+    this.filterOversamplingFactor = factor;
+    logMessage(`Filter oversampling factor set to: ${factor}`);
+  }
+
+  getFilterOversamplingFactor() {
+    return this.filterOversamplingFactor || 2;
+  }
+
+  setFilterOversampled(enabled) {
+    this.filterOversampled = Boolean(enabled);
+    logMessage(`Filter oversampling ${this.filterOversampled ? "enabled" : "disabled"}`);
+  }
+
+  setSmoothingTime(seconds) {
+    this.smoothingTime = Math.max(0, seconds);
+    logMessage(`Smoothing time set to: ${this.smoothingTime}s`);
+  }
+
+  setParameters(changes) {
+    const entries = ArrayBuffer.isView(changes)
+      ? Array.from({ length: changes.length / 2 }, (_, i) => [
+          Object.keys(Parameters)[changes[2 * i]],
+          changes[2 * i + 1],
+        ])
+      : Object.entries(changes);
+
+    entries.forEach(([name, value]) => {
+      if (!(name in Parameters)) {
+        throw new TypeError(`Unknown parameter: ${name}`);
+      }
+      if (name === "seekPosition") {
+        this.seek(value);
+      } else {
+        this[name] =
+          name === "flangerEnabled" || name === "jogWheelTouched" || name === "playing"
+            ? Boolean(value)
+            : value;
+      }
+    });
+    logMessage(`Set ${entries.length} parameters`);
+  }
+
+  getState() {
+    return encodeState(this);
+  }
+
+  setState(state) {
+    const values = decodeState(state);
+    if (!values) {
+      throw new TypeError("Not a saved processor state");
+    }
+    this.setParameters(values);
+  }
+
+  storePreset(slot) {
+    checkPresetSlot(slot);
+    this.presets = this.presets || [];
+    this.presets[Math.trunc(slot)] = decodeState(encodeState(this));
+  }
+
+  recallPreset(slot) {
+    checkPresetSlot(slot);
+    const preset = this.presets && this.presets[Math.trunc(slot)];
+    if (!preset) {
+      return false;
+    }
+    this.setParameters(preset);
+    return true;
+  }
+
+  prepareToPlay(sampleRate, maximumBlockSize) {
+    this.sampleRate = sampleRate;
+    this.maximumBlockSize = maximumBlockSize;
+    logMessage(
+      `Prepared for ${sampleRate}Hz, ${maximumBlockSize} samples per block`
+    );
+  }
+
+  processAudio(buffer, numChannels = 2 * this.getStemCount(), interleaved = false) {
     // Mock audio processing - in real implementation this would process the buffer
+    const byteLength = Array.isArray(buffer)
+      ? buffer.reduce((total, channel) => total + channel.byteLength, 0)
+      : buffer
+      ? buffer.byteLength
+      : 0;
     logMessage(
-      `Processing audio buffer of size: ${buffer ? buffer.byteLength : 0} bytes`
+      `Processing audio buffer of size: ${byteLength} bytes (${numChannels} channels, ${
+        interleaved ? "interleaved" : "planar"
+      })`
     );
+    if (this.playing && this.trackLength) {
+      const numSamples = Array.isArray(buffer)
+        ? buffer[0].length
+        : buffer.length / numChannels;
+      this.playPosition +=
+        (numSamples / (this.sampleRate || 44100)) * this.playbackRate;
+    }
+    this.measureLevels(buffer, numChannels, interleaved);
     return buffer; // Return the same buffer for now
   }
 
+  // The mock meters each block on its own, without ballistics or K-weighting
+  measureLevels(buffer, numChannels, interleaved) {
+    const samples = Array.isArray(buffer)
+      ? buffer
+      : ArrayBuffer.isView(buffer)
+      ? [buffer]
+      : [new Float32Array(buffer || 0)];
+    const channel = (c, i) => {
+      if (samples.length > 1) {
+        return samples[Math.min(c, samples.length - 1)][i];
+      }
+      const frames = samples[0].length / numChannels;
+      const index = interleaved ? i * numChannels + c : c * frames + i;
+      return samples[0][numChannels > 1 ? index : i];
+    };
+    const frames = samples.length > 1 ? samples[0].length : samples[0].length / numChannels;
+    const peak = [0, 0];
+    const sums = [0, 0];
+    let product = 0;
+    for (let i = 0; i < frames; i++) {
+      const left = channel(0, i);
+      const right = channel(1, i);
+      peak[0] = Math.max(peak[0], Math.abs(left));
+      peak[1] = Math.max(peak[1], Math.abs(right));
+      sums[0] += left * left;
+      sums[1] += right * right;
+      product += left * right;
+    }
+    const loudness = frames > 0 && sums[0] + sums[1] > 0
+      ? -0.691 + 10 * Math.log10((sums[0] + sums[1]) / frames)
+      : -Infinity;
+    this.levels = {
+      peak,
+      rms: sums.map((sum) => (frames > 0 ? Math.sqrt(sum / frames) : 0)),
+      momentaryLoudness: loudness,
+      shortTermLoudness: loudness,
+      integratedLoudness: loudness,
+      correlation: sums[0] * sums[1] > 0 ? product / Math.sqrt(sums[0] * sums[1]) : 0,
+    };
+
+    if (this.meterBuffer) {
+      const sequence = new Uint32Array(this.meterBuffer.buffer, this.meterBuffer.byteOffset, 1);
+      const values = [
+        this.levels.peak[0],
+        this.levels.peak[1],
+        this.levels.rms[0],
+        this.levels.rms[1],
+        loudness,
+        loudness,
+        loudness,
+        this.levels.correlation,
+      ];
+      sequence[0] += 2;
+      this.meterBuffer.set(values, MeterFields.peakLeft);
+    }
+  }
+
+  getLevels() {
+    return (
+      this.levels || {
+        peak: [0, 0],
+        rms: [0, 0],
+        momentaryLoudness: -Infinity,
+        shortTermLoudness: -Infinity,
+        integratedLoudness: -Infinity,
+        correlation: 0,
+      }
+    );
+  }
+
+  setMeterBuffer(buffer) {
+    if (buffer !== null && buffer !== undefined && !(buffer instanceof Float32Array)) {
+      throw new TypeError("Expected a Float32Array or null");
+    }
+    if (buffer && buffer.length < MeterFields.length) {
+      throw new RangeError(`The meter buffer needs at least ${MeterFields.length} floats`);
+    }
+    this.meterBuffer = buffer || null;
+  }
+
+  resetLoudness() {
+    logMessage("Integrated loudness reset");
+  }
+
+  setSpectrumEnabled(enabled) {
+    if (typeof enabled !== "boolean") {
+      throw new TypeError("Boolean expected");
+    }
+    logMessage(`Spectrum analyser ${enabled ? "enabled" : "disabled"}`);
+  }
+
+  getSpectrum() {
+    return silentSpectrum();
+  }
+
+  setSpectrumBuffer(buffer) {
+    checkSpectrumBuffer(buffer);
+  }
+
+  // The mock has no audio thread to time, so every counter stays at zero
+  getPerformanceStats() {
+    const percentiles = () => ({ median: 0, p99: 0, p999: 0, max: 0 });
+    return {
+      load: 0,
+      deadlineMisses: 0,
+      blocks: 0,
+      idleBlocks: 0,
+      budget: ((this.maximumBlockSize || 512) / (this.sampleRate || 44100)) * 1e6,
+      meanBlockTime: 0,
+      blockTime: percentiles(),
+      callbackJitter: percentiles(),
+      stages: { parameters: 0, scratch: 0, pitchShift: 0, eq: 0, flanger: 0, filter: 0, volume: 0, metering: 0 },
+      histogram: [],
+      xruns: 0,
+    };
+  }
+
+  resetPerformanceStats() {
+    logMessage("Performance stats reset");
+  }
+
+  processAudioAsync(buffer, numChannels = 2, interleaved = false) {
+    return Promise.resolve(this.processAudio(buffer, numChannels, interleaved));
+  }
+
+  processAudioBatch(buffers, numChannels = 2, interleaved = false) {
+    buffers.forEach((buffer) =>
+      this.processAudio(buffer, numChannels, interleaved)
+    );
+    return Promise.resolve(buffers);
+  }
+
+  startAudioDevice(options = {}) {
+    this.audioDeviceRunning = true;
+    logMessage(`Audio device started: ${options.type || "default"}`);
+    return {
+      type: options.type || "Null",
+      name: "Mock Audio Device",
+      sampleRate: options.sampleRate || 44100,
+      bufferSize: options.bufferSize || 256,
+      inputLatency: 0,
+      outputLatency: 0,
+    };
+  }
+
+  stopAudioDevice() {
+    this.audioDeviceRunning = false;
+    logMessage("Audio device stopped");
+  }
+
+  isAudioDeviceRunning() {
+    return Boolean(this.audioDeviceRunning);
+  }
+
+  getAudioDeviceTypes() {
+    return [
+      { type: "Null", outputs: ["Null Audio Device"], inputs: ["Null Audio Device"] },
+    ];
+  }
+
+  getMeters() {
+    return { levels: this.audioDeviceRunning ? [0, 0] : [], cpuUsage: 0, xruns: 0 };
+  }
+
+  static setLogLevel(level) {
+    if (!logLevels.includes(level)) {
+      throw new TypeError(`Unknown log level: ${level}`);
+    }
+    logLevel = level;
+  }
+
+  static getLogLevel() {
+    return logLevel;
+  }
+
+  static setLogFile(path) {
+    logFile = path;
+  }
+
+  static setLogToConsole(enabled) {
+    logToConsole = Boolean(enabled);
+  }
+
+  // The mock copies the input unchanged
+  static renderFile(inputPath, outputPath, options = {}) {
+    return fs.promises.copyFile(inputPath, outputPath).then(() => {
+      if (options.onProgress) {
+        options.onProgress(1);
+      }
+      logMessage(`Rendered ${inputPath} to ${outputPath}`);
+      return { numSamples: 0, sampleRate: 0, numChannels: 0 };
+    });
+  }
+
+  static renderBuffer(buffer, sampleRate, options = {}) {
+    const numChannels = options.numChannels || 2;
+    if (!Array.isArray(buffer) && buffer.length % numChannels !== 0) {
+      return Promise.reject(new TypeError("Buffer length must be a multiple of the channel count"));
+    }
+    const frames = buffer.length / numChannels;
+    const channels = Array.isArray(buffer)
+      ? buffer.map((channel) => Float32Array.from(channel))
+      : Array.from({ length: numChannels }, (_, channel) =>
+          options.interleaved
+            ? Float32Array.from({ length: frames }, (_, i) => buffer[i * numChannels + channel])
+            : buffer.slice(channel * frames, (channel + 1) * frames)
+        );
+    if (options.onProgress) {
+      options.onProgress(1);
+    }
+    return Promise.resolve(channels);
+  }
+
   // Additional methods for getting current state
   getVolume() {
     return this.volume;
@@ -126,5 +666,103 @@ class JUCEAudioProcessorMock {
   }
 }
 
+// Mixes the decks with their gains and the crossfader, without any effects
+class DeckEngineMock {
+  constructor(numDecks = 4) {
+    this.numDecks = numDecks;
+    this.gains = new Array(numDecks).fill(1);
+    this.sides = new Array(numDecks).fill("thru");
+    this.crossfader = 0.5;
+    this.masterVolume = 1.0;
+  }
+
+  prepareToPlay() {}
+
+  process(inputs, output) {
+    const deckLength = output.length;
+    const lengths = Array.isArray(inputs) ? inputs.map((input) => input.length) : [inputs.length / this.numDecks];
+    if (lengths.some((length) => length !== deckLength)) {
+      throw new TypeError("Every deck input must be a Float32Array as long as the output");
+    }
+    output.fill(0);
+
+    for (let deck = 0; deck < this.numDecks; deck++) {
+      const input = Array.isArray(inputs)
+        ? inputs[deck]
+        : inputs.subarray(deck * deckLength, (deck + 1) * deckLength);
+      let gain = this.gains[deck] * this.masterVolume;
+
+      if (this.sides[deck] === "A") {
+        gain *= this.crossfader < 1 ? Math.cos((this.crossfader * Math.PI) / 2) : 0;
+      } else if (this.sides[deck] === "B") {
+        gain *= Math.sin((this.crossfader * Math.PI) / 2);
+      }
+
+      for (let i = 0; i < deckLength; i++) {
+        output[i] += input[i] * gain;
+      }
+    }
+
+    return output;
+  }
+
+  setDeckGain(deck, gain) {
+    this.gains[deck] = Math.max(0, gain);
+  }
+
+  setDeckParameter(deck, name, value) {
+    logMessage(`Deck ${deck} ${name} set to: ${value}`);
+  }
+
+  setDeckParameters(deck, changes) {
+    logMessage(`Deck ${deck} parameters set`);
+  }
+
+  loadTrack(deck, buffer, sampleRate) {
+    logMessage(`Deck ${deck} track loaded at ${sampleRate}Hz`);
+  }
+
+  setCrossfader(position) {
+    this.crossfader = Math.min(1, Math.max(0, position));
+  }
+
+  setCrossfaderAssignment(deck, side) {
+    this.sides[deck] = side;
+  }
+
+  setMasterVolume(volume) {
+    this.masterVolume = Math.max(0, volume);
+  }
+
+  getNumDecks() {
+    return this.numDecks;
+  }
+
+  setPitchShiftQuality(quality) {
+    logMessage(`Deck pitch shift quality set to: ${quality}`);
+  }
+
+  getLatencySamples() {
+    return 0;
+  }
+
+  setDeckSpectrumEnabled(deck, enabled) {
+    logMessage(`Deck ${deck} spectrum analyser ${enabled ? "enabled" : "disabled"}`);
+  }
+
+  getDeckSpectrum(deck) {
+    return silentSpectrum();
+  }
+
+  setDeckSpectrumBuffer(deck, buffer) {
+    checkSpectrumBuffer(buffer);
+  }
+}
+
 // Export the mock class
 module.exports = JUCEAudioProcessorMock;
+module.exports.DeckEngine = DeckEngineMock;
+module.exports.Parameters = Parameters;
+module.exports.MeterFields = MeterFields;
+module.exports.SpectrumFields = SpectrumFields;
+module.exports.decodeState = decodeState;
@@ -2,6 +2,7 @@
 const { fork } = require("child_process");
 const path = require("path");
 const fs = require("fs");
+const { Parameters, MeterFields, SpectrumFields, decodeState } = require("./audio-processor-mock");
 
 // Enhanced logging function
 function logMessage(message, level = "INFO") {
@@ -19,13 +20,68 @@ function logMessage(message, level = "INFO") {
   }
 }
 
+// Audio blocks and parameter changes go through a shared memory channel when
+// the native addon can be loaded here as well. Otherwise, and whenever a
+// message doesn't fit, they are sent over the IPC channel like everything else.
+let SharedMemoryChannel = null;
+
+if (process.env.JUCE_AUDIO_PROCESSOR_MOCK !== "1") {
+  try {
+    SharedMemoryChannel = require("../build/Release/juce_audio_processor.node").SharedMemoryChannel || null;
+  } catch (error) {
+    logMessage(`Shared memory unavailable, using IPC only: ${error.message}`, "WARN");
+  }
+}
+
+// Size of the audio ring in each direction. A block must fit in half of it.
+const audioRingBytes = 1024 * 1024;
+
+// Calls whose audio can be passed through shared memory
+const audioMethods = ["processAudio", "processAudioAsync"];
+
+// Parameter changes are sent at most once per display frame
+const frameInterval = 1000 / 60;
+
+// How long a call waits for its reply before failing
+const callTimeout = 10000;
+
+// Pause before forking a replacement standby, so a child that crashes on
+// startup can't turn into a fork storm
+const standbyRespawnDelay = 1000;
+
+// Calls that change the processor's setup. They are replayed onto a fresh
+// child, and sent to the standby as well, so it can take over as it is.
+const configurationMethods = [
+  "prepareToPlay",
+  "setSmoothingTime",
+  "setPitchShiftQuality",
+  "setStemCount",
+  "setFilterOversamplingFactor",
+  "setFilterOversampled",
+  "setSpectrumEnabled",
+  "loadTrack",
+];
+
 class JUCEAudioProcessorWrapper {
-  constructor() {
+  // options.standby - keep a second, pre-initialised child ready to take
+  // over if the active one crashes (default true)
+  constructor(options = {}) {
     this.child = null;
+    this.standby = null;
+    this.useStandby = options.standby !== false;
+    this.standbyTimer = null;
     this.ready = false;
     this.pendingCalls = new Map();
-    this.callId = 0;
-    this.initializationPromise = null;
+    this.nextCallId = 0;
+    this.pendingParameters = null;
+    this.parameterFlushTimer = null;
+    this.lastParameterFlush = 0;
+    this.parameterSnapshot = {};
+    this.presets = new Map();
+    this.configuration = new Map();
+    this.audioDeviceOptions = null;
+    this.channelCount = 0;
+    this.receiveBuffer = null;
 
     this.initChildProcess();
   }
@@ -33,63 +89,273 @@ class JUCEAudioProcessorWrapper {
   initChildProcess() {
     try {
       logMessage("Starting child process...");
+      this.child = this.spawnChild();
+      this.ready = false;
 
-      this.child = fork(path.join(__dirname, "audio-processor-child.js"), [], {
-        stdio: ["pipe", "pipe", "pipe", "ipc"],
-        env: { ...process.env, NODE_ENV: "production" },
+      // Messages queue up on the IPC channel until the child is listening, so
+      // calls can be sent straight after the create request without waiting
+      this.createProcessor(this.child).catch((error) => {
+        logMessage(error.message, "ERROR");
       });
 
-      this.child.on("message", (msg) => {
-        this.handleChildMessage(msg);
-      });
+      this.restoreState(this.child);
+      this.startStandby();
+    } catch (error) {
+      logMessage(`Failed to start child process: ${error.message}`, "ERROR");
+      throw error;
+    }
+  }
 
-      this.child.on("error", (error) => {
-        logMessage(`Child process error: ${error.message}`, "ERROR");
-        this.ready = false;
-      });
+  spawnChild() {
+    // Advanced serialization keeps typed arrays intact instead of turning them into JSON objects
+    const child = fork(path.join(__dirname, "audio-processor-child.js"), [], {
+      stdio: ["pipe", "pipe", "pipe", "ipc"],
+      env: { ...process.env, NODE_ENV: "production" },
+      serialization: "advanced",
+    });
 
-      this.child.on("exit", (code) => {
-        logMessage(`Child process exited with code: ${code}`, "WARN");
-        this.ready = false;
+    child.on("message", (msg) => {
+      this.handleChildMessage(child, msg);
+    });
 
-        // If the child process exits unexpectedly, try to restart it
-        if (code !== 0) {
-          logMessage("Child process crashed, attempting to restart...", "WARN");
-          setTimeout(() => {
-            this.initChildProcess();
-          }, 1000);
-        }
-      });
+    child.on("error", (error) => {
+      logMessage(`Child process error: ${error.message}`, "ERROR");
+    });
 
-      // Wait for ready signal
-      this.child.once("message", (msg) => {
-        if (msg.type === "ready") {
-          this.ready = true;
-          logMessage("Child process ready");
-          this.initializationPromise = this.createProcessor();
-        }
-      });
+    child.on("exit", (code, signal) => {
+      this.handleChildExit(child, code, signal);
+    });
+
+    // Counts the IPC messages sent, so shared memory messages can wait for them
+    child.messagesSent = 0;
+    child.messagesFenced = 0;
+    child.sharedMemory = null;
+
+    this.send(child, { type: "create", channel: this.createChannel(child) });
+    return child;
+  }
+
+  // Creates the child's shared memory channel, which is only used once the
+  // child reports it has opened it. Returns its name, or null.
+  createChannel(child) {
+    if (!SharedMemoryChannel) {
+      return null;
+    }
+
+    const name = `${process.pid}-${++this.channelCount}`;
+
+    try {
+      child.pendingSharedMemory = SharedMemoryChannel.create(name, { audioBytes: audioRingBytes });
+      return name;
     } catch (error) {
-      logMessage(`Failed to start child process: ${error.message}`, "ERROR");
-      throw error;
+      logMessage(`Cannot create shared memory channel: ${error.message}`, "WARN");
+      return null;
+    }
+  }
+
+  closeChannel(child) {
+    [child.pendingSharedMemory, child.sharedMemory].forEach((channel) => {
+      if (channel) {
+        channel.close();
+      }
+    });
+    child.pendingSharedMemory = null;
+    child.sharedMemory = null;
+  }
+
+  send(child, message) {
+    child.messagesSent++;
+    child.send(message);
+  }
+
+  // Shared memory and IPC messages travel separately, so before a shared memory
+  // message that follows IPC messages, a fence tells the child to handle those first
+  sendFence(child) {
+    if (child.messagesFenced === child.messagesSent) {
+      return true;
+    }
+
+    if (!child.sharedMemory.send(JSON.stringify({ after: child.messagesSent }))) {
+      return false;
+    }
+
+    child.messagesFenced = child.messagesSent;
+    return true;
+  }
+
+  // Sends a call through shared memory or, failing that, over IPC
+  transmit(child, id, call) {
+    if (!audioMethods.includes(call.method) || !this.sendAudio(child, id, call)) {
+      this.send(child, { type: "method", id, method: call.method, args: call.args });
+    }
+  }
+
+  // The block goes into the audio ring tagged with the call's sequence number,
+  // followed by the request on the control ring
+  sendAudio(child, id, call) {
+    const [buffer, numChannels, interleaved] = call.args;
+
+    if (!child.sharedMemory || !(buffer instanceof Float32Array) || !this.sendFence(child)) {
+      return false;
+    }
+
+    try {
+      if (!child.sharedMemory.writeAudio(buffer, id)) {
+        return false;
+      }
+    } catch (error) {
+      // Larger than half the audio ring
+      return false;
+    }
+
+    const request = { id, method: call.method, numChannels, interleaved, length: buffer.length };
+    return child.sharedMemory.send(JSON.stringify(request));
+  }
+
+  // Processed blocks come back tagged with the sequence number of their call
+  receiveAudio(child) {
+    if (!this.receiveBuffer) {
+      this.receiveBuffer = new Float32Array(audioRingBytes / 8);
+    }
+
+    let block;
+
+    while (child.sharedMemory && (block = child.sharedMemory.readAudio(this.receiveBuffer)) !== null) {
+      const call = child === this.child && this.pendingCalls.get(block.tag);
+      if (call) {
+        this.pendingCalls.delete(block.tag);
+        clearTimeout(call.timeout);
+        call.resolve(this.receiveBuffer.slice(0, block.length));
+      }
+    }
+  }
+
+  // Forks a standby and brings it to the same state as the active child
+  startStandby() {
+    if (!this.useStandby || this.standby || this.standbyTimer) {
+      return;
+    }
+
+    logMessage("Starting standby child process...");
+    this.standby = this.spawnChild();
+    this.restoreState(this.standby);
+  }
+
+  scheduleStandby() {
+    if (!this.useStandby || this.standbyTimer || !this.child) {
+      return;
+    }
+
+    this.standbyTimer = setTimeout(() => {
+      this.standbyTimer = null;
+      this.startStandby();
+    }, standbyRespawnDelay);
+  }
+
+  // Replays the setup, the preset bank and the latest value of every parameter
+  restoreState(child) {
+    this.configuration.forEach((args, method) => {
+      this.notify(child, method, args);
+    });
+
+    this.presets.forEach((values, slot) => {
+      this.send(child, { type: "parameters", changes: values });
+      this.notify(child, "storePreset", [slot]);
+    });
+
+    if (Object.keys(this.parameterSnapshot).length > 0) {
+      this.send(child, { type: "parameters", changes: this.parameterSnapshot });
+    }
+  }
+
+  handleChildExit(child, code, signal) {
+    logMessage(`Child process exited with code: ${code}${signal ? `, signal: ${signal}` : ""}`, "WARN");
+    this.closeChannel(child);
+
+    if (child === this.standby) {
+      this.standby = null;
+      this.scheduleStandby();
+      return;
     }
+
+    // Nothing to do once destroy() has let go of the child
+    if (child !== this.child) {
+      return;
+    }
+
+    this.ready = false;
+
+    if (code === 0) {
+      this.child = null;
+      this.rejectPendingCalls(new Error(`Child process exited with code: ${code}`));
+      return;
+    }
+
+    // The standby already mirrors the crashed child, so it takes over at once.
+    // Without one, a fresh child is started and brought up to date.
+    if (this.standby) {
+      logMessage("Child process crashed, switching to the standby...", "WARN");
+      this.child = this.standby;
+      this.standby = null;
+      this.ready = this.child.processorCreated === true;
+      this.scheduleStandby();
+    } else {
+      logMessage("Child process crashed, restarting it...", "WARN");
+      this.child = this.spawnChild();
+      this.restoreState(this.child);
+      this.scheduleStandby();
+    }
+
+    if (this.audioDeviceOptions) {
+      this.notify(this.child, "startAudioDevice", [this.audioDeviceOptions]);
+    }
+
+    // Calls the crashed child never answered are sent again, but only once,
+    // in case one of them is what brought it down
+    this.pendingCalls.forEach((call, id) => {
+      if (call.retried) {
+        this.pendingCalls.delete(id);
+        clearTimeout(call.timeout);
+        call.reject(new Error(`Child process exited with code: ${code} during ${call.method}`));
+      } else {
+        call.retried = true;
+        this.transmit(this.child, id, call);
+      }
+    });
   }
 
-  handleChildMessage(msg) {
-    if (msg.type === "created") {
+  handleChildMessage(child, msg) {
+    if (msg.type === "ready") {
+      logMessage("Child process ready");
+    } else if (msg.type === "created") {
+      child.processorCreated = msg.success;
+      if (child === this.child) {
+        this.ready = msg.success;
+      }
+
+      // A mock child can't open the channel, so it stays on IPC
+      if (msg.sharedMemory && child.pendingSharedMemory) {
+        child.sharedMemory = child.pendingSharedMemory;
+        child.pendingSharedMemory = null;
+        child.sharedMemory.onReceive(() => this.receiveAudio(child));
+      } else {
+        this.closeChannel(child);
+      }
+
       logMessage(
-        `Processor created: ${msg.success}, Initialized: ${msg.initialized}`
+        `Processor created: ${msg.success}, Initialized: ${msg.initialized}, Implementation: ${msg.implementation}, ` +
+          `Shared memory: ${child.sharedMemory !== null}`
       );
     } else if (msg.type === "method_result") {
-      const { method, result, success } = msg;
-      if (this.pendingCalls.has(method)) {
-        const { resolve, reject } = this.pendingCalls.get(method);
-        this.pendingCalls.delete(method);
+      const call = child === this.child && this.pendingCalls.get(msg.id);
+      if (call) {
+        this.pendingCalls.delete(msg.id);
+        clearTimeout(call.timeout);
 
-        if (success) {
-          resolve(result);
+        if (msg.success) {
+          call.resolve(msg.result);
         } else {
-          reject(new Error(`Method ${method} failed`));
+          call.reject(new Error(`Method ${call.method} failed: ${msg.error}`));
         }
       }
     } else if (msg.type === "error") {
@@ -97,101 +363,392 @@ class JUCEAudioProcessorWrapper {
     }
   }
 
-  createProcessor() {
+  createProcessor(child) {
     return new Promise((resolve, reject) => {
       const timeout = setTimeout(() => {
         reject(new Error("Timeout waiting for processor creation"));
-      }, 10000); // Increased timeout
+      }, callTimeout);
 
-      this.child.once("message", (msg) => {
+      const onMessage = (msg) => {
+        if (msg.type !== "created") {
+          return;
+        }
         clearTimeout(timeout);
-        if (msg.type === "created" && msg.success) {
+        child.off("message", onMessage);
+        if (msg.success) {
           resolve(msg);
         } else {
           reject(new Error("Failed to create processor"));
         }
-      });
+      };
 
-      this.child.send({ type: "create" });
+      child.on("message", onMessage);
     });
   }
 
-  async waitForReady() {
-    if (this.initializationPromise) {
-      await this.initializationPromise;
-    }
+  rejectPendingCalls(error) {
+    this.pendingCalls.forEach((call) => {
+      clearTimeout(call.timeout);
+      call.reject(error);
+    });
+    this.pendingCalls.clear();
+  }
 
-    // Wait a bit more for the child process to be fully ready
-    await new Promise((resolve) => setTimeout(resolve, 500));
+  // Sends a call that isn't answered
+  notify(child, method, args) {
+    this.send(child, { type: "method", method, args });
   }
 
-  async callMethod(method, ...args) {
-    await this.waitForReady();
+  // Sends a request tagged with a sequence number, so any number of calls,
+  // including calls to the same method, can be in flight at once
+  callMethod(method, ...args) {
+    if (!this.child) {
+      return Promise.reject(new Error("Child process not running"));
+    }
+
+    // Parameter changes made before this call must reach the child first
+    this.flushParameters();
 
-    if (!this.ready || !this.child) {
-      throw new Error("Child process not ready");
+    if (configurationMethods.includes(method)) {
+      this.configuration.set(method, args);
+      if (this.standby) {
+        this.notify(this.standby, method, args);
+      }
     }
 
+    const id = ++this.nextCallId;
+
     return new Promise((resolve, reject) => {
       const timeout = setTimeout(() => {
-        this.pendingCalls.delete(method);
+        this.pendingCalls.delete(id);
         reject(new Error(`Timeout waiting for method ${method}`));
-      }, 10000); // Increased timeout
+      }, callTimeout);
 
-      this.pendingCalls.set(method, { resolve, reject });
+      const call = { method, args, resolve, reject, timeout, retried: false };
+      this.pendingCalls.set(id, call);
 
-      this.child.send({
-        type: "method",
-        method: method,
-        args: args,
-      });
+      this.transmit(this.child, id, call);
     });
   }
 
+  // Sends a call to the active child and, unanswered, to the standby
+  callMethodOnBoth(method, ...args) {
+    const result = this.callMethod(method, ...args);
+    if (this.standby) {
+      this.notify(this.standby, method, args);
+    }
+    return result;
+  }
+
+  // Merges parameter changes into the next batch. Only the latest value of
+  // each parameter is sent, and nothing waits for the child to reply.
+  queueParameters(changes) {
+    Object.keys(changes).forEach((name) => {
+      if (!(name in Parameters)) {
+        throw new TypeError(`Unknown parameter: ${name}`);
+      }
+    });
+
+    this.pendingParameters = Object.assign(this.pendingParameters || {}, changes);
+
+    // An isolated change goes out on the next tick, while a sweep is sent once a frame
+    if (!this.parameterFlushTimer) {
+      const wait = this.lastParameterFlush + frameInterval - Date.now();
+      this.parameterFlushTimer = setTimeout(() => this.flushParameters(), Math.max(0, wait));
+    }
+  }
+
+  flushParameters() {
+    if (this.parameterFlushTimer) {
+      clearTimeout(this.parameterFlushTimer);
+      this.parameterFlushTimer = null;
+    }
+
+    if (!this.pendingParameters || !this.child) {
+      return;
+    }
+
+    [this.child, this.standby].forEach((child) => {
+      if (child) {
+        this.sendParameters(child, this.pendingParameters);
+      }
+    });
+
+    Object.assign(this.parameterSnapshot, this.pendingParameters);
+    this.pendingParameters = null;
+    this.lastParameterFlush = Date.now();
+  }
+
+  // Sends parameter changes as ID / value pairs through shared memory, or over IPC
+  sendParameters(child, changes) {
+    if (child.sharedMemory && this.sendFence(child)) {
+      const names = Object.keys(changes);
+      const pairs = new Float32Array(names.length * 2);
+
+      names.forEach((name, i) => {
+        pairs[i * 2] = Parameters[name];
+        pairs[i * 2 + 1] = Number(changes[name]);
+      });
+
+      if (child.sharedMemory.send(pairs)) {
+        return;
+      }
+    }
+
+    this.send(child, { type: "parameters", changes });
+  }
+
   // Proxy methods to child process
   async isInitialized() {
     return this.callMethod("isInitialized");
   }
 
   async setVolume(volume) {
-    return this.callMethod("setVolume", volume);
+    this.queueParameters({ volume: volume });
   }
 
   async setFlangerEnabled(enabled) {
-    return this.callMethod("setFlangerEnabled", enabled);
+    this.queueParameters({ flangerEnabled: enabled });
   }
 
   async setFlangerRate(rate) {
-    return this.callMethod("setFlangerRate", rate);
+    this.queueParameters({ flangerRate: rate });
   }
 
   async setFlangerDepth(depth) {
-    return this.callMethod("setFlangerDepth", depth);
+    this.queueParameters({ flangerDepth: depth });
   }
 
   async setFilterCutoff(cutoff) {
-    return this.callMethod("setFilterCutoff", cutoff);
+    this.queueParameters({ filterCutoff: cutoff });
   }
 
   async setFilterResonance(resonance) {
-    return this.callMethod("setFilterResonance", resonance);
+    this.queueParameters({ filterResonance: resonance });
+  }
+
+  async setEqLow(gain) {
+    this.queueParameters({ eqLow: gain });
+  }
+
+  async setEqMid(gain) {
+    this.queueParameters({ eqMid: gain });
+  }
+
+  async setEqHigh(gain) {
+    this.queueParameters({ eqHigh: gain });
   }
 
   async setPitchBend(semitones) {
-    return this.callMethod("setPitchBend", semitones);
+    this.queueParameters({ pitchBend: semitones });
+  }
+
+  async setJogWheelPosition(revolutions) {
+    this.queueParameters({ jogWheelPosition: revolutions });
+  }
+
+  async setJogWheelTouched(touched) {
+    this.queueParameters({ jogWheelTouched: touched });
   }
 
-  async setJogWheelPosition(position) {
-    return this.callMethod("setJogWheelPosition", position);
+  async loadTrack(buffer, sampleRate, numChannels, interleaved) {
+    return this.callMethod("loadTrack", buffer, sampleRate, numChannels, interleaved);
   }
 
-  async processAudio(buffer) {
-    return this.callMethod("processAudio", buffer);
+  async unloadTrack() {
+    this.configuration.delete("loadTrack");
+    if (this.standby) {
+      this.notify(this.standby, "unloadTrack", []);
+    }
+    return this.callMethod("unloadTrack");
+  }
+
+  async play() {
+    this.queueParameters({ playing: true });
+  }
+
+  async pause() {
+    this.queueParameters({ playing: false });
+  }
+
+  async setPlaybackRate(rate) {
+    this.queueParameters({ playbackRate: rate });
+  }
+
+  async seek(seconds) {
+    this.queueParameters({ seekPosition: seconds });
+  }
+
+  async getPlayPosition() {
+    return this.callMethod("getPlayPosition");
+  }
+
+  async getTrackLength() {
+    return this.callMethod("getTrackLength");
+  }
+
+  async setParameters(changes) {
+    // Batches of ID / value pairs are merged by name with the other pending changes
+    if (ArrayBuffer.isView(changes)) {
+      const names = Object.keys(Parameters);
+      const byName = {};
+      for (let i = 0; i + 1 < changes.length; i += 2) {
+        if (names[changes[i]] === undefined) {
+          throw new TypeError(`Unknown parameter ID: ${changes[i]}`);
+        }
+        byName[names[changes[i]]] = changes[i + 1];
+      }
+      changes = byName;
+    }
+    this.queueParameters(changes);
+  }
+
+  async getState() {
+    return this.callMethod("getState");
+  }
+
+  // Calls that change several parameters at once go to the standby too, and
+  // their values are merged into the snapshot a fresh child is restored from
+  async setState(state) {
+    const values = decodeState(state);
+    const result = this.callMethodOnBoth("setState", state);
+    if (values) {
+      Object.assign(this.parameterSnapshot, values);
+    }
+    return result;
+  }
+
+  async storePreset(slot) {
+    const result = this.callMethodOnBoth("storePreset", slot);
+    const values = decodeState(await this.callMethod("getState"));
+
+    // Changes sent since the preset was stored are newer than its values
+    Object.keys(values).forEach((name) => {
+      if (!(name in this.parameterSnapshot)) {
+        this.parameterSnapshot[name] = values[name];
+      }
+    });
+    this.presets.set(slot, values);
+    return result;
+  }
+
+  async recallPreset(slot) {
+    const result = this.callMethodOnBoth("recallPreset", slot);
+    if (this.presets.has(slot)) {
+      Object.assign(this.parameterSnapshot, this.presets.get(slot));
+    }
+    return result;
+  }
+
+  async setPitchShiftQuality(quality) {
+    return this.callMethod("setPitchShiftQuality", quality);
+  }
+
+  async getLatencySamples() {
+    return this.callMethod("getLatencySamples");
+  }
+
+  async setStemCount(numStems) {
+    return this.callMethod("setStemCount", numStems);
+  }
+
+  async getStemCount() {
+    return this.callMethod("getStemCount");
+  }
+
+  async setFilterOversamplingFactor(factor) {
+    return this.callMethod("setFilterOversamplingFactor", factor);
+  }
+
+  async getFilterOversamplingFactor() {
+    return this.callMethod("getFilterOversamplingFactor");
+  }
+
+  async setFilterOversampled(enabled) {
+    return this.callMethod("setFilterOversampled", enabled);
+  }
+
+  async setSmoothingTime(seconds) {
+    return this.callMethod("setSmoothingTime", seconds);
+  }
+
+  async prepareToPlay(sampleRate, maximumBlockSize) {
+    return this.callMethod("prepareToPlay", sampleRate, maximumBlockSize);
+  }
+
+  async processAudio(buffer, numChannels, interleaved) {
+    return this.callMethod("processAudio", buffer, numChannels, interleaved);
+  }
+
+  async processAudioAsync(buffer, numChannels, interleaved) {
+    return this.callMethod("processAudioAsync", buffer, numChannels, interleaved);
+  }
+
+  async processAudioBatch(buffers, numChannels, interleaved) {
+    return this.callMethod("processAudioBatch", buffers, numChannels, interleaved);
+  }
+
+  // Only the active child opens the device - a standby opens it when it takes over
+  async startAudioDevice(options) {
+    this.audioDeviceOptions = options || {};
+    return this.callMethod("startAudioDevice", options);
+  }
+
+  async stopAudioDevice() {
+    this.audioDeviceOptions = null;
+    return this.callMethod("stopAudioDevice");
+  }
+
+  async isAudioDeviceRunning() {
+    return this.callMethod("isAudioDeviceRunning");
+  }
+
+  async getAudioDeviceTypes() {
+    return this.callMethod("getAudioDeviceTypes");
+  }
+
+  async getMeters() {
+    return this.callMethod("getMeters");
+  }
+
+  async getLevels() {
+    return this.callMethod("getLevels");
+  }
+
+  async resetLoudness() {
+    return this.callMethod("resetLoudness");
+  }
+
+  async setSpectrumEnabled(enabled) {
+    return this.callMethod("setSpectrumEnabled", enabled);
+  }
+
+  async getSpectrum() {
+    return this.callMethod("getSpectrum");
+  }
+
+  async getPerformanceStats() {
+    return this.callMethod("getPerformanceStats");
+  }
+
+  async resetPerformanceStats() {
+    return this.callMethod("resetPerformanceStats");
   }
 
   // Cleanup method
   destroy() {
+    this.flushParameters();
+    this.rejectPendingCalls(new Error("Processor destroyed"));
+    clearTimeout(this.standbyTimer);
+    this.standbyTimer = null;
+    this.useStandby = false;
+    if (this.standby) {
+      this.closeChannel(this.standby);
+      this.standby.kill();
+      this.standby = null;
+    }
     if (this.child) {
+      this.closeChannel(this.child);
       this.child.kill();
       this.child = null;
     }
@@ -199,4 +756,8 @@ class JUCEAudioProcessorWrapper {
   }
 }
 
+JUCEAudioProcessorWrapper.Parameters = Parameters;
+JUCEAudioProcessorWrapper.MeterFields = MeterFields;
+JUCEAudioProcessorWrapper.SpectrumFields = SpectrumFields;
+
 module.exports = JUCEAudioProcessorWrapper;
@@ -1,51 +1,63 @@
 #include <napi.h>
 #include "juce_audio_processor.h"
-#include <iostream>
-#include <fstream>
-#include <cstdio> // Required for std::put_time
-#include <chrono> // Required for std::chrono
-#include <iomanip>
+#include "processing_queue.h"
+#include "playback_engine.h"
+#include "deck_engine.h"
+#include "async_logger.h"
+#include "offline_renderer.h"
+#include "shared_memory_channel.h"
 
-// Simple logging function - no Napi::Env needed
-void logMessage(const std::string& message) {
-    // Write to file
-    std::ofstream logFile("juce_debug.log", std::ios::app);
-    if (logFile.is_open()) {
-        auto now = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(now);
-        logFile << "[" << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S") << "] " << message << std::endl;
-        logFile.close();
-    }
-    
-    // Output to console
-    std::cout << "[JUCE DEBUG] " << message << std::endl;
-    std::cerr << "[JUCE DEBUG] " << message << std::endl;
-}
+class JUCEAudioProcessorWrapper;
 
-// Enhanced logging function that can also log to JavaScript console
-void logMessage(const std::string& message, Napi::Env env) {
-    // Write to file
-    std::ofstream logFile("juce_debug.log", std::ios::app);
-    if (logFile.is_open()) {
-        auto now = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(now);
-        logFile << "[" << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S") << "] " << message << std::endl;
-        logFile.close();
-    }
-    
-    // Output to console
-    std::cout << "[JUCE DEBUG] " << message << std::endl;
-    std::cerr << "[JUCE DEBUG] " << message << std::endl;
-    
-    // Also log to JavaScript console if env is available
-    try {
-        Napi::Object console = env.Global().Get("console").As<Napi::Object>();
-        Napi::Function log = console.Get("log").As<Napi::Function>();
-        log.Call({Napi::String::New(env, "[JUCE DEBUG] " + message)});
-    } catch (...) {
-        // Ignore if console logging fails
-    }
-}
+// Tracks and renders are at most stereo; processed blocks can hold stems
+static constexpr int maxTrackChannels = 2;
+
+// A block of JavaScript audio memory that is processed in place
+struct AudioBlockView
+{
+    float* channels[JUCEAudioProcessor::maxChannels] = {};
+    int numChannels = 0;
+    int numSamples = 0;
+    bool interleaved = false;
+};
+
+// One processAudioAsync/processAudioBatch call. It is owned by the processing
+// queue until its promise is settled back on the JS thread.
+struct AsyncProcessJob
+{
+    explicit AsyncProcessJob(Napi::Env env)
+        : deferred(Napi::Promise::Deferred::New(env)) {}
+
+    JUCEAudioProcessorWrapper* wrapper = nullptr;
+    Napi::Promise::Deferred deferred;
+    Napi::Reference<Napi::Value> buffers; // keeps the JS memory alive while processing
+    std::vector<AudioBlockView> blocks;
+    std::string error;
+};
+
+// One renderFile/renderBuffer call. It is owned by its thread-safe function,
+// which reports progress and settles the promise on the JS thread.
+struct RenderJob
+{
+    explicit RenderJob(Napi::Env env)
+        : deferred(Napi::Promise::Deferred::New(env)) {}
+
+    Napi::Promise::Deferred deferred;
+    std::unique_ptr<JUCEAudioProcessor> processor;
+    OfflineRenderer::Options options;
+    bool isFile = true;
+    juce::File input, output;
+    juce::AudioBuffer<float> samples; // renderBuffer only
+    double sampleRate = 0.0;
+    OfflineRenderer::Result result;
+};
+
+// Sent from the render thread: progress, and finally the result
+struct RenderUpdate
+{
+    double progress = 0.0;
+    bool finished = false;
+};
 
 class JUCEAudioProcessorWrapper : public Napi::ObjectWrap<JUCEAudioProcessorWrapper>
 {
@@ -55,12 +67,52 @@ public:
     ~JUCEAudioProcessorWrapper();
 
 private:
+    static constexpr double defaultSampleRate = 44100.0;
+    static constexpr int defaultBlockSize = 512;
+
+    static void OnAsyncJobComplete(Napi::Env env, Napi::Function, std::nullptr_t*, AsyncProcessJob* job);
+    using AsyncCompletion = Napi::TypedThreadSafeFunction<std::nullptr_t, AsyncProcessJob, &JUCEAudioProcessorWrapper::OnAsyncJobComplete>;
+
+    static void OnRenderUpdate(Napi::Env env, Napi::Function onProgress, RenderJob* job, RenderUpdate* update);
+    using RenderCallback = Napi::TypedThreadSafeFunction<RenderJob, RenderUpdate, &JUCEAudioProcessorWrapper::OnRenderUpdate>;
+    static Napi::Value startRender(Napi::Env env, std::unique_ptr<RenderJob> job, const Napi::Value& options);
+
     static Napi::FunctionReference constructor;
+    static AsyncCompletion asyncCompletion;
+    static int numPendingAsyncJobsTotal;
+
     JUCEAudioProcessor* processor;
     bool isInitialized;
     
+    // Buffers used by processAudio - they only refer to JS memory, except for the
+    // interleaved scratch space which is sized once in prepareProcessor()
+    juce::AudioBuffer<float> processBuffer;
+    juce::AudioBuffer<float> interleavedScratch;
+    juce::MidiBuffer midiBuffer;
+    double preparedSampleRate = 0.0;
+    int preparedBlockSize = 0;
+
+    // The audio device sets its own channel layout, so stems are restored when it stops
+    int numStems = 1;
+
+    // Runs this instance's async blocks in order on the shared pool
+    ProcessingQueue processingQueue;
+    int numPendingAsyncJobs = 0;
+
+    // Created on the first startAudioDevice() call
+    std::unique_ptr<PlaybackEngine> playbackEngine;
+
+    // The Float32Array the output meter writes into, kept alive while attached
+    Napi::Reference<Napi::Value> meterBuffer;
+    Napi::Reference<Napi::Value> spectrumBuffer;
+
     // Add the missing method declaration
     void ensureInitialized();
+    void prepareProcessor(double sampleRate, int maximumBlockSize);
+    void processBlockView(AudioBlockView& view);
+    int getNumChannelsArgument(const Napi::CallbackInfo& info) const;
+    bool isAudioDeviceRunning() const;
+    Napi::Value queueAsyncJob(const Napi::CallbackInfo& info, bool isBatch);
     
     Napi::Value SetPitchBend(const Napi::CallbackInfo& info);
     Napi::Value SetFlangerEnabled(const Napi::CallbackInfo& info);
@@ -70,11 +122,61 @@ private:
     Napi::Value SetFilterResonance(const Napi::CallbackInfo& info);
     Napi::Value SetJogWheelPosition(const Napi::CallbackInfo& info);
     Napi::Value SetVolume(const Napi::CallbackInfo& info);
+    Napi::Value SetEqLow(const Napi::CallbackInfo& info);
+    Napi::Value SetEqMid(const Napi::CallbackInfo& info);
+    Napi::Value SetEqHigh(const Napi::CallbackInfo& info);
+    Napi::Value SetJogWheelTouched(const Napi::CallbackInfo& info);
+    Napi::Value LoadTrack(const Napi::CallbackInfo& info);
+    Napi::Value UnloadTrack(const Napi::CallbackInfo& info);
+    Napi::Value Play(const Napi::CallbackInfo& info);
+    Napi::Value Pause(const Napi::CallbackInfo& info);
+    Napi::Value SetPlaybackRate(const Napi::CallbackInfo& info);
+    Napi::Value Seek(const Napi::CallbackInfo& info);
+    Napi::Value GetPlayPosition(const Napi::CallbackInfo& info);
+    Napi::Value GetTrackLength(const Napi::CallbackInfo& info);
+    Napi::Value SetParameters(const Napi::CallbackInfo& info);
+    Napi::Value GetState(const Napi::CallbackInfo& info);
+    Napi::Value SetState(const Napi::CallbackInfo& info);
+    Napi::Value StorePreset(const Napi::CallbackInfo& info);
+    Napi::Value RecallPreset(const Napi::CallbackInfo& info);
+    Napi::Value SetSmoothingTime(const Napi::CallbackInfo& info);
+    Napi::Value SetPitchShiftQuality(const Napi::CallbackInfo& info);
+    Napi::Value SetStemCount(const Napi::CallbackInfo& info);
+    Napi::Value GetStemCount(const Napi::CallbackInfo& info);
+    Napi::Value SetFilterOversamplingFactor(const Napi::CallbackInfo& info);
+    Napi::Value GetFilterOversamplingFactor(const Napi::CallbackInfo& info);
+    Napi::Value SetFilterOversampled(const Napi::CallbackInfo& info);
+    Napi::Value GetLatencySamples(const Napi::CallbackInfo& info);
+    Napi::Value PrepareToPlay(const Napi::CallbackInfo& info);
     Napi::Value ProcessAudio(const Napi::CallbackInfo& info);
+    Napi::Value ProcessAudioAsync(const Napi::CallbackInfo& info);
+    Napi::Value ProcessAudioBatch(const Napi::CallbackInfo& info);
+    Napi::Value StartAudioDevice(const Napi::CallbackInfo& info);
+    Napi::Value StopAudioDevice(const Napi::CallbackInfo& info);
+    Napi::Value IsAudioDeviceRunning(const Napi::CallbackInfo& info);
+    Napi::Value GetAudioDeviceTypes(const Napi::CallbackInfo& info);
+    Napi::Value GetMeters(const Napi::CallbackInfo& info);
+    Napi::Value GetLevels(const Napi::CallbackInfo& info);
+    Napi::Value SetMeterBuffer(const Napi::CallbackInfo& info);
+    Napi::Value ResetLoudness(const Napi::CallbackInfo& info);
+    Napi::Value GetPerformanceStats(const Napi::CallbackInfo& info);
+    Napi::Value ResetPerformanceStats(const Napi::CallbackInfo& info);
+    Napi::Value SetSpectrumEnabled(const Napi::CallbackInfo& info);
+    Napi::Value GetSpectrum(const Napi::CallbackInfo& info);
+    Napi::Value SetSpectrumBuffer(const Napi::CallbackInfo& info);
     Napi::Value IsInitialized(const Napi::CallbackInfo& info);
+
+    static Napi::Value SetLogLevel(const Napi::CallbackInfo& info);
+    static Napi::Value GetLogLevel(const Napi::CallbackInfo& info);
+    static Napi::Value SetLogFile(const Napi::CallbackInfo& info);
+    static Napi::Value SetLogToConsole(const Napi::CallbackInfo& info);
+    static Napi::Value RenderFile(const Napi::CallbackInfo& info);
+    static Napi::Value RenderBuffer(const Napi::CallbackInfo& info);
 };
 
 Napi::FunctionReference JUCEAudioProcessorWrapper::constructor;
+JUCEAudioProcessorWrapper::AsyncCompletion JUCEAudioProcessorWrapper::asyncCompletion;
+int JUCEAudioProcessorWrapper::numPendingAsyncJobsTotal = 0;
 
 Napi::Object JUCEAudioProcessorWrapper::Init(Napi::Env env, Napi::Object exports)
 {
@@ -89,13 +191,94 @@ Napi::Object JUCEAudioProcessorWrapper::Init(Napi::Env env, Napi::Object exports
         InstanceMethod("setFilterResonance", &JUCEAudioProcessorWrapper::SetFilterResonance),
         InstanceMethod("setJogWheelPosition", &JUCEAudioProcessorWrapper::SetJogWheelPosition),
         InstanceMethod("setVolume", &JUCEAudioProcessorWrapper::SetVolume),
+        InstanceMethod("setEqLow", &JUCEAudioProcessorWrapper::SetEqLow),
+        InstanceMethod("setEqMid", &JUCEAudioProcessorWrapper::SetEqMid),
+        InstanceMethod("setEqHigh", &JUCEAudioProcessorWrapper::SetEqHigh),
+        InstanceMethod("setJogWheelTouched", &JUCEAudioProcessorWrapper::SetJogWheelTouched),
+        InstanceMethod("loadTrack", &JUCEAudioProcessorWrapper::LoadTrack),
+        InstanceMethod("unloadTrack", &JUCEAudioProcessorWrapper::UnloadTrack),
+        InstanceMethod("play", &JUCEAudioProcessorWrapper::Play),
+        InstanceMethod("pause", &JUCEAudioProcessorWrapper::Pause),
+        InstanceMethod("setPlaybackRate", &JUCEAudioProcessorWrapper::SetPlaybackRate),
+        InstanceMethod("seek", &JUCEAudioProcessorWrapper::Seek),
+        InstanceMethod("getPlayPosition", &JUCEAudioProcessorWrapper::GetPlayPosition),
+        InstanceMethod("getTrackLength", &JUCEAudioProcessorWrapper::GetTrackLength),
+        InstanceMethod("setParameters", &JUCEAudioProcessorWrapper::SetParameters),
+        InstanceMethod("getState", &JUCEAudioProcessorWrapper::GetState),
+        InstanceMethod("setState", &JUCEAudioProcessorWrapper::SetState),
+        InstanceMethod("storePreset", &JUCEAudioProcessorWrapper::StorePreset),
+        InstanceMethod("recallPreset", &JUCEAudioProcessorWrapper::RecallPreset),
+        InstanceMethod("setSmoothingTime", &JUCEAudioProcessorWrapper::SetSmoothingTime),
+        InstanceMethod("setPitchShiftQuality", &JUCEAudioProcessorWrapper::SetPitchShiftQuality),
+        InstanceMethod("setStemCount", &JUCEAudioProcessorWrapper::SetStemCount),
+        InstanceMethod("getStemCount", &JUCEAudioProcessorWrapper::GetStemCount),
+        InstanceMethod("setFilterOversamplingFactor", &JUCEAudioProcessorWrapper::SetFilterOversamplingFactor),
+        InstanceMethod("getFilterOversamplingFactor", &JUCEAudioProcessorWrapper::GetFilterOversamplingFactor),
+        InstanceMethod("setFilterOversampled", &JUCEAudioProcessorWrapper::SetFilterOversampled),
+        InstanceMethod("getLatencySamples", &JUCEAudioProcessorWrapper::GetLatencySamples),
+        InstanceMethod("prepareToPlay", &JUCEAudioProcessorWrapper::PrepareToPlay),
         InstanceMethod("processAudio", &JUCEAudioProcessorWrapper::ProcessAudio),
-        InstanceMethod("isInitialized", &JUCEAudioProcessorWrapper::IsInitialized)
+        InstanceMethod("processAudioAsync", &JUCEAudioProcessorWrapper::ProcessAudioAsync),
+        InstanceMethod("processAudioBatch", &JUCEAudioProcessorWrapper::ProcessAudioBatch),
+        InstanceMethod("startAudioDevice", &JUCEAudioProcessorWrapper::StartAudioDevice),
+        InstanceMethod("stopAudioDevice", &JUCEAudioProcessorWrapper::StopAudioDevice),
+        InstanceMethod("isAudioDeviceRunning", &JUCEAudioProcessorWrapper::IsAudioDeviceRunning),
+        InstanceMethod("getAudioDeviceTypes", &JUCEAudioProcessorWrapper::GetAudioDeviceTypes),
+        InstanceMethod("getMeters", &JUCEAudioProcessorWrapper::GetMeters),
+        InstanceMethod("getLevels", &JUCEAudioProcessorWrapper::GetLevels),
+        InstanceMethod("setMeterBuffer", &JUCEAudioProcessorWrapper::SetMeterBuffer),
+        InstanceMethod("resetLoudness", &JUCEAudioProcessorWrapper::ResetLoudness),
+        InstanceMethod("getPerformanceStats", &JUCEAudioProcessorWrapper::GetPerformanceStats),
+        InstanceMethod("resetPerformanceStats", &JUCEAudioProcessorWrapper::ResetPerformanceStats),
+        InstanceMethod("setSpectrumEnabled", &JUCEAudioProcessorWrapper::SetSpectrumEnabled),
+        InstanceMethod("getSpectrum", &JUCEAudioProcessorWrapper::GetSpectrum),
+        InstanceMethod("setSpectrumBuffer", &JUCEAudioProcessorWrapper::SetSpectrumBuffer),
+        InstanceMethod("isInitialized", &JUCEAudioProcessorWrapper::IsInitialized),
+        StaticMethod("setLogLevel", &JUCEAudioProcessorWrapper::SetLogLevel),
+        StaticMethod("getLogLevel", &JUCEAudioProcessorWrapper::GetLogLevel),
+        StaticMethod("setLogFile", &JUCEAudioProcessorWrapper::SetLogFile),
+        StaticMethod("setLogToConsole", &JUCEAudioProcessorWrapper::SetLogToConsole),
+        StaticMethod("renderFile", &JUCEAudioProcessorWrapper::RenderFile),
+        StaticMethod("renderBuffer", &JUCEAudioProcessorWrapper::RenderBuffer)
     });
 
     constructor = Napi::Persistent(func);
     constructor.SuppressDestruct();
 
+    // Shared by all instances to settle async promises on the JS thread. It only
+    // keeps the event loop alive while blocks are in flight.
+    asyncCompletion = AsyncCompletion::New(env, "processAudioAsync", 0, 1);
+    asyncCompletion.Unref(env);
+
+    // Write out whatever is still queued when the environment shuts down
+    env.AddCleanupHook([] { AsyncLogger::getInstance().flush(); });
+
+    // Parameter IDs for the Float32Array form of setParameters()
+    Napi::Object parameterIds = Napi::Object::New(env);
+    
+    for (int parameter = 0; parameter < JUCEAudioProcessor::numParameterIds; ++parameter)
+        parameterIds.Set(JUCEAudioProcessor::getParameterIdName(parameter), Napi::Number::New(env, parameter));
+    
+    func.Set("Parameters", parameterIds);
+
+    // Offsets of the values setMeterBuffer() writes, in floats
+    Napi::Object meterFields = Napi::Object::New(env);
+    
+    for (int field = 0; field < LevelMeter::numSharedFields; ++field)
+        meterFields.Set(LevelMeter::getSharedFieldName(field), Napi::Number::New(env, field));
+    
+    meterFields.Set("length", Napi::Number::New(env, LevelMeter::numSharedFields));
+    func.Set("MeterFields", meterFields);
+
+    // Offsets of the frames setSpectrumBuffer() writes, in floats
+    Napi::Object spectrumFields = Napi::Object::New(env);
+    spectrumFields.Set("sequence", Napi::Number::New(env, SpectrumAnalyser::sequenceField));
+    spectrumFields.Set("levels", Napi::Number::New(env, SpectrumAnalyser::levelsField));
+    spectrumFields.Set("peaks", Napi::Number::New(env, SpectrumAnalyser::peaksField));
+    spectrumFields.Set("numBands", Napi::Number::New(env, SpectrumAnalyser::numBands));
+    spectrumFields.Set("length", Napi::Number::New(env, SpectrumAnalyser::numSharedFields));
+    func.Set("SpectrumFields", spectrumFields);
+
     exports.Set("JUCEAudioProcessor", func);
     return exports;
 }
@@ -116,6 +299,9 @@ JUCEAudioProcessorWrapper::JUCEAudioProcessorWrapper(const Napi::CallbackInfo& i
 
 JUCEAudioProcessorWrapper::~JUCEAudioProcessorWrapper()
 {
+    processingQueue.waitUntilIdle();
+    playbackEngine.reset();
+    
     try {
         if (processor) {
             delete processor;
@@ -130,29 +316,38 @@ JUCEAudioProcessorWrapper::~JUCEAudioProcessorWrapper()
 // Lazy initialization method
 void JUCEAudioProcessorWrapper::ensureInitialized() {
     if (!isInitialized) {
+        auto& logger = AsyncLogger::getInstance();
+        
         try {
-            logMessage("Starting JUCE initialization...");
-            
-            // Skip GUI initialization entirely for Electron compatibility
-            logMessage("Skipping GUI initialization for Electron compatibility...");
-            
-            // Create processor directly without GUI initialization
-            logMessage("Creating JUCEAudioProcessor instance...");
+            // Skip GUI initialization entirely for Electron compatibility and
+            // create the processor directly
+            logger.log(AsyncLogger::info, "Creating JUCEAudioProcessor instance...");
             processor = new JUCEAudioProcessor();
-            logMessage("JUCEAudioProcessor created successfully");
+
+            prepareProcessor(defaultSampleRate, defaultBlockSize);
             
             isInitialized = true;
-            logMessage("JUCE initialization completed successfully (without GUI)");
+            logger.log(AsyncLogger::info, "JUCE initialization completed successfully (without GUI)");
             
         } catch (const std::exception& e) {
-            logMessage("JUCE initialization failed: " + std::string(e.what()));
+            logger.log(AsyncLogger::error, "JUCE initialization failed: %s", e.what());
             throw std::runtime_error("Failed to initialize JUCE: " + std::string(e.what()));
         }
-    } else {
-        logMessage("JUCE already initialized");
     }
 }
 
+// (Re)prepares the processor and sizes the interleaving scratch buffer, so that
+// processAudio never has to allocate for blocks up to maximumBlockSize
+void JUCEAudioProcessorWrapper::prepareProcessor(double sampleRate, int maximumBlockSize)
+{
+    processor->setRateAndBufferSizeDetails(sampleRate, maximumBlockSize);
+    processor->prepareToPlay(sampleRate, maximumBlockSize);
+    interleavedScratch.setSize(processor->getMainBusNumOutputChannels(), maximumBlockSize, false, false, true);
+
+    preparedSampleRate = sampleRate;
+    preparedBlockSize = maximumBlockSize;
+}
+
 Napi::Value JUCEAudioProcessorWrapper::IsInitialized(const Napi::CallbackInfo& info)
 {
     return Napi::Boolean::New(info.Env(), isInitialized);
@@ -170,15 +365,9 @@ Napi::Value JUCEAudioProcessorWrapper::SetPitchBend(const Napi::CallbackInfo& in
     try {
         ensureInitialized();
         float semitones = info[0].As<Napi::Number>().FloatValue();
-        
-        // Add debug output with env
-        logMessage("Setting pitch bend to: " + std::to_string(semitones), env);
-        
         processor->setPitchBend(semitones);
-        logMessage("Pitch bend set successfully", env);
-        
+        AsyncLogger::getInstance().log(AsyncLogger::debug, "Pitch bend set to: %f", semitones);
     } catch (const std::exception& e) {
-        logMessage("Error in setPitchBend: " + std::string(e.what()), env);
         Napi::Error::New(env, "Error in setPitchBend: " + std::string(e.what())).ThrowAsJavaScriptException();
         return env.Null();
     }
@@ -333,29 +522,2474 @@ Napi::Value JUCEAudioProcessorWrapper::SetVolume(const Napi::CallbackInfo& info)
     return env.Null();
 }
 
-Napi::Value JUCEAudioProcessorWrapper::ProcessAudio(const Napi::CallbackInfo& info)
+Napi::Value JUCEAudioProcessorWrapper::SetEqLow(const Napi::CallbackInfo& info)
 {
     Napi::Env env = info.Env();
     
-    if (info.Length() < 1 || !info[0].IsArrayBuffer()) {
-        Napi::TypeError::New(env, "ArrayBuffer expected").ThrowAsJavaScriptException();
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Number expected").ThrowAsJavaScriptException();
         return env.Null();
     }
     
     try {
         ensureInitialized();
-        // For now, just return success - actual audio processing would go here
+        float gain = info[0].As<Napi::Number>().FloatValue();
+        processor->setEqLow(gain);
     } catch (const std::exception& e) {
-        Napi::Error::New(env, "Error in processAudio: " + std::string(e.what())).ThrowAsJavaScriptException();
+        Napi::Error::New(env, "Error in setEqLow: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return env.Null();
+}
+
+Napi::Value JUCEAudioProcessorWrapper::SetEqMid(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Number expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    try {
+        ensureInitialized();
+        float gain = info[0].As<Napi::Number>().FloatValue();
+        processor->setEqMid(gain);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in setEqMid: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return env.Null();
+}
+
+Napi::Value JUCEAudioProcessorWrapper::SetEqHigh(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Number expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    try {
+        ensureInitialized();
+        float gain = info[0].As<Napi::Number>().FloatValue();
+        processor->setEqHigh(gain);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in setEqHigh: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return env.Null();
+}
+
+Napi::Value JUCEAudioProcessorWrapper::SetJogWheelTouched(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsBoolean()) {
+        Napi::TypeError::New(env, "Boolean expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    try {
+        ensureInitialized();
+        processor->setJogWheelTouched(info[0].As<Napi::Boolean>().Value());
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in setJogWheelTouched: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return env.Null();
+}
+
+Napi::Value JUCEAudioProcessorWrapper::UnloadTrack(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    try {
+        ensureInitialized();
+        processor->unloadTrack();
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in unloadTrack: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return env.Null();
+}
+
+Napi::Value JUCEAudioProcessorWrapper::Play(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    try {
+        ensureInitialized();
+        processor->setPlaying(true);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in play: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return env.Null();
+}
+
+Napi::Value JUCEAudioProcessorWrapper::Pause(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    try {
+        ensureInitialized();
+        processor->setPlaying(false);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in pause: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return env.Null();
+}
+
+Napi::Value JUCEAudioProcessorWrapper::SetPlaybackRate(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Number expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    try {
+        ensureInitialized();
+        processor->setPlaybackRate(info[0].As<Napi::Number>().FloatValue());
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in setPlaybackRate: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return env.Null();
+}
+
+Napi::Value JUCEAudioProcessorWrapper::Seek(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Number expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    try {
+        ensureInitialized();
+        processor->seek(info[0].As<Napi::Number>().FloatValue());
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in seek: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return env.Null();
+}
+
+// Seconds into the track as of the last processed block
+Napi::Value JUCEAudioProcessorWrapper::GetPlayPosition(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    try {
+        ensureInitialized();
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in getPlayPosition: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return Napi::Number::New(env, processor->getPlayPositionSeconds());
+}
+
+Napi::Value JUCEAudioProcessorWrapper::GetTrackLength(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    try {
+        ensureInitialized();
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in getTrackLength: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return Napi::Number::New(env, processor->getTrackLengthSeconds());
+}
+
+// setLogLevel("debug" | "info" | "warning" | "error" | "off")
+Napi::Value JUCEAudioProcessorWrapper::SetLogLevel(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    AsyncLogger::Level level = AsyncLogger::info;
+    
+    if (info.Length() < 1 || !info[0].IsString()
+        || !AsyncLogger::getLevelForName(info[0].As<Napi::String>().Utf8Value().c_str(), level)) {
+        Napi::TypeError::New(env, "Expected \"debug\", \"info\", \"warning\", \"error\" or \"off\"").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    AsyncLogger::getInstance().setLevel(level);
+    return env.Null();
+}
+
+Napi::Value JUCEAudioProcessorWrapper::GetLogLevel(const Napi::CallbackInfo& info)
+{
+    return Napi::String::New(info.Env(), AsyncLogger::getLevelName(AsyncLogger::getInstance().getLevel()));
+}
+
+Napi::Value JUCEAudioProcessorWrapper::SetLogFile(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "String expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    const auto path = juce::String::fromUTF8(info[0].As<Napi::String>().Utf8Value().c_str());
+    AsyncLogger::getInstance().setLogFile(juce::File::getCurrentWorkingDirectory().getChildFile(path));
+    return env.Null();
+}
+
+Napi::Value JUCEAudioProcessorWrapper::SetLogToConsole(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsBoolean()) {
+        Napi::TypeError::New(env, "Boolean expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    AsyncLogger::getInstance().setEchoToConsole(info[0].As<Napi::Boolean>().Value());
+    return env.Null();
+}
+
+Napi::Value JUCEAudioProcessorWrapper::SetSmoothingTime(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Number expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    try {
+        ensureInitialized();
+        processor->setSmoothingTime(info[0].As<Napi::Number>().FloatValue());
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in setSmoothingTime: " + std::string(e.what())).ThrowAsJavaScriptException();
         return env.Null();
     }
     
     return env.Null();
 }
 
+Napi::Value JUCEAudioProcessorWrapper::PrepareToPlay(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+        Napi::TypeError::New(env, "Expected sample rate and maximum block size").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    double sampleRate = info[0].As<Napi::Number>().DoubleValue();
+    int maximumBlockSize = info[1].As<Napi::Number>().Int32Value();
+    
+    if (sampleRate <= 0.0 || maximumBlockSize <= 0) {
+        Napi::RangeError::New(env, "Sample rate and block size must be positive").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    if (numPendingAsyncJobs > 0 || isAudioDeviceRunning()) {
+        Napi::Error::New(env, "prepareToPlay cannot run while audio is being processed").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    try {
+        ensureInitialized();
+        prepareProcessor(sampleRate, maximumBlockSize);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in prepareToPlay: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return env.Null();
+}
+
+// Parses "fast", "normal" or "high"
+static bool getPitchShiftQuality(const Napi::Value& value, JUCEAudioProcessor::PitchShiftQuality& quality)
+{
+    if (!value.IsString())
+        return false;
+    
+    const std::string name = value.As<Napi::String>().Utf8Value();
+    
+    if (name == "fast")
+        quality = JUCEAudioProcessor::PitchShiftQuality::fast;
+    else if (name == "normal")
+        quality = JUCEAudioProcessor::PitchShiftQuality::normal;
+    else if (name == "high")
+        quality = JUCEAudioProcessor::PitchShiftQuality::high;
+    else
+        return false;
+    
+    return true;
+}
+
+// setPitchShiftQuality("fast" | "normal" | "high")
+Napi::Value JUCEAudioProcessorWrapper::SetPitchShiftQuality(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    JUCEAudioProcessor::PitchShiftQuality quality;
+    
+    if (info.Length() < 1 || !getPitchShiftQuality(info[0], quality)) {
+        Napi::TypeError::New(env, "Expected \"fast\", \"normal\" or \"high\"").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    try {
+        ensureInitialized();
+        processor->setPitchShiftQuality(quality);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in setPitchShiftQuality: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return env.Null();
+}
+
+// setStemCount(numStems) - processes numStems stereo stems side by side, so
+// processAudio takes 2 * numStems channels. 1 goes back to plain stereo.
+Napi::Value JUCEAudioProcessorWrapper::SetStemCount(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Expected a number").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    if (numPendingAsyncJobs > 0 || isAudioDeviceRunning()) {
+        Napi::Error::New(env, "setStemCount cannot run while audio is being processed").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    try {
+        ensureInitialized();
+        
+        const int requestedStems = info[0].As<Napi::Number>().Int32Value();
+        
+        if (!processor->setNumStems(requestedStems)) {
+            Napi::RangeError::New(env, "The stem count must be between 1 and " + std::to_string(JUCEAudioProcessor::maxStems))
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        numStems = requestedStems;
+        
+        // Sizes the effect state for the new channel count
+        prepareProcessor(preparedSampleRate, preparedBlockSize);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in setStemCount: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return env.Null();
+}
+
+Napi::Value JUCEAudioProcessorWrapper::GetStemCount(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    try {
+        ensureInitialized();
+        return Napi::Number::New(env, processor->getNumStems());
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in getStemCount: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// setFilterOversamplingFactor(2 | 4) - the factor the oversampled filter mode
+// runs at on this processor
+Napi::Value JUCEAudioProcessorWrapper::SetFilterOversamplingFactor(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Expected a number").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    if (numPendingAsyncJobs > 0 || isAudioDeviceRunning()) {
+        Napi::Error::New(env, "setFilterOversamplingFactor cannot run while audio is being processed").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    try {
+        ensureInitialized();
+        
+        if (!processor->setFilterOversamplingFactor(info[0].As<Napi::Number>().Int32Value())) {
+            Napi::RangeError::New(env, "The oversampling factor must be 2 or 4").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        // Builds the oversampling stages for the new factor
+        prepareProcessor(preparedSampleRate, preparedBlockSize);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in setFilterOversamplingFactor: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return env.Null();
+}
+
+Napi::Value JUCEAudioProcessorWrapper::GetFilterOversamplingFactor(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    try {
+        ensureInitialized();
+        return Napi::Number::New(env, processor->getFilterOversamplingFactor());
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in getFilterOversamplingFactor: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// setFilterOversampled(enabled) - switches the oversampled filter mode, also
+// while audio runs
+Napi::Value JUCEAudioProcessorWrapper::SetFilterOversampled(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsBoolean()) {
+        Napi::TypeError::New(env, "Expected a boolean").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    try {
+        ensureInitialized();
+        processor->setFilterOversampled(info[0].As<Napi::Boolean>().Value());
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in setFilterOversampled: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return env.Null();
+}
+
+Napi::Value JUCEAudioProcessorWrapper::GetLatencySamples(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    try {
+        ensureInitialized();
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in getLatencySamples: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return Napi::Number::New(env, processor->getLatencySamples());
+}
+
+// Resolves a Float32Array (including views onto a SharedArrayBuffer) or a plain
+// ArrayBuffer to the float memory it refers to, without copying it
+static bool getFloatSamples(const Napi::Value& value, float*& data, size_t& numFloats)
+{
+    if (value.IsTypedArray()) {
+        if (value.As<Napi::TypedArray>().TypedArrayType() != napi_float32_array)
+            return false;
+        
+        Napi::Float32Array samples = value.As<Napi::Float32Array>();
+        data = samples.Data();
+        numFloats = samples.ElementLength();
+        return true;
+    }
+    
+    if (value.IsArrayBuffer()) {
+        Napi::ArrayBuffer arrayBuffer = value.As<Napi::ArrayBuffer>();
+        data = static_cast<float*>(arrayBuffer.Data());
+        numFloats = arrayBuffer.ByteLength() / sizeof(float);
+        return true;
+    }
+    
+    return false;
+}
+
+// Resolves the array argument of setMeterBuffer()/setSpectrumBuffer(): a
+// Float32Array of at least minimumFloats, or null/undefined to detach, which
+// leaves data as nullptr. Throws and returns false for anything else.
+static bool getSharedOutput(const Napi::CallbackInfo& info, size_t argument, size_t minimumFloats,
+                            const char* bufferName, float*& data)
+{
+    Napi::Env env = info.Env();
+    size_t numFloats = 0;
+    data = nullptr;
+    
+    if (info.Length() <= argument || info[argument].IsNull() || info[argument].IsUndefined())
+        return true;
+    
+    if (!info[argument].IsTypedArray() || !getFloatSamples(info[argument], data, numFloats)) {
+        Napi::TypeError::New(env, "Expected a Float32Array or null").ThrowAsJavaScriptException();
+        return false;
+    }
+    
+    if (numFloats < minimumFloats) {
+        Napi::RangeError::New(env, std::string("The ") + bufferName + " buffer needs at least "
+                                       + std::to_string(minimumFloats) + " floats").ThrowAsJavaScriptException();
+        return false;
+    }
+    
+    return true;
+}
+
+// { frequencies, levels, peaks } as Float32Arrays, one entry per band
+static Napi::Object spectrumToJs(Napi::Env env, const SpectrumAnalyser::Frame& frame)
+{
+    constexpr size_t numBands = SpectrumAnalyser::numBands;
+    Napi::Float32Array frequencies = Napi::Float32Array::New(env, numBands);
+    Napi::Float32Array levels = Napi::Float32Array::New(env, numBands);
+    Napi::Float32Array peaks = Napi::Float32Array::New(env, numBands);
+    
+    for (size_t band = 0; band < numBands; ++band) {
+        frequencies[band] = SpectrumAnalyser::getBandFrequency(static_cast<int>(band));
+        levels[band] = frame.levels[band];
+        peaks[band] = frame.peaks[band];
+    }
+    
+    Napi::Object spectrum = Napi::Object::New(env);
+    spectrum.Set("frequencies", frequencies);
+    spectrum.Set("levels", levels);
+    spectrum.Set("peaks", peaks);
+    return spectrum;
+}
+
+static Napi::Object percentilesToJs(Napi::Env env, const PerformanceMonitor::Percentiles& percentiles)
+{
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("median", percentiles.median);
+    result.Set("p99", percentiles.p99);
+    result.Set("p999", percentiles.p999);
+    result.Set("max", percentiles.max);
+    return result;
+}
+
+// A performance snapshot, all times in microseconds: { load, deadlineMisses,
+// blocks, budget, meanBlockTime, blockTime, callbackJitter, stages, histogram }.
+// histogram lists [upper bound, count] for every non-empty block time bucket.
+static Napi::Object performanceStatsToJs(Napi::Env env, const PerformanceMonitor& monitor)
+{
+    const auto stats = monitor.getStats();
+    Napi::Object result = Napi::Object::New(env);
+    
+    result.Set("load", stats.load);
+    result.Set("deadlineMisses", stats.deadlineMisses);
+    result.Set("blocks", static_cast<double>(stats.numBlocks));
+    result.Set("idleBlocks", static_cast<double>(stats.numIdleBlocks));
+    result.Set("budget", stats.budgetMicroseconds);
+    result.Set("meanBlockTime", stats.meanBlockMicroseconds);
+    result.Set("blockTime", percentilesToJs(env, stats.blockTime));
+    result.Set("callbackJitter", percentilesToJs(env, stats.callbackJitter));
+    
+    Napi::Object stages = Napi::Object::New(env);
+    
+    for (int stage = 0; stage < PerformanceMonitor::numStages; ++stage)
+        stages.Set(PerformanceMonitor::getStageName(stage), stats.meanStageMicroseconds[static_cast<size_t>(stage)]);
+    
+    result.Set("stages", stages);
+    
+    using Histogram = PerformanceMonitor::Histogram;
+    const auto& histogram = monitor.getBlockTimeHistogram();
+    Napi::Array buckets = Napi::Array::New(env);
+    
+    for (int bucket = 0; bucket < Histogram::numBuckets; ++bucket) {
+        if (const auto count = histogram.getCount(bucket)) {
+            Napi::Array entry = Napi::Array::New(env, 2);
+            entry.Set(0u, static_cast<double>(Histogram::getBucketUpperBound(bucket)) / 1000.0);
+            entry.Set(1u, count);
+            buckets.Set(buckets.Length(), entry);
+        }
+    }
+    
+    result.Set("histogram", buckets);
+    return result;
+}
+
+// Parameter values may be numbers or booleans (switches such as flangerEnabled)
+static bool getParameterValue(const Napi::Value& value, float& result)
+{
+    if (value.IsNumber()) {
+        result = value.As<Napi::Number>().FloatValue();
+        return true;
+    }
+    
+    if (value.IsBoolean()) {
+        result = value.As<Napi::Boolean>().Value() ? 1.0f : 0.0f;
+        return true;
+    }
+    
+    return false;
+}
+
+// Applies a batch of parameter changes in one call. changes is either an
+// object keyed by parameter name, e.g. { filterCutoff: 800, volume: 0.5 }, or
+// a Float32Array of parameter ID / value pairs, where the last value of an ID
+// wins. The whole batch is validated before anything is applied, and the audio
+// thread picks it up in a single block. Nothing is allocated, so controller
+// sweeps can call it at any rate. Returns an error message, or an empty string
+// on success.
+static std::string setParametersFrom(JUCEAudioProcessor& processor, const Napi::Value& changes)
+{
+    float values[JUCEAudioProcessor::numParameterIds] = {};
+    uint32_t changed = 0;
+    static_assert(JUCEAudioProcessor::numParameterIds <= 32, "changed is a 32-bit mask");
+    
+    if (changes.IsTypedArray() || changes.IsArrayBuffer()) {
+        float* pairs = nullptr;
+        size_t numFloats = 0;
+        
+        if (!getFloatSamples(changes, pairs, numFloats) || numFloats % 2 != 0)
+            return "Expected a Float32Array of parameter ID / value pairs";
+        
+        for (size_t i = 0; i < numFloats; i += 2) {
+            const float id = pairs[i];
+            
+            if (!(id >= 0.0f && id < JUCEAudioProcessor::numParameterIds) || id != std::floor(id))
+                return "Unknown parameter ID: " + std::to_string(id);
+            
+            const int parameter = static_cast<int>(id);
+            values[parameter] = pairs[i + 1];
+            changed |= 1u << parameter;
+        }
+    } else if (changes.IsObject() && !changes.IsArray()) {
+        Napi::Object object = changes.As<Napi::Object>();
+        Napi::Array names = object.GetPropertyNames();
+        
+        for (uint32_t i = 0; i < names.Length(); ++i) {
+            const std::string name = names.Get(i).ToString().Utf8Value();
+            const int parameter = JUCEAudioProcessor::getParameterIdForName(name.c_str());
+            
+            if (parameter < 0)
+                return "Unknown parameter: " + name;
+            
+            if (!getParameterValue(object.Get(name), values[parameter]))
+                return "Value of " + name + " must be a number or a boolean";
+            
+            changed |= 1u << parameter;
+        }
+    } else {
+        return "Expected an object or a Float32Array";
+    }
+    
+    int parameters[JUCEAudioProcessor::numParameterIds];
+    int numChanges = 0;
+    
+    for (int parameter = 0; parameter < JUCEAudioProcessor::numParameterIds; ++parameter)
+        if ((changed & (1u << parameter)) != 0) {
+            parameters[numChanges] = parameter;
+            values[numChanges++] = values[parameter];
+        }
+    
+    processor.setParameters(parameters, values, numChanges);
+    return {};
+}
+
+// setParameters({ filterCutoff: 800, volume: 0.5 }) or
+// setParameters(new Float32Array([Parameters.filterCutoff, 800, Parameters.volume, 0.5]))
+Napi::Value JUCEAudioProcessorWrapper::SetParameters(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1) {
+        Napi::TypeError::New(env, "Expected an object or a Float32Array").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    try {
+        ensureInitialized();
+        const std::string error = setParametersFrom(*processor, info[0]);
+        
+        if (!error.empty()) {
+            Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in setParameters: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return env.Null();
+}
+
+// Effect settings as a compact binary blob, for saving with a session
+Napi::Value JUCEAudioProcessorWrapper::GetState(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    juce::MemoryBlock state;
+    
+    try {
+        ensureInitialized();
+        processor->getStateInformation(state);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in getState: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return Napi::Buffer<uint8_t>::Copy(env, static_cast<const uint8_t*>(state.getData()), state.getSize());
+}
+
+// Restores settings saved by getState(), from a Buffer, typed array or ArrayBuffer
+Napi::Value JUCEAudioProcessorWrapper::SetState(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    const void* data = nullptr;
+    size_t size = 0;
+    
+    if (info.Length() >= 1 && info[0].IsTypedArray()) {
+        Napi::TypedArray bytes = info[0].As<Napi::TypedArray>();
+        data = static_cast<const uint8_t*>(bytes.ArrayBuffer().Data()) + bytes.ByteOffset();
+        size = bytes.ByteLength();
+    } else if (info.Length() >= 1 && info[0].IsArrayBuffer()) {
+        data = info[0].As<Napi::ArrayBuffer>().Data();
+        size = info[0].As<Napi::ArrayBuffer>().ByteLength();
+    } else {
+        Napi::TypeError::New(env, "Expected a Buffer, typed array or ArrayBuffer").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    try {
+        ensureInitialized();
+        
+        if (!processor->restoreState(data, static_cast<int>(juce::jmin(size, static_cast<size_t>(std::numeric_limits<int>::max()))))) {
+            Napi::TypeError::New(env, "Not a saved processor state").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in setState: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return env.Null();
+}
+
+// Presets are addressed by slot, from 0 to numPresetSlots - 1
+static bool getPresetSlot(const Napi::CallbackInfo& info, int& slot)
+{
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(info.Env(), "Preset slot expected").ThrowAsJavaScriptException();
+        return false;
+    }
+    
+    slot = info[0].As<Napi::Number>().Int32Value();
+    
+    if (!juce::isPositiveAndBelow(slot, JUCEAudioProcessor::numPresetSlots)) {
+        Napi::RangeError::New(info.Env(), "Preset slot must be between 0 and "
+                                              + std::to_string(JUCEAudioProcessor::numPresetSlots - 1))
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+    
+    return true;
+}
+
+Napi::Value JUCEAudioProcessorWrapper::StorePreset(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    int slot = 0;
+    
+    if (!getPresetSlot(info, slot))
+        return env.Null();
+    
+    try {
+        ensureInitialized();
+        processor->storePreset(slot);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in storePreset: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return env.Null();
+}
+
+// Returns false if nothing has been stored in the slot
+Napi::Value JUCEAudioProcessorWrapper::RecallPreset(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    int slot = 0;
+    
+    if (!getPresetSlot(info, slot))
+        return env.Null();
+    
+    try {
+        ensureInitialized();
+        return Napi::Boolean::New(env, processor->recallPreset(slot));
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in recallPreset: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// Describes an audio buffer passed from JS. It is either an array holding one
+// Float32Array per channel, or a single Float32Array/ArrayBuffer holding planar
+// (channel after channel) or interleaved samples. Returns an error message, or
+// nullptr if the buffer is usable.
+static const char* getAudioBlockView(const Napi::Value& buffer, int numChannels, bool interleaved, int maxChannels,
+                                     AudioBlockView& view)
+{
+    const char* channelCountError = maxChannels > maxTrackChannels ? "Expected 1 channel, or 2 for each stem"
+                                                                   : "Expected 1 or 2 channels";
+    float* data = nullptr;
+    size_t numFloats = 0;
+    
+    if (buffer.IsArray()) {
+        Napi::Array channels = buffer.As<Napi::Array>();
+        view.numChannels = static_cast<int>(channels.Length());
+        view.interleaved = false;
+        
+        if (view.numChannels < 1 || view.numChannels > maxChannels)
+            return channelCountError;
+        
+        for (int channel = 0; channel < view.numChannels; ++channel) {
+            if (!getFloatSamples(channels.Get(static_cast<uint32_t>(channel)), data, numFloats))
+                return "Float32Array expected for every channel";
+            
+            if (channel > 0 && static_cast<int>(numFloats) != view.numSamples)
+                return "All channels must have the same length";
+            
+            view.channels[channel] = data;
+            view.numSamples = static_cast<int>(numFloats);
+        }
+        
+        return nullptr;
+    }
+    
+    if (!getFloatSamples(buffer, data, numFloats))
+        return "Float32Array, ArrayBuffer or array of Float32Array expected";
+    
+    if (numChannels < 1 || numChannels > maxChannels)
+        return channelCountError;
+    
+    if (numFloats % static_cast<size_t>(numChannels) != 0)
+        return "Buffer length must be a multiple of the channel count";
+    
+    view.numChannels = numChannels;
+    view.numSamples = static_cast<int>(numFloats / static_cast<size_t>(numChannels));
+    view.interleaved = interleaved;
+    
+    for (int channel = 0; channel < numChannels; ++channel)
+        view.channels[channel] = data + (interleaved ? 0 : channel * view.numSamples);
+    
+    return nullptr;
+}
+
+// Copies a track passed as (buffer, sampleRate, numChannels = 2, interleaved = false),
+// starting at argument firstArgument, with buffer in any form getAudioBlockView()
+// accepts. Given an options object, numChannels and interleaved are read from
+// it instead of the arguments. Returns an error message, or nullptr on success.
+static const char* getTrackFrom(const Napi::CallbackInfo& info, size_t firstArgument,
+                                juce::AudioBuffer<float>& samples, double& sampleRate,
+                                const Napi::Object* options = nullptr)
+{
+    if (info.Length() < firstArgument + 2 || !info[firstArgument + 1].IsNumber())
+        return "Expected a buffer and its sample rate";
+    
+    sampleRate = info[firstArgument + 1].As<Napi::Number>().DoubleValue();
+    
+    if (!(sampleRate > 0.0))
+        return "Sample rate must be positive";
+    
+    const Napi::Value numChannelsValue = options != nullptr ? options->Get("numChannels")
+                                         : info.Length() > firstArgument + 2 ? info[firstArgument + 2]
+                                                                             : info.Env().Undefined();
+    const Napi::Value interleavedValue = options != nullptr ? options->Get("interleaved")
+                                         : info.Length() > firstArgument + 3 ? info[firstArgument + 3]
+                                                                             : info.Env().Undefined();
+    const int numChannels = numChannelsValue.IsNumber() ? numChannelsValue.As<Napi::Number>().Int32Value() : 2;
+    const bool interleaved = interleavedValue.ToBoolean().Value();
+    
+    AudioBlockView view;
+    
+    if (const char* error = getAudioBlockView(info[firstArgument], numChannels, interleaved, maxTrackChannels, view))
+        return error;
+    
+    samples.setSize(view.numChannels, view.numSamples);
+    
+    for (int channel = 0; channel < view.numChannels; ++channel) {
+        if (view.interleaved) {
+            float* destination = samples.getWritePointer(channel);
+            
+            for (int i = 0; i < view.numSamples; ++i)
+                destination[i] = view.channels[0][i * view.numChannels + channel];
+        } else {
+            samples.copyFrom(channel, 0, view.channels[channel], view.numSamples);
+        }
+    }
+    
+    return nullptr;
+}
+
+// loadTrack(buffer, sampleRate, numChannels = 2, interleaved = false)
+//
+// Copies the whole track into native memory, where it replaces the input and
+// can be played and scratched. The track starts paused at its beginning.
+Napi::Value JUCEAudioProcessorWrapper::LoadTrack(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    juce::AudioBuffer<float> samples;
+    double sampleRate = 0.0;
+    
+    if (const char* error = getTrackFrom(info, 0, samples, sampleRate)) {
+        Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    try {
+        ensureInitialized();
+        processor->loadTrack(std::move(samples), sampleRate);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in loadTrack: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return env.Null();
+}
+
+// Runs the processor over a block in place. Planar data is referred to
+// directly, interleaved data goes through the preallocated scratch buffer.
+// A block larger than the processor was prepared for goes through in slices
+// of the prepared size, so the stream carries on without a reset or an
+// allocation.
+void JUCEAudioProcessorWrapper::processBlockView(AudioBlockView& view)
+{
+    jassert(preparedBlockSize > 0);
+    
+    for (int start = 0; start < view.numSamples; start += preparedBlockSize) {
+        const int numSamples = juce::jmin(preparedBlockSize, view.numSamples - start);
+        
+        if (view.interleaved) {
+            using Format = juce::AudioData::Format<juce::AudioData::Float32, juce::AudioData::NativeEndian>;
+            
+            float* const* scratch = interleavedScratch.getArrayOfWritePointers();
+            float* data = view.channels[0] + start * view.numChannels;
+            
+            juce::AudioData::deinterleaveSamples(juce::AudioData::InterleavedSource<Format> { data, view.numChannels },
+                                                 juce::AudioData::NonInterleavedDest<Format> { scratch, view.numChannels },
+                                                 numSamples);
+            
+            processBuffer.setDataToReferTo(scratch, view.numChannels, numSamples);
+            processor->processBlock(processBuffer, midiBuffer);
+            
+            juce::AudioData::interleaveSamples(juce::AudioData::NonInterleavedSource<Format> { scratch, view.numChannels },
+                                               juce::AudioData::InterleavedDest<Format> { data, view.numChannels },
+                                               numSamples);
+        } else {
+            processBuffer.setDataToReferTo(view.channels, view.numChannels, start, numSamples);
+            processor->processBlock(processBuffer, midiBuffer);
+        }
+    }
+}
+
+// The numChannels argument of processAudio and friends, by default every
+// channel the processor has: 2, or 2 per stem
+int JUCEAudioProcessorWrapper::getNumChannelsArgument(const Napi::CallbackInfo& info) const
+{
+    return info.Length() > 1 && info[1].IsNumber() ? info[1].As<Napi::Number>().Int32Value()
+                                                   : processor->getMainBusNumOutputChannels();
+}
+
+// processAudio(buffer, numChannels = 2, interleaved = false)
+//
+// Processes the audio in place and returns the same buffer.
+Napi::Value JUCEAudioProcessorWrapper::ProcessAudio(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1) {
+        Napi::TypeError::New(env, "Float32Array, ArrayBuffer or array of Float32Array expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    if (numPendingAsyncJobs > 0) {
+        Napi::Error::New(env, "processAudio cannot run while asynchronous blocks are pending").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    if (isAudioDeviceRunning()) {
+        Napi::Error::New(env, "processAudio cannot run while the audio device is running").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    bool interleaved = info.Length() > 2 && info[2].IsBoolean() && info[2].As<Napi::Boolean>().Value();
+    
+    try {
+        ensureInitialized();
+        
+        AudioBlockView view;
+        
+        if (const char* error = getAudioBlockView(info[0], getNumChannelsArgument(info), interleaved,
+                                                  processor->getMainBusNumOutputChannels(), view)) {
+            Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        processBlockView(view);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in processAudio: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return info[0];
+}
+
+// processAudioAsync(buffer, numChannels = 2, interleaved = false) -> Promise<buffer>
+//
+// Same as processAudio, but runs on the shared processing pool. Blocks queued
+// on one instance are processed in the order they were queued.
+Napi::Value JUCEAudioProcessorWrapper::ProcessAudioAsync(const Napi::CallbackInfo& info)
+{
+    return queueAsyncJob(info, false);
+}
+
+// processAudioBatch([buffer, ...], numChannels = 2, interleaved = false) -> Promise<[buffer, ...]>
+//
+// Processes several consecutive blocks as a single job on the processing pool.
+Napi::Value JUCEAudioProcessorWrapper::ProcessAudioBatch(const Napi::CallbackInfo& info)
+{
+    return queueAsyncJob(info, true);
+}
+
+Napi::Value JUCEAudioProcessorWrapper::queueAsyncJob(const Napi::CallbackInfo& info, bool isBatch)
+{
+    Napi::Env env = info.Env();
+    auto job = std::make_unique<AsyncProcessJob>(env);
+    Napi::Promise promise = job->deferred.Promise();
+    
+    bool interleaved = info.Length() > 2 && info[2].IsBoolean() && info[2].As<Napi::Boolean>().Value();
+    
+    try {
+        ensureInitialized();
+        
+        const int numChannels = getNumChannelsArgument(info);
+        const int maxChannels = processor->getMainBusNumOutputChannels();
+        
+        if (isAudioDeviceRunning()) {
+            job->deferred.Reject(Napi::Error::New(env, "Blocks cannot be processed while the audio device is running").Value());
+            return promise;
+        }
+        
+        if (info.Length() < 1 || (isBatch && !info[0].IsArray())) {
+            job->deferred.Reject(Napi::TypeError::New(env, isBatch ? "Array of audio buffers expected"
+                                                                    : "Float32Array, ArrayBuffer or array of Float32Array expected").Value());
+            return promise;
+        }
+        
+        if (isBatch) {
+            Napi::Array buffers = info[0].As<Napi::Array>();
+            job->blocks.resize(buffers.Length());
+            
+            for (uint32_t i = 0; i < buffers.Length(); ++i) {
+                if (const char* error = getAudioBlockView(buffers.Get(i), numChannels, interleaved, maxChannels, job->blocks[i])) {
+                    job->deferred.Reject(Napi::TypeError::New(env, error).Value());
+                    return promise;
+                }
+            }
+        } else {
+            job->blocks.resize(1);
+            
+            if (const char* error = getAudioBlockView(info[0], numChannels, interleaved, maxChannels, job->blocks[0])) {
+                job->deferred.Reject(Napi::TypeError::New(env, error).Value());
+                return promise;
+            }
+        }
+    } catch (const std::exception& e) {
+        job->deferred.Reject(Napi::Error::New(env, "Error in processAudioAsync: " + std::string(e.what())).Value());
+        return promise;
+    }
+    
+    job->wrapper = this;
+    job->buffers = Napi::Persistent(info[0]);
+    
+    // Keep this instance and the event loop alive until every block is back
+    if (numPendingAsyncJobs++ == 0)
+        Ref();
+    
+    if (numPendingAsyncJobsTotal++ == 0)
+        asyncCompletion.Ref(env);
+    
+    AsyncProcessJob* queuedJob = job.release();
+    
+    processingQueue.enqueue([this, queuedJob] {
+        try {
+            for (auto& block : queuedJob->blocks)
+                processBlockView(block);
+        } catch (const std::exception& e) {
+            queuedJob->error = e.what();
+        }
+        
+        if (asyncCompletion.NonBlockingCall(queuedJob) != napi_ok) {
+            // The environment is shutting down, so there is no promise left to settle
+            queuedJob->buffers.SuppressDestruct();
+            delete queuedJob;
+        }
+    });
+    
+    return promise;
+}
+
+void JUCEAudioProcessorWrapper::OnAsyncJobComplete(Napi::Env env, Napi::Function, std::nullptr_t*, AsyncProcessJob* job)
+{
+    std::unique_ptr<AsyncProcessJob> completedJob(job);
+    
+    if (env == nullptr) {
+        completedJob->buffers.SuppressDestruct();
+        return;
+    }
+    
+    if (completedJob->error.empty())
+        completedJob->deferred.Resolve(completedJob->buffers.Value());
+    else
+        completedJob->deferred.Reject(Napi::Error::New(env, "Error in processAudioAsync: " + completedJob->error).Value());
+    
+    JUCEAudioProcessorWrapper* wrapper = completedJob->wrapper;
+    
+    if (--wrapper->numPendingAsyncJobs == 0)
+        wrapper->Unref();
+    
+    if (--numPendingAsyncJobsTotal == 0)
+        asyncCompletion.Unref(env);
+}
+
+bool JUCEAudioProcessorWrapper::isAudioDeviceRunning() const
+{
+    return playbackEngine != nullptr && playbackEngine->isRunning();
+}
+
+static juce::String getStringOption(const Napi::Object& options, const char* name)
+{
+    Napi::Value value = options.Get(name);
+    return value.IsString() ? juce::String(value.As<Napi::String>().Utf8Value()) : juce::String();
+}
+
+static double getNumberOption(const Napi::Object& options, const char* name, double defaultValue)
+{
+    Napi::Value value = options.Get(name);
+    return value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : defaultValue;
+}
+
+static Napi::Array toJsArray(Napi::Env env, const juce::StringArray& strings)
+{
+    Napi::Array array = Napi::Array::New(env, static_cast<size_t>(strings.size()));
+    
+    for (int i = 0; i < strings.size(); ++i)
+        array.Set(static_cast<uint32_t>(i), Napi::String::New(env, strings[i].toStdString()));
+    
+    return array;
+}
+
+// startAudioDevice({ type, outputDevice, inputDevice, sampleRate, bufferSize, inputChannels, outputChannels })
+//
+// Moves the processor onto a native audio device callback. Use type "Null" for a
+// headless device that needs no sound hardware.
+Napi::Value JUCEAudioProcessorWrapper::StartAudioDevice(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    Napi::Object options = info.Length() > 0 && info[0].IsObject() ? info[0].As<Napi::Object>() : Napi::Object::New(env);
+    
+    if (numPendingAsyncJobs > 0) {
+        Napi::Error::New(env, "startAudioDevice cannot run while asynchronous blocks are pending").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    try {
+        ensureInitialized();
+        
+        PlaybackEngine::Options engineOptions;
+        engineOptions.deviceType = getStringOption(options, "type");
+        engineOptions.outputDeviceName = getStringOption(options, "outputDevice");
+        engineOptions.inputDeviceName = getStringOption(options, "inputDevice");
+        engineOptions.sampleRate = getNumberOption(options, "sampleRate", 0.0);
+        engineOptions.bufferSize = static_cast<int>(getNumberOption(options, "bufferSize", 0.0));
+        engineOptions.numInputChannels = static_cast<int>(getNumberOption(options, "inputChannels", 2.0));
+        engineOptions.numOutputChannels = static_cast<int>(getNumberOption(options, "outputChannels", 2.0));
+        
+        if (playbackEngine == nullptr)
+            playbackEngine = std::make_unique<PlaybackEngine>(*processor);
+        
+        const auto error = playbackEngine->start(engineOptions);
+        
+        if (error.isNotEmpty()) {
+            prepareProcessor(preparedSampleRate, preparedBlockSize);
+            Napi::Error::New(env, "Failed to start audio device: " + error.toStdString()).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        auto* device = playbackEngine->getCurrentDevice();
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("type", device->getTypeName().toStdString());
+        result.Set("name", device->getName().toStdString());
+        result.Set("sampleRate", device->getCurrentSampleRate());
+        result.Set("bufferSize", device->getCurrentBufferSizeSamples());
+        result.Set("inputLatency", device->getInputLatencyInSamples());
+        result.Set("outputLatency", device->getOutputLatencyInSamples());
+        return result;
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in startAudioDevice: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+Napi::Value JUCEAudioProcessorWrapper::StopAudioDevice(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (isAudioDeviceRunning()) {
+        playbackEngine->stop();
+        
+        // The player released the processor, so get it ready for processAudio again
+        processor->setNumStems(numStems);
+        prepareProcessor(preparedSampleRate, preparedBlockSize);
+    }
+    
+    return env.Null();
+}
+
+Napi::Value JUCEAudioProcessorWrapper::IsAudioDeviceRunning(const Napi::CallbackInfo& info)
+{
+    return Napi::Boolean::New(info.Env(), isAudioDeviceRunning());
+}
+
+// Returns [{ type, outputs: [...], inputs: [...] }] for every available device type
+Napi::Value JUCEAudioProcessorWrapper::GetAudioDeviceTypes(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    try {
+        ensureInitialized();
+        
+        if (playbackEngine == nullptr)
+            playbackEngine = std::make_unique<PlaybackEngine>(*processor);
+        
+        const auto typeNames = playbackEngine->getDeviceTypeNames();
+        Napi::Array types = Napi::Array::New(env, static_cast<size_t>(typeNames.size()));
+        
+        for (int i = 0; i < typeNames.size(); ++i) {
+            Napi::Object type = Napi::Object::New(env);
+            type.Set("type", typeNames[i].toStdString());
+            type.Set("outputs", toJsArray(env, playbackEngine->getDeviceNames(typeNames[i], false)));
+            type.Set("inputs", toJsArray(env, playbackEngine->getDeviceNames(typeNames[i], true)));
+            types.Set(static_cast<uint32_t>(i), type);
+        }
+        
+        return types;
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in getAudioDeviceTypes: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// Returns { levels: [peak per output channel since the last call], cpuUsage, xruns }
+Napi::Value JUCEAudioProcessorWrapper::GetMeters(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    Napi::Object meters = Napi::Object::New(env);
+    
+    int numChannels = 0;
+    
+    if (isAudioDeviceRunning())
+        numChannels = juce::jmin(PlaybackEngine::maxMeterChannels,
+                                 playbackEngine->getCurrentDevice()->getActiveOutputChannels().countNumberOfSetBits());
+    
+    Napi::Array levels = Napi::Array::New(env, static_cast<size_t>(numChannels));
+    
+    for (int channel = 0; channel < numChannels; ++channel)
+        levels.Set(static_cast<uint32_t>(channel), playbackEngine->getOutputPeak(channel));
+    
+    meters.Set("levels", levels);
+    meters.Set("cpuUsage", isAudioDeviceRunning() ? playbackEngine->getCpuUsage() : 0.0);
+    meters.Set("xruns", isAudioDeviceRunning() ? playbackEngine->getXRunCount() : 0);
+    return meters;
+}
+
+// Output levels as of the last processed block: { peak: [left, right],
+// rms: [left, right], momentaryLoudness, shortTermLoudness, integratedLoudness,
+// correlation }. Loudness is in LUFS, -Infinity while there is none.
+Napi::Value JUCEAudioProcessorWrapper::GetLevels(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    try {
+        ensureInitialized();
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in getLevels: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    const auto levels = processor->getOutputMeter().getLevels();
+    Napi::Object result = Napi::Object::New(env);
+    Napi::Array peak = Napi::Array::New(env, 2);
+    Napi::Array rms = Napi::Array::New(env, 2);
+    
+    for (uint32_t channel = 0; channel < 2; ++channel) {
+        peak.Set(channel, levels.peak[channel]);
+        rms.Set(channel, levels.rms[channel]);
+    }
+    
+    result.Set("peak", peak);
+    result.Set("rms", rms);
+    result.Set("momentaryLoudness", levels.momentaryLoudness);
+    result.Set("shortTermLoudness", levels.shortTermLoudness);
+    result.Set("integratedLoudness", levels.integratedLoudness);
+    result.Set("correlation", levels.correlation);
+    return result;
+}
+
+// setMeterBuffer(new Float32Array(new SharedArrayBuffer(...))) makes the audio
+// thread write the levels into it after every block, laid out as in
+// MeterFields, so JS can read them without calling in here. null detaches it.
+Napi::Value JUCEAudioProcessorWrapper::SetMeterBuffer(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    float* data = nullptr;
+    
+    if (!getSharedOutput(info, 0, LevelMeter::numSharedFields, "meter", data))
+        return env.Null();
+    
+    try {
+        ensureInitialized();
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in setMeterBuffer: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    // Only let go of the old array once the audio thread has stopped writing to it
+    processor->getOutputMeter().setSharedOutput(data);
+    meterBuffer.Reset();
+    
+    if (data != nullptr)
+        meterBuffer = Napi::Persistent(info[0]);
+    
+    return env.Null();
+}
+
+// Starts or stops the spectrum analyser's worker thread
+Napi::Value JUCEAudioProcessorWrapper::SetSpectrumEnabled(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsBoolean()) {
+        Napi::TypeError::New(env, "Boolean expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    try {
+        ensureInitialized();
+        processor->getSpectrumAnalyser().setEnabled(info[0].As<Napi::Boolean>().Value());
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in setSpectrumEnabled: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return env.Null();
+}
+
+// Latest spectrum frame: { frequencies, levels, peaks }, levels in dBFS per band
+Napi::Value JUCEAudioProcessorWrapper::GetSpectrum(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    try {
+        ensureInitialized();
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in getSpectrum: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return spectrumToJs(env, processor->getSpectrumAnalyser().getFrame());
+}
+
+// Like setMeterBuffer(), for spectrum frames laid out as in SpectrumFields.
+// They are written by the analyser's worker thread.
+Napi::Value JUCEAudioProcessorWrapper::SetSpectrumBuffer(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    float* data = nullptr;
+    
+    if (!getSharedOutput(info, 0, SpectrumAnalyser::numSharedFields, "spectrum", data))
+        return env.Null();
+    
+    try {
+        ensureInitialized();
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in setSpectrumBuffer: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    processor->getSpectrumAnalyser().setSharedOutput(data);
+    spectrumBuffer.Reset();
+    
+    if (data != nullptr)
+        spectrumBuffer = Napi::Persistent(info[0]);
+    
+    return env.Null();
+}
+
+// How close processBlock runs to its deadline. While the audio device is
+// running, xruns also counts the dropouts the device itself reported.
+Napi::Value JUCEAudioProcessorWrapper::GetPerformanceStats(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    try {
+        ensureInitialized();
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in getPerformanceStats: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    Napi::Object stats = performanceStatsToJs(env, processor->getPerformanceMonitor());
+    stats.Set("xruns", isAudioDeviceRunning() ? playbackEngine->getXRunCount() : 0);
+    return stats;
+}
+
+Napi::Value JUCEAudioProcessorWrapper::ResetPerformanceStats(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    try {
+        ensureInitialized();
+        processor->getPerformanceMonitor().reset();
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in resetPerformanceStats: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return env.Null();
+}
+
+// Starts integrated loudness over, e.g. when a new track starts
+Napi::Value JUCEAudioProcessorWrapper::ResetLoudness(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    try {
+        ensureInitialized();
+        processor->getOutputMeter().resetIntegratedLoudness();
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in resetLoudness: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return env.Null();
+}
+
+// Creates the processor for a render from the options shared by renderFile and
+// renderBuffer: { parameters, pitchShiftQuality = "high", blockSize = 512,
+// bitsPerSample = 24, precision = "single", filterOversampling = 1,
+// onProgress }. Returns an error message, or an empty string.
+static std::string prepareRenderJob(RenderJob& job, const Napi::Value& value)
+{
+    Napi::Object options = value.IsObject() ? value.As<Napi::Object>() : Napi::Object::New(value.Env());
+    JUCEAudioProcessor::PitchShiftQuality quality = JUCEAudioProcessor::PitchShiftQuality::high;
+    
+    if (options.Has("pitchShiftQuality") && !getPitchShiftQuality(options.Get("pitchShiftQuality"), quality))
+        return "pitchShiftQuality must be \"fast\", \"normal\" or \"high\"";
+    
+    job.options.blockSize = static_cast<int>(getNumberOption(options, "blockSize", job.options.blockSize));
+    job.options.bitsPerSample = static_cast<int>(getNumberOption(options, "bitsPerSample", job.options.bitsPerSample));
+    
+    if (options.Has("precision")) {
+        const Napi::Value precision = options.Get("precision");
+        const std::string name = precision.IsString() ? precision.As<Napi::String>().Utf8Value() : std::string();
+        
+        if (name != "single" && name != "double")
+            return "precision must be \"single\" or \"double\"";
+        
+        job.options.doublePrecision = name == "double";
+    }
+    
+    if (job.options.blockSize < 1)
+        return "blockSize must be positive";
+    
+    job.processor = std::make_unique<JUCEAudioProcessor>();
+    job.processor->setPitchShiftQuality(quality);
+    
+    const int filterOversampling = static_cast<int>(getNumberOption(options, "filterOversampling", 1));
+    
+    if (filterOversampling != 1) {
+        if (!job.processor->setFilterOversamplingFactor(filterOversampling))
+            return "filterOversampling must be 1, 2 or 4";
+        
+        job.processor->setFilterOversampled(true);
+    }
+    
+    // Queued until the render prepares the processor, so they apply from the first sample
+    if (options.Has("parameters"))
+        return setParametersFrom(*job.processor, options.Get("parameters"));
+    
+    return {};
+}
+
+// Runs a render on the render pool and returns the promise for its result
+Napi::Value JUCEAudioProcessorWrapper::startRender(Napi::Env env, std::unique_ptr<RenderJob> job, const Napi::Value& options)
+{
+    Napi::Promise promise = job->deferred.Promise();
+    Napi::Value onProgress = options.IsObject() ? options.As<Napi::Object>().Get("onProgress") : env.Undefined();
+    
+    RenderJob* renderJob = job.release();
+    RenderCallback callback = RenderCallback::New(env, onProgress.IsFunction() ? onProgress.As<Napi::Function>() : Napi::Function(),
+                                                  renderJob->isFile ? "renderFile" : "renderBuffer", 0, 1, renderJob,
+                                                  [](Napi::Env, void*, RenderJob* finishedJob) { delete finishedJob; });
+    
+    OfflineRenderer::getRenderPool().addJob([renderJob, callback]() mutable {
+        auto send = [&callback](double progress, bool finished) {
+            auto* update = new RenderUpdate { progress, finished };
+            
+            // Fails only while the environment is shutting down
+            if (callback.NonBlockingCall(update) != napi_ok)
+                delete update;
+        };
+        
+        auto reportProgress = [&send](double progress) { send(progress, false); };
+        
+        try {
+            if (renderJob->isFile)
+                renderJob->result = OfflineRenderer::renderFile(*renderJob->processor, renderJob->input, renderJob->output,
+                                                                renderJob->options, reportProgress);
+            else
+                renderJob->result = OfflineRenderer::renderBuffer(*renderJob->processor, renderJob->samples, renderJob->sampleRate,
+                                                                  renderJob->options, reportProgress);
+        } catch (const std::exception& e) {
+            renderJob->result.error = e.what();
+        }
+        
+        renderJob->processor.reset();
+        send(1.0, true);
+        callback.Release();
+    });
+    
+    return promise;
+}
+
+void JUCEAudioProcessorWrapper::OnRenderUpdate(Napi::Env env, Napi::Function onProgress, RenderJob* job, RenderUpdate* update)
+{
+    std::unique_ptr<RenderUpdate> received(update);
+    
+    if (env == nullptr)
+        return;
+    
+    if (!received->finished) {
+        if (!onProgress.IsEmpty())
+            onProgress.Call({ Napi::Number::New(env, received->progress) });
+        
+        return;
+    }
+    
+    const auto& result = job->result;
+    
+    if (result.error.isNotEmpty()) {
+        job->deferred.Reject(Napi::Error::New(env, result.error.toStdString()).Value());
+        return;
+    }
+    
+    if (!job->isFile) {
+        Napi::Array channels = Napi::Array::New(env, static_cast<size_t>(job->samples.getNumChannels()));
+        
+        for (int channel = 0; channel < job->samples.getNumChannels(); ++channel) {
+            Napi::Float32Array samples = Napi::Float32Array::New(env, static_cast<size_t>(job->samples.getNumSamples()));
+            std::copy_n(job->samples.getReadPointer(channel), job->samples.getNumSamples(), samples.Data());
+            channels.Set(static_cast<uint32_t>(channel), samples);
+        }
+        
+        job->deferred.Resolve(channels);
+        return;
+    }
+    
+    Napi::Object info = Napi::Object::New(env);
+    info.Set("numSamples", static_cast<double>(result.numSamples));
+    info.Set("sampleRate", result.sampleRate);
+    info.Set("numChannels", result.numChannels);
+    job->deferred.Resolve(info);
+}
+
+// JUCEAudioProcessor.renderFile(inputPath, outputPath, options)
+//
+// Renders a file through a new processor, faster than real time and off the JS
+// thread. Resolves with { numSamples, sampleRate, numChannels }.
+Napi::Value JUCEAudioProcessorWrapper::RenderFile(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    auto job = std::make_unique<RenderJob>(env);
+    Napi::Promise promise = job->deferred.Promise();
+    
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
+        job->deferred.Reject(Napi::TypeError::New(env, "Expected input and output file paths").Value());
+        return promise;
+    }
+    
+    // Relative paths are resolved against the current directory
+    const auto cwd = juce::File::getCurrentWorkingDirectory();
+    job->input = cwd.getChildFile(info[0].As<Napi::String>().Utf8Value());
+    job->output = cwd.getChildFile(info[1].As<Napi::String>().Utf8Value());
+    
+    const Napi::Value options = info.Length() > 2 ? info[2] : env.Undefined();
+    
+    try {
+        const std::string error = prepareRenderJob(*job, options);
+        
+        if (!error.empty()) {
+            job->deferred.Reject(Napi::TypeError::New(env, error).Value());
+            return promise;
+        }
+    } catch (const std::exception& e) {
+        job->deferred.Reject(Napi::Error::New(env, "Error in renderFile: " + std::string(e.what())).Value());
+        return promise;
+    }
+    
+    return startRender(env, std::move(job), options);
+}
+
+// JUCEAudioProcessor.renderBuffer(buffer, sampleRate, options)
+//
+// Like renderFile, for audio already in memory in any form processAudio
+// accepts. A single buffer is laid out as options.numChannels (default 2)
+// channels, interleaved if options.interleaved is set. The input is copied and
+// left untouched; resolves with an array holding one Float32Array per channel.
+Napi::Value JUCEAudioProcessorWrapper::RenderBuffer(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    auto job = std::make_unique<RenderJob>(env);
+    Napi::Promise promise = job->deferred.Promise();
+    job->isFile = false;
+    
+    const Napi::Value options = info.Length() > 2 && info[2].IsObject() ? info[2] : env.Undefined();
+    const Napi::Object layout = options.IsObject() ? options.As<Napi::Object>() : Napi::Object::New(env);
+    
+    if (const char* error = getTrackFrom(info, 0, job->samples, job->sampleRate, &layout)) {
+        job->deferred.Reject(Napi::TypeError::New(env, error).Value());
+        return promise;
+    }
+    
+    try {
+        const std::string error = prepareRenderJob(*job, options);
+        
+        if (!error.empty()) {
+            job->deferred.Reject(Napi::TypeError::New(env, error).Value());
+            return promise;
+        }
+    } catch (const std::exception& e) {
+        job->deferred.Reject(Napi::Error::New(env, "Error in renderBuffer: " + std::string(e.what())).Value());
+        return promise;
+    }
+    
+    return startRender(env, std::move(job), options);
+}
+
+class DeckEngineWrapper : public Napi::ObjectWrap<DeckEngineWrapper>
+{
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    DeckEngineWrapper(const Napi::CallbackInfo& info);
+
+private:
+    static constexpr int defaultNumDecks = 4;
+    static constexpr int maxNumDecks = 16;
+    static constexpr double defaultSampleRate = 44100.0;
+    static constexpr int defaultBlockSize = 512;
+
+    static Napi::FunctionReference constructor;
+    std::unique_ptr<DeckEngine> engine;
+    
+    // Sized once in the constructor, filled with pointers into JS memory per call
+    std::vector<float*> deckChannels;
+    float* outputChannels[DeckEngine::numChannels] = {};
+
+    // The Float32Array each deck's spectrum analyser writes into, if any
+    std::vector<Napi::Reference<Napi::Value>> spectrumBuffers;
+
+    bool getDeckIndex(const Napi::CallbackInfo& info, int& deck);
+
+    Napi::Value PrepareToPlay(const Napi::CallbackInfo& info);
+    Napi::Value Process(const Napi::CallbackInfo& info);
+    Napi::Value SetDeckGain(const Napi::CallbackInfo& info);
+    Napi::Value SetDeckParameter(const Napi::CallbackInfo& info);
+    Napi::Value SetDeckParameters(const Napi::CallbackInfo& info);
+    Napi::Value LoadTrack(const Napi::CallbackInfo& info);
+    Napi::Value SetCrossfader(const Napi::CallbackInfo& info);
+    Napi::Value SetCrossfaderAssignment(const Napi::CallbackInfo& info);
+    Napi::Value SetMasterVolume(const Napi::CallbackInfo& info);
+    Napi::Value GetNumDecks(const Napi::CallbackInfo& info);
+    Napi::Value SetPitchShiftQuality(const Napi::CallbackInfo& info);
+    Napi::Value GetLatencySamples(const Napi::CallbackInfo& info);
+    Napi::Value GetDeckPerformanceStats(const Napi::CallbackInfo& info);
+    Napi::Value SetDeckSpectrumEnabled(const Napi::CallbackInfo& info);
+    Napi::Value GetDeckSpectrum(const Napi::CallbackInfo& info);
+    Napi::Value SetDeckSpectrumBuffer(const Napi::CallbackInfo& info);
+};
+
+Napi::FunctionReference DeckEngineWrapper::constructor;
+
+Napi::Object DeckEngineWrapper::Init(Napi::Env env, Napi::Object exports)
+{
+    Napi::HandleScope scope(env);
+
+    Napi::Function func = DefineClass(env, "DeckEngine", {
+        InstanceMethod("prepareToPlay", &DeckEngineWrapper::PrepareToPlay),
+        InstanceMethod("process", &DeckEngineWrapper::Process),
+        InstanceMethod("setDeckGain", &DeckEngineWrapper::SetDeckGain),
+        InstanceMethod("setDeckParameter", &DeckEngineWrapper::SetDeckParameter),
+        InstanceMethod("setDeckParameters", &DeckEngineWrapper::SetDeckParameters),
+        InstanceMethod("loadTrack", &DeckEngineWrapper::LoadTrack),
+        InstanceMethod("setCrossfader", &DeckEngineWrapper::SetCrossfader),
+        InstanceMethod("setCrossfaderAssignment", &DeckEngineWrapper::SetCrossfaderAssignment),
+        InstanceMethod("setMasterVolume", &DeckEngineWrapper::SetMasterVolume),
+        InstanceMethod("getNumDecks", &DeckEngineWrapper::GetNumDecks),
+        InstanceMethod("setPitchShiftQuality", &DeckEngineWrapper::SetPitchShiftQuality),
+        InstanceMethod("getLatencySamples", &DeckEngineWrapper::GetLatencySamples),
+        InstanceMethod("getDeckPerformanceStats", &DeckEngineWrapper::GetDeckPerformanceStats),
+        InstanceMethod("setDeckSpectrumEnabled", &DeckEngineWrapper::SetDeckSpectrumEnabled),
+        InstanceMethod("getDeckSpectrum", &DeckEngineWrapper::GetDeckSpectrum),
+        InstanceMethod("setDeckSpectrumBuffer", &DeckEngineWrapper::SetDeckSpectrumBuffer)
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("DeckEngine", func);
+    return exports;
+}
+
+// new DeckEngine(numDecks = 4)
+DeckEngineWrapper::DeckEngineWrapper(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<DeckEngineWrapper>(info)
+{
+    Napi::Env env = info.Env();
+    int numDecks = info.Length() > 0 && info[0].IsNumber() ? info[0].As<Napi::Number>().Int32Value() : defaultNumDecks;
+    
+    if (numDecks < 1 || numDecks > maxNumDecks) {
+        Napi::RangeError::New(env, "Number of decks must be between 1 and 16").ThrowAsJavaScriptException();
+        return;
+    }
+    
+    try {
+        engine = std::make_unique<DeckEngine>(numDecks);
+        engine->prepareToPlay(defaultSampleRate, defaultBlockSize);
+        deckChannels.resize(static_cast<size_t>(numDecks * DeckEngine::numChannels));
+        spectrumBuffers.resize(static_cast<size_t>(numDecks));
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Failed to create deck engine: " + std::string(e.what())).ThrowAsJavaScriptException();
+    }
+}
+
+bool DeckEngineWrapper::getDeckIndex(const Napi::CallbackInfo& info, int& deck)
+{
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(info.Env(), "Deck index expected").ThrowAsJavaScriptException();
+        return false;
+    }
+    
+    deck = info[0].As<Napi::Number>().Int32Value();
+    
+    if (!juce::isPositiveAndBelow(deck, engine->getNumDecks())) {
+        Napi::RangeError::New(info.Env(), "Deck index out of range").ThrowAsJavaScriptException();
+        return false;
+    }
+    
+    return true;
+}
+
+Napi::Value DeckEngineWrapper::PrepareToPlay(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+        Napi::TypeError::New(env, "Expected sample rate and maximum block size").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    double sampleRate = info[0].As<Napi::Number>().DoubleValue();
+    int maximumBlockSize = info[1].As<Napi::Number>().Int32Value();
+    
+    if (sampleRate <= 0.0 || maximumBlockSize <= 0) {
+        Napi::RangeError::New(env, "Sample rate and block size must be positive").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    engine->prepareToPlay(sampleRate, maximumBlockSize);
+    return env.Null();
+}
+
+// process(inputs, output)
+//
+// inputs is either one Float32Array holding every deck's planar stereo audio,
+// deck after deck, or an array with one planar stereo Float32Array per deck.
+// The decks are processed in place and mixed into output (planar stereo),
+// which is returned.
+Napi::Value DeckEngineWrapper::Process(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    float* output = nullptr;
+    size_t outputLength = 0;
+    
+    if (info.Length() < 2 || !getFloatSamples(info[1], output, outputLength)) {
+        Napi::TypeError::New(env, "Expected deck inputs and a Float32Array output").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    const int numChannels = DeckEngine::numChannels;
+    const int numDecks = engine->getNumDecks();
+    const int numSamples = static_cast<int>(outputLength / numChannels);
+    const size_t deckLength = static_cast<size_t>(numSamples * numChannels);
+    
+    float* data = nullptr;
+    size_t length = 0;
+    
+    if (info[0].IsArray()) {
+        Napi::Array inputs = info[0].As<Napi::Array>();
+        
+        if (static_cast<int>(inputs.Length()) != numDecks) {
+            Napi::RangeError::New(env, "Expected one input per deck").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        for (int deck = 0; deck < numDecks; ++deck) {
+            // Right follows left at numSamples, so any other length would misplace it
+            if (!getFloatSamples(inputs.Get(static_cast<uint32_t>(deck)), data, length) || length != deckLength) {
+                Napi::TypeError::New(env, "Every deck input must be a Float32Array as long as the output").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            
+            for (int channel = 0; channel < numChannels; ++channel)
+                deckChannels[static_cast<size_t>(deck * numChannels + channel)] = data + channel * numSamples;
+        }
+    } else {
+        if (!getFloatSamples(info[0], data, length) || length != deckLength * static_cast<size_t>(numDecks)) {
+            Napi::TypeError::New(env, "Deck input must hold exactly one planar stereo block per deck").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        for (int i = 0; i < numDecks * numChannels; ++i)
+            deckChannels[static_cast<size_t>(i)] = data + i * numSamples;
+    }
+    
+    for (int channel = 0; channel < numChannels; ++channel)
+        outputChannels[channel] = output + channel * numSamples;
+    
+    try {
+        engine->process(deckChannels.data(), outputChannels, numSamples);
+    } catch (const std::exception& e) {
+        Napi::Error::New(env, "Error in process: " + std::string(e.what())).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return info[1];
+}
+
+Napi::Value DeckEngineWrapper::SetDeckGain(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    int deck = 0;
+    
+    if (!getDeckIndex(info, deck))
+        return env.Null();
+    
+    if (info.Length() < 2 || !info[1].IsNumber()) {
+        Napi::TypeError::New(env, "Number expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    engine->setDeckGain(deck, info[1].As<Napi::Number>().FloatValue());
+    return env.Null();
+}
+
+// setDeckParameter(deck, name, value), e.g. setDeckParameter(0, "filterCutoff", 800)
+Napi::Value DeckEngineWrapper::SetDeckParameter(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    int deck = 0;
+    
+    if (!getDeckIndex(info, deck))
+        return env.Null();
+    
+    if (info.Length() < 3 || !info[1].IsString() || !(info[2].IsNumber() || info[2].IsBoolean())) {
+        Napi::TypeError::New(env, "Expected a parameter name and a value").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    const int parameter = JUCEAudioProcessor::getParameterIdForName(info[1].As<Napi::String>().Utf8Value().c_str());
+    
+    if (parameter < 0) {
+        Napi::TypeError::New(env, "Unknown parameter: " + info[1].As<Napi::String>().Utf8Value()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    float value = 0.0f;
+    getParameterValue(info[2], value);
+    
+    engine->getDeck(deck).setParameter(static_cast<JUCEAudioProcessor::ParameterId>(parameter), value);
+    return env.Null();
+}
+
+// setDeckParameters(deck, changes) - the batched form, taking the same
+// arguments as JUCEAudioProcessor.setParameters()
+Napi::Value DeckEngineWrapper::SetDeckParameters(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    int deck = 0;
+    
+    if (!getDeckIndex(info, deck))
+        return env.Null();
+    
+    const std::string error = info.Length() < 2 ? std::string("Expected an object or a Float32Array")
+                                                : setParametersFrom(engine->getDeck(deck), info[1]);
+    
+    if (!error.empty())
+        Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+    
+    return env.Null();
+}
+
+// loadTrack(deck, buffer, sampleRate, numChannels = 2, interleaved = false) - the
+// deck plays the track instead of its input. Transport and jog wheel are driven
+// with setDeckParameters, e.g. { playing: true, jogWheelPosition: 0.25 }.
+Napi::Value DeckEngineWrapper::LoadTrack(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    int deck = 0;
+    
+    if (!getDeckIndex(info, deck))
+        return env.Null();
+    
+    juce::AudioBuffer<float> samples;
+    double sampleRate = 0.0;
+    
+    if (const char* error = getTrackFrom(info, 1, samples, sampleRate)) {
+        Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    engine->getDeck(deck).loadTrack(std::move(samples), sampleRate);
+    return env.Null();
+}
+
+Napi::Value DeckEngineWrapper::SetCrossfader(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Number expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    engine->setCrossfader(info[0].As<Napi::Number>().FloatValue());
+    return env.Null();
+}
+
+// setCrossfaderAssignment(deck, "A" | "B" | "thru")
+Napi::Value DeckEngineWrapper::SetCrossfaderAssignment(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    int deck = 0;
+    
+    if (!getDeckIndex(info, deck))
+        return env.Null();
+    
+    const std::string side = info.Length() > 1 && info[1].IsString() ? info[1].As<Napi::String>().Utf8Value() : std::string();
+    
+    if (side == "A")
+        engine->setCrossfaderAssignment(deck, DeckEngine::crossfaderA);
+    else if (side == "B")
+        engine->setCrossfaderAssignment(deck, DeckEngine::crossfaderB);
+    else if (side == "thru")
+        engine->setCrossfaderAssignment(deck, DeckEngine::crossfaderThru);
+    else
+        Napi::TypeError::New(env, "Expected \"A\", \"B\" or \"thru\"").ThrowAsJavaScriptException();
+    
+    return env.Null();
+}
+
+Napi::Value DeckEngineWrapper::SetMasterVolume(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Number expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    engine->setMasterVolume(info[0].As<Napi::Number>().FloatValue());
+    return env.Null();
+}
+
+Napi::Value DeckEngineWrapper::GetNumDecks(const Napi::CallbackInfo& info)
+{
+    return Napi::Number::New(info.Env(), engine->getNumDecks());
+}
+
+// setPitchShiftQuality("fast" | "normal" | "high") - applies to every deck
+Napi::Value DeckEngineWrapper::SetPitchShiftQuality(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    JUCEAudioProcessor::PitchShiftQuality quality;
+    
+    if (info.Length() < 1 || !getPitchShiftQuality(info[0], quality)) {
+        Napi::TypeError::New(env, "Expected \"fast\", \"normal\" or \"high\"").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    for (int deck = 0; deck < engine->getNumDecks(); ++deck)
+        engine->getDeck(deck).setPitchShiftQuality(quality);
+    
+    return env.Null();
+}
+
+// Every deck has the same latency
+Napi::Value DeckEngineWrapper::GetLatencySamples(const Napi::CallbackInfo& info)
+{
+    return Napi::Number::New(info.Env(), engine->getDeck(0).getLatencySamples());
+}
+
+// The same snapshot as JUCEAudioProcessor.getPerformanceStats(), for one deck's chain
+Napi::Value DeckEngineWrapper::GetDeckPerformanceStats(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    int deck = 0;
+    
+    if (!getDeckIndex(info, deck))
+        return env.Null();
+    
+    return performanceStatsToJs(env, engine->getDeck(deck).getPerformanceMonitor());
+}
+
+// setDeckSpectrumEnabled(deck, enabled)
+Napi::Value DeckEngineWrapper::SetDeckSpectrumEnabled(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    int deck = 0;
+    
+    if (!getDeckIndex(info, deck))
+        return env.Null();
+    
+    if (info.Length() < 2 || !info[1].IsBoolean()) {
+        Napi::TypeError::New(env, "Boolean expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    engine->getDeck(deck).getSpectrumAnalyser().setEnabled(info[1].As<Napi::Boolean>().Value());
+    return env.Null();
+}
+
+Napi::Value DeckEngineWrapper::GetDeckSpectrum(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    int deck = 0;
+    
+    if (!getDeckIndex(info, deck))
+        return env.Null();
+    
+    return spectrumToJs(env, engine->getDeck(deck).getSpectrumAnalyser().getFrame());
+}
+
+// setDeckSpectrumBuffer(deck, float32Array | null), laid out as in JUCEAudioProcessor.SpectrumFields
+Napi::Value DeckEngineWrapper::SetDeckSpectrumBuffer(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    int deck = 0;
+    float* data = nullptr;
+    
+    if (!getDeckIndex(info, deck) || !getSharedOutput(info, 1, SpectrumAnalyser::numSharedFields, "spectrum", data))
+        return env.Null();
+    
+    auto& buffer = spectrumBuffers[static_cast<size_t>(deck)];
+    engine->getDeck(deck).getSpectrumAnalyser().setSharedOutput(data);
+    buffer.Reset();
+    
+    if (data != nullptr)
+        buffer = Napi::Persistent(info[1]);
+    
+    return env.Null();
+}
+
+class SharedMemoryChannelWrapper : public Napi::ObjectWrap<SharedMemoryChannelWrapper>
+{
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    SharedMemoryChannelWrapper(const Napi::CallbackInfo& info);
+    ~SharedMemoryChannelWrapper();
+
+private:
+    // Control ring message types
+    enum MessageType : uint32_t
+    {
+        textMessage = 1,
+        parameterMessage = 2,
+        audioMessage = 3
+    };
+
+    // Sleeps on the channel's doorbell and tells the JS thread when messages
+    // arrive. It waits for each notification to be handled before it sleeps
+    // again, so a burst of messages costs a single call into JS.
+    class Listener : public juce::Thread
+    {
+    public:
+        explicit Listener(SharedMemoryChannelWrapper& owner)
+            : juce::Thread("JUCE Shared Memory Listener"), wrapper(owner) {}
+
+        void run() override;
+
+        juce::WaitableEvent handled;
+
+    private:
+        SharedMemoryChannelWrapper& wrapper;
+    };
+
+    static void OnReceive(Napi::Env env, Napi::Function callback, SharedMemoryChannelWrapper* wrapper, std::nullptr_t*);
+    using ReceiveCallback = Napi::TypedThreadSafeFunction<SharedMemoryChannelWrapper, std::nullptr_t, &SharedMemoryChannelWrapper::OnReceive>;
+
+    static Napi::FunctionReference constructor;
+    std::unique_ptr<SharedMemoryChannel> channel;
+    std::unique_ptr<Listener> listener;
+    ReceiveCallback receiveCallback;
+
+    // Reused by receive(), so reading never allocates once it has grown
+    juce::HeapBlock<char> receiveBuffer;
+    size_t receiveBufferSize = 0;
+
+    bool isOpen(Napi::Env env);
+    void stopListening();
+
+    static Napi::Value Create(const Napi::CallbackInfo& info);
+    static Napi::Value Open(const Napi::CallbackInfo& info);
+    Napi::Value Send(const Napi::CallbackInfo& info);
+    Napi::Value Receive(const Napi::CallbackInfo& info);
+    Napi::Value WriteAudio(const Napi::CallbackInfo& info);
+    Napi::Value ReadAudio(const Napi::CallbackInfo& info);
+    Napi::Value Wait(const Napi::CallbackInfo& info);
+    Napi::Value OnReceiveMethod(const Napi::CallbackInfo& info);
+    Napi::Value GetName(const Napi::CallbackInfo& info);
+    Napi::Value Close(const Napi::CallbackInfo& info);
+};
+
+Napi::FunctionReference SharedMemoryChannelWrapper::constructor;
+
+Napi::Object SharedMemoryChannelWrapper::Init(Napi::Env env, Napi::Object exports)
+{
+    Napi::HandleScope scope(env);
+
+    Napi::Function func = DefineClass(env, "SharedMemoryChannel", {
+        StaticMethod("create", &SharedMemoryChannelWrapper::Create),
+        StaticMethod("open", &SharedMemoryChannelWrapper::Open),
+        InstanceMethod("send", &SharedMemoryChannelWrapper::Send),
+        InstanceMethod("receive", &SharedMemoryChannelWrapper::Receive),
+        InstanceMethod("writeAudio", &SharedMemoryChannelWrapper::WriteAudio),
+        InstanceMethod("readAudio", &SharedMemoryChannelWrapper::ReadAudio),
+        InstanceMethod("wait", &SharedMemoryChannelWrapper::Wait),
+        InstanceMethod("onReceive", &SharedMemoryChannelWrapper::OnReceiveMethod),
+        InstanceMethod("getName", &SharedMemoryChannelWrapper::GetName),
+        InstanceMethod("close", &SharedMemoryChannelWrapper::Close)
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("SharedMemoryChannel", func);
+    return exports;
+}
+
+// Only reached through create() and open(): new SharedMemoryChannel(name, create, options)
+SharedMemoryChannelWrapper::SharedMemoryChannelWrapper(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<SharedMemoryChannelWrapper>(info)
+{
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsBoolean()) {
+        Napi::TypeError::New(env, "Use SharedMemoryChannel.create() or SharedMemoryChannel.open()").ThrowAsJavaScriptException();
+        return;
+    }
+    
+    const juce::String name(info[0].As<Napi::String>().Utf8Value());
+    juce::String error;
+    
+    if (info[1].As<Napi::Boolean>().Value()) {
+        Napi::Object options = info.Length() > 2 && info[2].IsObject() ? info[2].As<Napi::Object>() : Napi::Object::New(env);
+        const double controlBytes = getNumberOption(options, "controlBytes", SharedMemoryChannel::defaultControlBytes);
+        const double audioBytes = getNumberOption(options, "audioBytes", SharedMemoryChannel::defaultAudioBytes);
+        
+        if (!(controlBytes > 0 && controlBytes <= 1 << 30 && audioBytes > 0 && audioBytes <= 1 << 30)) {
+            Napi::RangeError::New(env, "Ring sizes must be between 1 byte and 1 GiB").ThrowAsJavaScriptException();
+            return;
+        }
+        
+        channel = SharedMemoryChannel::create(name, static_cast<size_t>(controlBytes), static_cast<size_t>(audioBytes), error);
+    } else {
+        channel = SharedMemoryChannel::open(name, error);
+    }
+    
+    if (channel == nullptr)
+        Napi::Error::New(env, error.toStdString()).ThrowAsJavaScriptException();
+}
+
+SharedMemoryChannelWrapper::~SharedMemoryChannelWrapper()
+{
+    if (channel != nullptr)
+        stopListening();
+}
+
+// SharedMemoryChannel.create(name, { controlBytes = 65536, audioBytes = 1048576 })
+Napi::Value SharedMemoryChannelWrapper::Create(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    Napi::Value name = info.Length() > 0 ? info[0] : env.Undefined();
+    Napi::Value options = info.Length() > 1 ? info[1] : env.Undefined();
+    return constructor.New({ name, Napi::Boolean::New(env, true), options });
+}
+
+// SharedMemoryChannel.open(name) - attaches to a channel created by another process
+Napi::Value SharedMemoryChannelWrapper::Open(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    Napi::Value name = info.Length() > 0 ? info[0] : env.Undefined();
+    return constructor.New({ name, Napi::Boolean::New(env, false) });
+}
+
+bool SharedMemoryChannelWrapper::isOpen(Napi::Env env)
+{
+    if (channel == nullptr)
+        Napi::Error::New(env, "Channel is closed").ThrowAsJavaScriptException();
+    
+    return channel != nullptr;
+}
+
+// send(message) - a string, or a Float32Array of parameter ID / value pairs in
+// the same form setParameters() takes. Returns false if the ring is full.
+Napi::Value SharedMemoryChannelWrapper::Send(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (!isOpen(env))
+        return env.Null();
+    
+    float* pairs = nullptr;
+    size_t numFloats = 0;
+    bool sent = false;
+    
+    if (info.Length() > 0 && info[0].IsString()) {
+        const std::string text = info[0].As<Napi::String>().Utf8Value();
+        sent = channel->write(SharedMemoryChannel::controlRing, textMessage, 0, text.data(), text.size());
+    } else if (info.Length() > 0 && getFloatSamples(info[0], pairs, numFloats)) {
+        sent = channel->write(SharedMemoryChannel::controlRing, parameterMessage, 0, pairs, numFloats * sizeof(float));
+    } else {
+        Napi::TypeError::New(env, "Expected a string or a Float32Array").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    return Napi::Boolean::New(env, sent);
+}
+
+// receive() - the next control message, or null if there is none
+Napi::Value SharedMemoryChannelWrapper::Receive(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (!isOpen(env))
+        return env.Null();
+    
+    const int64_t size = channel->getNextMessageSize(SharedMemoryChannel::controlRing);
+    
+    if (size < 0)
+        return env.Null();
+    
+    if (static_cast<size_t>(size) > receiveBufferSize) {
+        receiveBufferSize = static_cast<size_t>(size);
+        receiveBuffer.realloc(receiveBufferSize);
+    }
+    
+    uint32_t type = 0, tag = 0;
+    
+    if (!channel->read(SharedMemoryChannel::controlRing, type, tag, receiveBuffer.get(), receiveBufferSize))
+        return env.Null();
+    
+    if (type == parameterMessage) {
+        Napi::Float32Array pairs = Napi::Float32Array::New(env, static_cast<size_t>(size) / sizeof(float));
+        std::memcpy(pairs.Data(), receiveBuffer.get(), static_cast<size_t>(size));
+        return pairs;
+    }
+    
+    return Napi::String::New(env, receiveBuffer.get(), static_cast<size_t>(size));
+}
+
+// writeAudio(samples, tag = 0) - copies a Float32Array or ArrayBuffer into the
+// audio ring. The tag is passed through, e.g. to match replies to requests.
+// Returns false if the ring is full.
+Napi::Value SharedMemoryChannelWrapper::WriteAudio(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (!isOpen(env))
+        return env.Null();
+    
+    float* samples = nullptr;
+    size_t numFloats = 0;
+    
+    if (info.Length() < 1 || !getFloatSamples(info[0], samples, numFloats)) {
+        Napi::TypeError::New(env, "Float32Array or ArrayBuffer expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    if (numFloats * sizeof(float) > channel->getMaxMessageSize(SharedMemoryChannel::audioRing)) {
+        Napi::RangeError::New(env, "Audio block is larger than half the audio ring").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    const uint32_t tag = info.Length() > 1 && info[1].IsNumber() ? info[1].As<Napi::Number>().Uint32Value() : 0;
+    return Napi::Boolean::New(env, channel->write(SharedMemoryChannel::audioRing, audioMessage, tag,
+                                                  samples, numFloats * sizeof(float)));
+}
+
+// readAudio(destination) - copies the next audio block into a Float32Array
+// and returns { tag, length }, or null if there is none
+Napi::Value SharedMemoryChannelWrapper::ReadAudio(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (!isOpen(env))
+        return env.Null();
+    
+    float* destination = nullptr;
+    size_t numFloats = 0;
+    
+    if (info.Length() < 1 || !getFloatSamples(info[0], destination, numFloats)) {
+        Napi::TypeError::New(env, "Float32Array or ArrayBuffer expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    const int64_t size = channel->getNextMessageSize(SharedMemoryChannel::audioRing);
+    
+    if (size < 0)
+        return env.Null();
+    
+    if (static_cast<size_t>(size) > numFloats * sizeof(float)) {
+        Napi::RangeError::New(env, "Destination is too small for the next audio block").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    uint32_t type = 0, tag = 0;
+    
+    if (!channel->read(SharedMemoryChannel::audioRing, type, tag, destination, numFloats * sizeof(float)))
+        return env.Null();
+    
+    Napi::Object block = Napi::Object::New(env);
+    block.Set("tag", tag);
+    block.Set("length", static_cast<double>(size) / sizeof(float));
+    return block;
+}
+
+// wait(timeoutMs = -1) - blocks the calling thread until a message arrives.
+// Returns true if one is waiting.
+Napi::Value SharedMemoryChannelWrapper::Wait(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (!isOpen(env))
+        return env.Null();
+    
+    const int timeoutMs = info.Length() > 0 && info[0].IsNumber() ? info[0].As<Napi::Number>().Int32Value() : -1;
+    return Napi::Boolean::New(env, channel->wait(timeoutMs));
+}
+
+void SharedMemoryChannelWrapper::Listener::run()
+{
+    while (!threadShouldExit()) {
+        if (!wrapper.channel->wait(-1))
+            continue;
+        
+        if (threadShouldExit() || wrapper.receiveCallback.NonBlockingCall() != napi_ok)
+            return;
+        
+        handled.wait();
+    }
+}
+
+void SharedMemoryChannelWrapper::OnReceive(Napi::Env env, Napi::Function callback, SharedMemoryChannelWrapper* wrapper, std::nullptr_t*)
+{
+    if (env != nullptr && wrapper->listener != nullptr)
+        callback.Call(wrapper->Value(), {});
+    
+    if (wrapper->listener != nullptr)
+        wrapper->listener->handled.signal();
+}
+
+// onReceive(callback) - calls callback on the JS thread whenever messages are
+// waiting; it should drain them with receive() and readAudio(). While a
+// callback is set, the channel keeps the event loop alive. onReceive(null) stops.
+Napi::Value SharedMemoryChannelWrapper::OnReceiveMethod(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (!isOpen(env))
+        return env.Null();
+    
+    stopListening();
+    
+    if (info.Length() < 1 || info[0].IsNull() || info[0].IsUndefined())
+        return env.Null();
+    
+    if (!info[0].IsFunction()) {
+        Napi::TypeError::New(env, "Function expected").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    receiveCallback = ReceiveCallback::New(env, info[0].As<Napi::Function>(), "SharedMemoryChannel", 0, 1, this);
+    listener = std::make_unique<Listener>(*this);
+    listener->startThread(juce::Thread::Priority::high);
+    return env.Null();
+}
+
+void SharedMemoryChannelWrapper::stopListening()
+{
+    if (listener == nullptr)
+        return;
+    
+    listener->signalThreadShouldExit();
+    channel->wake();
+    listener->handled.signal();
+    listener->stopThread(-1);
+    listener.reset();
+    receiveCallback.Release();
+}
+
+Napi::Value SharedMemoryChannelWrapper::GetName(const Napi::CallbackInfo& info)
+{
+    Napi::Env env = info.Env();
+    
+    if (!isOpen(env))
+        return env.Null();
+    
+    return Napi::String::New(env, channel->getName().toStdString());
+}
+
+// close() - stops listening and unmaps the channel; the creating side also
+// removes its name
+Napi::Value SharedMemoryChannelWrapper::Close(const Napi::CallbackInfo& info)
+{
+    if (channel != nullptr) {
+        stopListening();
+        channel.reset();
+    }
+    
+    return info.Env().Null();
+}
+
 Napi::Object Init(Napi::Env env, Napi::Object exports)
 {
-    return JUCEAudioProcessorWrapper::Init(env, exports);
+    JUCEAudioProcessorWrapper::Init(env, exports);
+    DeckEngineWrapper::Init(env, exports);
+    return SharedMemoryChannelWrapper::Init(env, exports);
 }
 
 NODE_API_MODULE(juce_audio_processor, Init)
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+// Wraps a processor so it can be switched in and out without a click: while
+// the switch happens, the output crossfades between the dry input and the
+// processed signal. Once fully bypassed the processor doesn't run at all, and
+// it is reset before it fades back in, so it never replays stale state such
+// as the contents of a delay line. A processor that needs time to fill up
+// again can be given a warm-up, during which it runs unheard before the fade
+// starts. Fits into a juce::dsp::ProcessorChain.
+template <typename SampleType, typename Processor>
+class BypassCrossfade
+{
+public:
+    static constexpr double crossfadeSeconds = 0.02;
+
+    Processor& getProcessor() noexcept { return processor; }
+    const Processor& getProcessor() const noexcept { return processor; }
+
+    // How long the processor runs after a reset before it is faded in
+    void setWarmUpTime(double seconds) noexcept { warmUpSeconds = seconds; }
+
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        processor.prepare(spec);
+        warmUpLength = juce::roundToInt(warmUpSeconds * spec.sampleRate);
+        warmUpRemaining = 0;
+        dry.setSize(static_cast<int>(spec.numChannels), static_cast<int>(spec.maximumBlockSize));
+        wetGain.reset(spec.sampleRate, crossfadeSeconds);
+        wetGain.setCurrentAndTargetValue(enabled ? SampleType(1) : SampleType(0));
+    }
+
+    void reset() noexcept
+    {
+        processor.reset();
+        warmUpRemaining = 0;
+        wetGain.setCurrentAndTargetValue(enabled ? SampleType(1) : SampleType(0));
+    }
+
+    // Audio thread - starts the crossfade towards the new state
+    void setEnabled(bool shouldBeEnabled) noexcept
+    {
+        if (shouldBeEnabled == enabled)
+            return;
+
+        const bool restarting = shouldBeEnabled && !isActive();
+        enabled = shouldBeEnabled;
+        warmUpRemaining = 0;
+
+        if (restarting) {
+            processor.reset();
+            warmUpRemaining = warmUpLength;
+        }
+
+        // Fading in waits for the warm-up to finish
+        if (warmUpRemaining == 0)
+            wetGain.setTargetValue(enabled ? SampleType(1) : SampleType(0));
+    }
+
+    bool isEnabled() const noexcept { return enabled; }
+
+    // False once a bypass has fully faded out and the processor has stopped
+    bool isActive() const noexcept { return enabled || wetGain.isSmoothing(); }
+
+    // Replacing contexts only
+    template <typename ProcessContext>
+    void process(const ProcessContext& context) noexcept
+    {
+        if (!wetGain.isSmoothing() && warmUpRemaining == 0) {
+            if (enabled)
+                processor.process(context);
+
+            return;
+        }
+
+        auto& block = context.getOutputBlock();
+        const auto numChannels = block.getNumChannels();
+        const auto numSamples = block.getNumSamples();
+        jassert(numChannels <= static_cast<size_t>(dry.getNumChannels())
+                && numSamples <= static_cast<size_t>(dry.getNumSamples()));
+
+        for (size_t channel = 0; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::copy(dry.getWritePointer(static_cast<int>(channel)),
+                                              block.getChannelPointer(channel), static_cast<int>(numSamples));
+
+        processor.process(context);
+
+        // Warming up, a whole sub-block at a time: keep the dry signal
+        if (warmUpRemaining > 0) {
+            for (size_t channel = 0; channel < numChannels; ++channel)
+                juce::FloatVectorOperations::copy(block.getChannelPointer(channel), dry.getReadPointer(static_cast<int>(channel)),
+                                                  static_cast<int>(numSamples));
+
+            warmUpRemaining = juce::jmax(0, warmUpRemaining - static_cast<int>(numSamples));
+
+            if (warmUpRemaining == 0)
+                wetGain.setTargetValue(SampleType(1));
+
+            return;
+        }
+
+        // The gain ramps linearly, so each channel can step it on its own
+        const auto start = wetGain.getCurrentValue();
+        const auto step = (wetGain.skip(static_cast<int>(numSamples)) - start) / static_cast<SampleType>(numSamples);
+
+        for (size_t channel = 0; channel < numChannels; ++channel) {
+            auto* output = block.getChannelPointer(channel);
+            const auto* input = dry.getReadPointer(static_cast<int>(channel));
+            auto gain = start;
+
+            for (size_t i = 0; i < numSamples; ++i) {
+                gain += step;
+                output[i] = input[i] + gain * (output[i] - input[i]);
+            }
+        }
+    }
+
+private:
+    Processor processor;
+    juce::AudioBuffer<SampleType> dry;
+    juce::SmoothedValue<SampleType> wetGain { SampleType(0) };
+    bool enabled = false;
+    double warmUpSeconds = 0.0;
+    int warmUpLength = 0;
+    int warmUpRemaining = 0;
+};
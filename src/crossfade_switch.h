@@ -0,0 +1,138 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+// Switches between two processors that do the same job in different ways,
+// such as a filter at the sample rate and the same filter oversampled, without
+// a click: while the switch happens both run on the same input and the output
+// crossfades from one to the other. Otherwise only the selected one runs. The
+// one being switched to is reset first, so it never replays stale state, and
+// runs unheard for the warm-up time before the fade starts, so it has settled
+// on the input by the time it is heard. Like BypassCrossfade, it fits into a
+// juce::dsp::ProcessorChain.
+template <typename SampleType, typename First, typename Second>
+class CrossfadeSwitch
+{
+public:
+    static constexpr double crossfadeSeconds = 0.02;
+
+    First& getFirst() noexcept { return first; }
+    Second& getSecond() noexcept { return second; }
+
+    // How long the processor switched to runs after a reset before it is faded in
+    void setWarmUpTime(double seconds) noexcept { warmUpSeconds = seconds; }
+
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        first.prepare(spec);
+        second.prepare(spec);
+        warmUpLength = juce::roundToInt(warmUpSeconds * spec.sampleRate);
+        warmUpRemaining = 0;
+        alternate.setSize(static_cast<int>(spec.numChannels), static_cast<int>(spec.maximumBlockSize));
+        secondGain.reset(spec.sampleRate, crossfadeSeconds);
+        secondGain.setCurrentAndTargetValue(secondSelected ? SampleType(1) : SampleType(0));
+    }
+
+    // Drops any switch in progress, leaving the selected processor on its own
+    void reset() noexcept
+    {
+        first.reset();
+        second.reset();
+        warmUpRemaining = 0;
+        secondGain.setCurrentAndTargetValue(secondSelected ? SampleType(1) : SampleType(0));
+    }
+
+    // Audio thread - starts the switch towards the given processor
+    void setSecondSelected(bool shouldSelectSecond) noexcept
+    {
+        if (shouldSelectSecond == secondSelected)
+            return;
+
+        // Switching back during a fade just turns it around, as both are running
+        const bool restarting = !isSwitching();
+        secondSelected = shouldSelectSecond;
+        warmUpRemaining = 0;
+
+        if (restarting) {
+            if (secondSelected)
+                second.reset();
+            else
+                first.reset();
+
+            warmUpRemaining = warmUpLength;
+        }
+
+        if (warmUpRemaining == 0)
+            secondGain.setTargetValue(secondSelected ? SampleType(1) : SampleType(0));
+    }
+
+    bool isSecondSelected() const noexcept { return secondSelected; }
+
+    // True while both processors run
+    bool isSwitching() const noexcept { return warmUpRemaining > 0 || secondGain.isSmoothing(); }
+
+    // Replacing contexts only
+    template <typename ProcessContext>
+    void process(const ProcessContext& context) noexcept
+    {
+        if (!isSwitching()) {
+            if (secondSelected)
+                second.process(context);
+            else
+                first.process(context);
+
+            return;
+        }
+
+        auto& block = context.getOutputBlock();
+        const auto numChannels = block.getNumChannels();
+        const auto numSamples = block.getNumSamples();
+        jassert(numChannels <= static_cast<size_t>(alternate.getNumChannels())
+                && numSamples <= static_cast<size_t>(alternate.getNumSamples()));
+
+        // The first processor works on a copy, the second in place
+        auto firstBlock = juce::dsp::AudioBlock<SampleType>(alternate).getSubBlock(0, numSamples)
+                                                                       .getSubsetChannelBlock(0, numChannels);
+        firstBlock.copyFrom(block);
+        first.process(juce::dsp::ProcessContextReplacing<SampleType>(firstBlock));
+        second.process(context);
+
+        // Warming up, a whole sub-block at a time: keep the one that was heard
+        if (warmUpRemaining > 0) {
+            if (secondSelected)
+                block.copyFrom(firstBlock);
+
+            warmUpRemaining = juce::jmax(0, warmUpRemaining - static_cast<int>(numSamples));
+
+            if (warmUpRemaining == 0)
+                secondGain.setTargetValue(secondSelected ? SampleType(1) : SampleType(0));
+
+            return;
+        }
+
+        // The gain ramps linearly, so each channel can step it on its own
+        const auto start = secondGain.getCurrentValue();
+        const auto step = (secondGain.skip(static_cast<int>(numSamples)) - start) / static_cast<SampleType>(numSamples);
+
+        for (size_t channel = 0; channel < numChannels; ++channel) {
+            auto* output = block.getChannelPointer(channel);
+            const auto* firstOutput = firstBlock.getChannelPointer(channel);
+            auto gain = start;
+
+            for (size_t i = 0; i < numSamples; ++i) {
+                gain += step;
+                output[i] = firstOutput[i] + gain * (output[i] - firstOutput[i]);
+            }
+        }
+    }
+
+private:
+    First first;
+    Second second;
+    juce::AudioBuffer<SampleType> alternate;
+    juce::SmoothedValue<SampleType> secondGain { SampleType(0) };
+    bool secondSelected = false;
+    double warmUpSeconds = 0.0;
+    int warmUpLength = 0;
+    int warmUpRemaining = 0;
+};
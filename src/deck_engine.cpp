@@ -0,0 +1,131 @@
+#include "deck_engine.h"
+
+namespace
+{
+    constexpr double gainRampSeconds = 0.02;
+}
+
+DeckEngine::DeckEngine(int numDecks)
+{
+    for (int i = 0; i < juce::jmax(1, numDecks); ++i) {
+        decks.add(new JUCEAudioProcessor());
+        mixes.add(new DeckMix());
+    }
+}
+
+DeckEngine::~DeckEngine() = default;
+
+int DeckEngine::getNumDecks() const
+{
+    return decks.size();
+}
+
+JUCEAudioProcessor& DeckEngine::getDeck(int deck)
+{
+    jassert(juce::isPositiveAndBelow(deck, decks.size()));
+    return *decks.getUnchecked(deck);
+}
+
+void DeckEngine::prepareToPlay(double sampleRate, int maximumBlockSize)
+{
+    currentSampleRate = sampleRate;
+    preparedBlockSize = maximumBlockSize;
+
+    for (auto* deck : decks) {
+        deck->setRateAndBufferSizeDetails(sampleRate, maximumBlockSize);
+        deck->prepareToPlay(sampleRate, maximumBlockSize);
+    }
+
+    for (auto* mix : mixes)
+        mix->smoothedGain.reset(sampleRate, gainRampSeconds);
+
+    smoothedMasterVolume.reset(sampleRate, gainRampSeconds);
+}
+
+void DeckEngine::process(float* const* deckChannels, float* const* outputChannels, int numSamples)
+{
+    jassert(preparedBlockSize > 0);
+
+    // Slicing keeps the stream going, where growing the decks would reset and allocate
+    for (int start = 0; start < numSamples; start += preparedBlockSize)
+        processSlice(deckChannels, outputChannels, start, juce::jmin(preparedBlockSize, numSamples - start));
+}
+
+void DeckEngine::processSlice(float* const* deckChannels, float* const* outputChannels, int startSample, int numSamples)
+{
+    outputBuffer.setDataToReferTo(outputChannels, numChannels, startSample, numSamples);
+    outputBuffer.clear();
+
+    const float crossfaderPosition = crossfader.load(std::memory_order_relaxed);
+
+    for (int deck = 0; deck < decks.size(); ++deck) {
+        deckBuffer.setDataToReferTo(deckChannels + deck * numChannels, numChannels, startSample, numSamples);
+        auto& processor = *decks.getUnchecked(deck);
+        processor.processBlock(deckBuffer, midiBuffer);
+
+        auto& mix = *mixes.getUnchecked(deck);
+        mix.smoothedGain.setTargetValue(mix.gain.load(std::memory_order_relaxed)
+                                        * getCrossfaderGain(mix.side.load(std::memory_order_relaxed), crossfaderPosition));
+
+        const float startGain = mix.smoothedGain.getCurrentValue();
+        const float endGain = mix.smoothedGain.skip(numSamples);
+
+        // An idle deck came out as digital silence, which adds nothing
+        if ((startGain == 0.0f && endGain == 0.0f) || processor.isIdle())
+            continue;
+
+        for (int channel = 0; channel < numChannels; ++channel) {
+            if (startGain == endGain)
+                juce::FloatVectorOperations::addWithMultiply(outputBuffer.getWritePointer(channel),
+                                                             deckBuffer.getReadPointer(channel), endGain, numSamples);
+            else
+                outputBuffer.addFromWithRamp(channel, 0, deckBuffer.getReadPointer(channel), numSamples, startGain, endGain);
+        }
+    }
+
+    smoothedMasterVolume.setTargetValue(masterVolume.load(std::memory_order_relaxed));
+
+    const float startVolume = smoothedMasterVolume.getCurrentValue();
+    const float endVolume = smoothedMasterVolume.skip(numSamples);
+
+    if (startVolume != endVolume)
+        outputBuffer.applyGainRamp(0, numSamples, startVolume, endVolume);
+    else if (endVolume != 1.0f)
+        outputBuffer.applyGain(endVolume);
+}
+
+void DeckEngine::setDeckGain(int deck, float gain)
+{
+    if (juce::isPositiveAndBelow(deck, mixes.size()))
+        mixes.getUnchecked(deck)->gain.store(juce::jmax(0.0f, gain));
+}
+
+void DeckEngine::setCrossfaderAssignment(int deck, CrossfaderSide side)
+{
+    if (juce::isPositiveAndBelow(deck, mixes.size()))
+        mixes.getUnchecked(deck)->side.store(side);
+}
+
+void DeckEngine::setCrossfader(float position)
+{
+    crossfader.store(juce::jlimit(0.0f, 1.0f, position));
+}
+
+void DeckEngine::setMasterVolume(float volume)
+{
+    masterVolume.store(juce::jmax(0.0f, volume));
+}
+
+// Constant-power curve: both sides sit at -3 dB in the centre. The far end
+// is exactly 0, where float cos(pi / 2) would leave a trace of the deck.
+float DeckEngine::getCrossfaderGain(int side, float position) const
+{
+    switch (side) {
+        case crossfaderA:
+            return juce::jmax(0.0f, std::cos(position * juce::MathConstants<float>::halfPi));
+        case crossfaderB:
+            return std::sin(position * juce::MathConstants<float>::halfPi);
+        default:
+            return 1.0f;
+    }
+}
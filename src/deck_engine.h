@@ -0,0 +1,65 @@
+#pragma once
+
+#include "juce_audio_processor.h"
+
+// Owns several deck chains and mixes them onto a stereo master bus, with a
+// gain per deck, a crossfader and a master volume. All decks are processed
+// and mixed in a single process() call.
+class DeckEngine
+{
+public:
+    enum CrossfaderSide
+    {
+        crossfaderA,
+        crossfaderThru,
+        crossfaderB
+    };
+
+    static constexpr int numChannels = 2;
+
+    explicit DeckEngine(int numDecks);
+    ~DeckEngine();
+
+    int getNumDecks() const;
+    JUCEAudioProcessor& getDeck(int deck);
+
+    void prepareToPlay(double sampleRate, int maximumBlockSize);
+
+    // Processes every deck in place and mixes them into the output.
+    // deckChannels holds numChannels pointers per deck, deck after deck. A
+    // block larger than prepared for is processed in slices of that size.
+    void process(float* const* deckChannels, float* const* outputChannels, int numSamples);
+
+    // Mixer controls - safe to call from any single control thread
+    void setDeckGain(int deck, float gain);
+    void setCrossfaderAssignment(int deck, CrossfaderSide side);
+    void setCrossfader(float position);
+    void setMasterVolume(float volume);
+
+private:
+    struct DeckMix
+    {
+        std::atomic<float> gain { 1.0f };
+        std::atomic<int> side { crossfaderThru };
+        juce::SmoothedValue<float> smoothedGain { 1.0f };
+    };
+
+    float getCrossfaderGain(int side, float position) const;
+    void processSlice(float* const* deckChannels, float* const* outputChannels, int startSample, int numSamples);
+
+    juce::OwnedArray<JUCEAudioProcessor> decks;
+    juce::OwnedArray<DeckMix> mixes;
+    std::atomic<float> crossfader { 0.5f };
+    std::atomic<float> masterVolume { 1.0f };
+    juce::SmoothedValue<float> smoothedMasterVolume { 1.0f };
+
+    // Only ever refer to the caller's memory
+    juce::AudioBuffer<float> deckBuffer;
+    juce::AudioBuffer<float> outputBuffer;
+    juce::MidiBuffer midiBuffer;
+
+    double currentSampleRate = 44100.0;
+    int preparedBlockSize = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DeckEngine)
+};
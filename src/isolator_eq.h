@@ -0,0 +1,375 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+// Three-band isolator (kill) EQ. Two 4th order Linkwitz-Riley crossovers
+// with the response of juce::dsp::LinkwitzRileyFilter split the signal into
+// low, mid and high bands, which are mixed back with their own gains. The low
+// band also goes through the high crossover's allpass, so with every gain at
+// 1 the bands sum to a flat (allpass) response, and at 0 a band is gone.
+//
+// It runs on every deck all the time, so it is built to be cheap. The three
+// bands only ever have two sets of poles, the Butterworth pair of each
+// crossover twice over, so the whole EQ is the sum of two 4th order filters
+// running side by side on the input: one with the low crossover's poles and
+// one with the high crossover's. Each is a pair of the crossovers' low-pass
+// sections, and what the bands need from their states is fitted once in
+// prepare(). As the two filters don't feed each other, they share SIMD
+// registers: the low half of the lanes runs the low one for a group of
+// channels and the high half the high one, and the two halves are added
+// back up per channel. Gains ramp linearly over each block from the values
+// of the block before, so they are smoothed per sample.
+template <typename SampleType>
+class IsolatorEQ
+{
+public:
+    using Vector = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr int numLanes = static_cast<int>(Vector::size());
+    static constexpr int channelsPerGroup = numLanes / 2;
+    static_assert(numLanes % 2 == 0, "Each channel takes two lanes");
+
+    enum Band { lowBand, midBand, highBand, numBands };
+
+    // Crossover frequencies between the bands, in Hz
+    static constexpr double lowCrossoverFrequency = 300.0;
+    static constexpr double highCrossoverFrequency = 4000.0;
+
+    // The crossovers used at a sample rate. At low rates the high one comes
+    // down below Nyquist, as the filter's cutoff does, and the low one stays
+    // an octave under it, so the two sets of poles never meet.
+    static double getHighCrossoverFrequency(double sampleRate) noexcept
+    {
+        return juce::jmin(highCrossoverFrequency, sampleRate * 0.49);
+    }
+
+    static double getLowCrossoverFrequency(double sampleRate) noexcept
+    {
+        return juce::jmin(lowCrossoverFrequency, getHighCrossoverFrequency(sampleRate) * 0.5);
+    }
+
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        numChannels = static_cast<int>(spec.numChannels);
+
+        const auto lowTerms = getSectionTerms(getLowCrossoverFrequency(spec.sampleRate), spec.sampleRate);
+        const auto highTerms = getSectionTerms(getHighCrossoverFrequency(spec.sampleRate), spec.sampleRate);
+        const auto outputs = fitBandOutputs(lowTerms, highTerms, spec.sampleRate);
+
+        // Low lanes take the low crossover's poles, high lanes the high one's
+        const auto split = [](double lowValue, double highValue)
+        {
+            Vector v;
+
+            for (size_t lane = 0; lane < static_cast<size_t>(numLanes); ++lane)
+                v.set(lane, static_cast<SampleType>(lane < static_cast<size_t>(channelsPerGroup) ? lowValue : highValue));
+
+            return v;
+        };
+
+        for (size_t term = 0; term < 3; ++term) {
+            coefficients.s1[term] = split(lowTerms.s1[term], highTerms.s1[term]);
+            coefficients.s2[term] = split(lowTerms.s2[term], highTerms.s2[term]);
+            coefficients.lowPass[term] = split(lowTerms.lowPass[term], highTerms.lowPass[term]);
+        }
+
+        for (size_t band = 0; band < numBands; ++band) {
+            for (size_t s = 0; s < numStates; ++s)
+                bandOutputs[band][s] = split(outputs[band][s], outputs[band][numStates + s]);
+
+            // The input feeds straight through in the low lanes only, so it is counted once
+            bandOutputs[band][numStates] = split(outputs[band][2 * numStates], 0.0);
+        }
+
+        state.resize(static_cast<size_t>((numChannels + channelsPerGroup - 1) / channelsPerGroup));
+        interleaved.resize(static_cast<size_t>(spec.maximumBlockSize));
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for (auto& group : state)
+            group.fill(Vector::expand(SampleType(0)));
+
+        currentGains = targetGains;
+    }
+
+    // Linear gain of one band, reached by the end of the next block
+    void setGain(Band band, SampleType gain) noexcept { targetGains[static_cast<size_t>(band)] = gain; }
+
+    // Channels beyond the prepared count are left untouched
+    template <typename ProcessContext>
+    void process(const ProcessContext& context) noexcept
+    {
+        const auto& inputBlock = context.getInputBlock();
+        auto& outputBlock = context.getOutputBlock();
+        const int channelsToProcess = juce::jmin(numChannels, static_cast<int>(outputBlock.getNumChannels()));
+        const int numSamples = static_cast<int>(outputBlock.getNumSamples());
+
+        jassert(numSamples <= static_cast<int>(interleaved.size()));
+
+        if (numSamples == 0)
+            return;
+
+        auto* lanes = reinterpret_cast<SampleType*>(interleaved.data());
+
+        // The output taps are linear in the gains, so they ramp linearly too
+        OutputTaps taps, steps;
+
+        for (size_t tap = 0; tap < taps.size(); ++tap) {
+            taps[tap] = Vector::expand(SampleType(0));
+            steps[tap] = Vector::expand(SampleType(0));
+
+            for (size_t band = 0; band < numBands; ++band) {
+                taps[tap] += bandOutputs[band][tap] * currentGains[band];
+                steps[tap] += bandOutputs[band][tap]
+                              * ((targetGains[band] - currentGains[band]) / static_cast<SampleType>(numSamples));
+            }
+        }
+
+        for (int firstChannel = 0; firstChannel < channelsToProcess; firstChannel += channelsPerGroup) {
+            const int channelsUsed = juce::jmin(channelsPerGroup, channelsToProcess - firstChannel);
+
+            // Both halves of the lanes take the same channel; unused ones filter silence
+            for (int channel = 0; channel < channelsPerGroup; ++channel) {
+                const int lowLane = channel;
+                const int highLane = channel + channelsPerGroup;
+
+                if (channel < channelsUsed) {
+                    const auto* input = inputBlock.getChannelPointer(static_cast<size_t>(firstChannel + channel));
+
+                    for (int i = 0; i < numSamples; ++i)
+                        lanes[i * numLanes + lowLane] = lanes[i * numLanes + highLane] = input[i];
+                } else {
+                    for (int i = 0; i < numSamples; ++i)
+                        lanes[i * numLanes + lowLane] = lanes[i * numLanes + highLane] = SampleType(0);
+                }
+            }
+
+            auto& groupState = state[static_cast<size_t>(firstChannel / channelsPerGroup)];
+
+            if (currentGains == targetGains)
+                processGroup<false>(groupState, numSamples, taps, steps);
+            else
+                processGroup<true>(groupState, numSamples, taps, steps);
+
+            for (int channel = 0; channel < channelsUsed; ++channel) {
+                auto* output = outputBlock.getChannelPointer(static_cast<size_t>(firstChannel + channel));
+
+                for (int i = 0; i < numSamples; ++i)
+                    output[i] = lanes[i * numLanes + channel] + lanes[i * numLanes + channel + channelsPerGroup];
+            }
+        }
+
+        currentGains = targetGains;
+    }
+
+private:
+    // One crossover section: the TPT state variable filter of
+    // juce::dsp::LinkwitzRileyFilter, expanded so the next states and the
+    // outputs each come straight from the input and the current states, as
+    // [input, s1, s2] terms
+    struct SectionTerms
+    {
+        std::array<double, 3> s1, s2, lowPass, allpass;
+    };
+
+    static SectionTerms getSectionTerms(double frequency, double sampleRate) noexcept
+    {
+        const double g = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+        const double R2 = juce::MathConstants<double>::sqrt2;
+        const double h = 1.0 / (1.0 + R2 * g + g * g);
+
+        // highPass = h (x - (R2 + g) s1 - s2), bandPass = g highPass + s1,
+        // lowPass = g bandPass + s2, s1' = g highPass + bandPass and
+        // s2' = g bandPass + lowPass
+        const double high[] = { h, -h * (R2 + g), -h };
+        const double band[] = { g * high[0], g * high[1] + 1.0, g * high[2] };
+        const double lowPass[] = { g * band[0], g * band[1], g * band[2] + 1.0 };
+
+        SectionTerms terms;
+
+        for (size_t i = 0; i < 3; ++i) {
+            terms.s1[i] = 2.0 * g * high[i] + (i == 1 ? 1.0 : 0.0);
+            terms.s2[i] = 2.0 * g * band[i] + (i == 2 ? 1.0 : 0.0);
+            terms.lowPass[i] = lowPass[i];
+            terms.allpass[i] = lowPass[i] - R2 * band[i] + high[i];
+        }
+
+        return terms;
+    }
+
+    // Per filter, the states of a section and of a second one on its low-pass output
+    enum { numStates = 4 };
+
+    // Each band, in terms of the four states of the low crossover's filter,
+    // the four of the high one's and the input. The bands are worked out
+    // sample by sample as crossovers in cascade, as LinkwitzRileyFilter would,
+    // and matched by least squares to the two filters run on the same
+    // impulse, in double precision. The match is exact up to rounding, as the
+    // two filters together can make any response with the bands' poles.
+    static std::array<std::array<double, 2 * numStates + 1>, numBands>
+        fitBandOutputs(const SectionTerms& low, const SectionTerms& high, double sampleRate)
+    {
+        constexpr size_t numTerms = 2 * numStates + 1;
+        const auto length = static_cast<size_t>(juce::jmax(64, juce::roundToInt(sampleRate * 0.02)));
+
+        // Returns the low-pass output, sets the allpass one and advances the state
+        const auto run = [](const SectionTerms& t, double x, double& s1, double& s2, double& allpass)
+        {
+            const double lowPass = t.lowPass[0] * x + t.lowPass[1] * s1 + t.lowPass[2] * s2;
+            allpass = t.allpass[0] * x + t.allpass[1] * s1 + t.allpass[2] * s2;
+            const double nextS1 = t.s1[0] * x + t.s1[1] * s1 + t.s1[2] * s2;
+            s2 = t.s2[0] * x + t.s2[1] * s1 + t.s2[2] * s2;
+            s1 = nextS1;
+            return lowPass;
+        };
+
+        // Column-major, a column per term, and the bands' impulse responses
+        std::vector<double> basis(numTerms * length);
+        std::array<std::vector<double>, numBands> bands;
+
+        for (auto& band : bands)
+            band.resize(length);
+
+        std::array<double, 10> cascade {};
+        std::array<double, 2 * numStates> parallel {};
+        double unused;
+
+        for (size_t n = 0; n < length; ++n) {
+            const double x = n == 0 ? 1.0 : 0.0;
+
+            for (size_t s = 0; s < parallel.size(); ++s)
+                basis[s * length + n] = parallel[s];
+
+            basis[2 * numStates * length + n] = x;
+
+            double lowAllpass, highAllpass, lowBandAligned;
+            const double lowBandSignal = run(low, run(low, x, cascade[0], cascade[1], lowAllpass), cascade[2], cascade[3], unused);
+            const double midBandSignal = run(high, run(high, lowAllpass - lowBandSignal, cascade[4], cascade[5], highAllpass),
+                                             cascade[6], cascade[7], unused);
+            run(high, lowBandSignal, cascade[8], cascade[9], lowBandAligned);
+
+            bands[lowBand][n] = lowBandAligned;
+            bands[midBand][n] = midBandSignal;
+            bands[highBand][n] = highAllpass - midBandSignal;
+
+            run(low, run(low, x, parallel[0], parallel[1], unused), parallel[2], parallel[3], unused);
+            run(high, run(high, x, parallel[4], parallel[5], unused), parallel[6], parallel[7], unused);
+        }
+
+        // Householder QR, applied to the bands as it goes
+        for (size_t k = 0; k < numTerms; ++k) {
+            double* column = basis.data() + k * length;
+            double norm = 0.0;
+
+            for (size_t n = k; n < length; ++n)
+                norm += column[n] * column[n];
+
+            norm = std::sqrt(norm);
+            const double alpha = column[k] > 0.0 ? -norm : norm;
+            std::vector<double> v(column + k, column + length);
+            v[0] -= alpha;
+
+            double vNorm = 0.0;
+
+            for (auto value : v)
+                vNorm += value * value;
+
+            if (vNorm == 0.0)
+                continue;
+
+            const auto reflect = [&](double* target)
+            {
+                double dot = 0.0;
+
+                for (size_t n = k; n < length; ++n)
+                    dot += v[n - k] * target[n];
+
+                const double scale = 2.0 * dot / vNorm;
+
+                for (size_t n = k; n < length; ++n)
+                    target[n] -= scale * v[n - k];
+            };
+
+            for (size_t j = k; j < numTerms; ++j)
+                reflect(basis.data() + j * length);
+
+            for (auto& band : bands)
+                reflect(band.data());
+        }
+
+        std::array<std::array<double, numTerms>, numBands> outputs {};
+
+        for (size_t band = 0; band < numBands; ++band) {
+            for (size_t k = numTerms; k-- > 0;) {
+                double sum = bands[band][k];
+
+                for (size_t j = k + 1; j < numTerms; ++j)
+                    sum -= basis[j * length + k] * outputs[band][j];
+
+                outputs[band][k] = sum / basis[k * length + k];
+            }
+        }
+
+        return outputs;
+    }
+
+    // Next states and the low-pass output of a section, as [input, s1, s2] terms per lane
+    struct Coefficients
+    {
+        std::array<Vector, 3> s1, s2, lowPass;
+    };
+
+    // The weights of the four states and the input in an output, per lane
+    using OutputTaps = std::array<Vector, numStates + 1>;
+    using GroupState = std::array<Vector, numStates>;
+
+    // Gains are steady most of the time, and then skip the ramp
+    template <bool ramping>
+    void processGroup(GroupState& s, int numSamples, OutputTaps taps, const OutputTaps& steps) noexcept
+    {
+        // Local copies stay in registers through the loop
+        auto s1 = s[0], s2 = s[1], s3 = s[2], s4 = s[3];
+        const auto c = coefficients;
+
+        for (int i = 0; i < numSamples; ++i) {
+            auto& sample = interleaved[static_cast<size_t>(i)];
+            const auto x = sample;
+
+            if constexpr (ramping) {
+                for (size_t tap = 0; tap < taps.size(); ++tap)
+                    taps[tap] += steps[tap];
+            }
+
+            sample = s1 * taps[0] + s2 * taps[1] + s3 * taps[2] + s4 * taps[3] + x * taps[4];
+
+            // The second section runs on the first one's low-pass output
+            const auto u = x * c.lowPass[0] + s1 * c.lowPass[1] + s2 * c.lowPass[2];
+            const auto next1 = x * c.s1[0] + s1 * c.s1[1] + s2 * c.s1[2];
+            const auto next2 = x * c.s2[0] + s1 * c.s2[1] + s2 * c.s2[2];
+            const auto next3 = u * c.s1[0] + s3 * c.s1[1] + s4 * c.s1[2];
+            s4 = u * c.s2[0] + s3 * c.s2[1] + s4 * c.s2[2];
+            s1 = next1;
+            s2 = next2;
+            s3 = next3;
+        }
+
+        s = { s1, s2, s3, s4 };
+    }
+
+    int numChannels = 0;
+    Coefficients coefficients {};
+    std::array<OutputTaps, numBands> bandOutputs {};
+    std::array<SampleType, numBands> currentGains { SampleType(1), SampleType(1), SampleType(1) };
+    std::array<SampleType, numBands> targetGains { SampleType(1), SampleType(1), SampleType(1) };
+
+    // Filter state, one set per group of channelsPerGroup channels
+    std::vector<GroupState> state;
+
+    // One register per sample of the group being filtered
+    std::vector<Vector> interleaved;
+};
@@ -1,21 +1,158 @@
 #include "juce_audio_processor.h"
 
+const char* JUCEAudioProcessor::getParameterIdName(int parameter)
+{
+    static const char* const names[] = {
+        "pitchBend",
+        "flangerEnabled",
+        "flangerRate",
+        "flangerDepth",
+        "filterCutoff",
+        "filterResonance",
+        "jogWheelPosition",
+        "volume",
+        "jogWheelTouched",
+        "playing",
+        "playbackRate",
+        "seekPosition",
+        "eqLow",
+        "eqMid",
+        "eqHigh"
+    };
+
+    static_assert(std::size(names) == numParameterIds, "Every parameter needs a name");
+
+    return juce::isPositiveAndBelow(parameter, numParameterIds) ? names[parameter] : nullptr;
+}
+
+int JUCEAudioProcessor::getParameterIdForName(juce::StringRef name)
+{
+    for (int parameter = 0; parameter < numParameterIds; ++parameter)
+        if (name == juce::StringRef(getParameterIdName(parameter)))
+            return parameter;
+
+    return -1;
+}
+
+namespace
+{
+    // Values every parameter starts with, by ParameterId
+    constexpr float defaultParameterValues[] = {
+        0.0f,    // pitchBend
+        0.0f,    // flangerEnabled
+        1.0f,    // flangerRate
+        0.5f,    // flangerDepth
+        1000.0f, // filterCutoff
+        1.0f,    // filterResonance
+        0.0f,    // jogWheelPosition
+        1.0f,    // volume
+        0.0f,    // jogWheelTouched
+        0.0f,    // playing
+        1.0f,    // playbackRate
+        0.0f,    // seekPosition
+        1.0f,    // eqLow
+        1.0f,    // eqMid
+        1.0f     // eqHigh
+    };
+
+    static_assert(std::size(defaultParameterValues) == JUCEAudioProcessor::numParameterIds,
+                  "Every parameter needs a default");
+
+    // Saved state: "JAPS", a version byte and a count byte, then a parameter ID
+    // byte and a little-endian float for each setting. Readers skip IDs they
+    // don't know, so newer states still load into older versions.
+    constexpr int stateMagic = static_cast<int>(juce::ByteOrder::makeInt('J', 'A', 'P', 'S'));
+    constexpr int stateVersion = 1;
+    constexpr int stateHeaderSize = 6;
+    constexpr int stateEntrySize = 5;
+
+    // Input below this (-120 dBFS) counts as silence, and the effect tails
+    // last until they have fallen beneath it
+    constexpr double silenceThreshold = 1.0e-6;
+
+    // The flanger delays by its 7 ms centre delay plus up to 10 ms of
+    // modulation at full depth, and runs without feedback
+    constexpr double flangerCentreDelaySeconds = 0.007;
+    constexpr double flangerModulationSeconds = 0.01;
+
+    // How long a filter runs on the input after being switched to, before it
+    // is faded in, so it has settled by the time it is heard
+    constexpr double filterWarmUpSeconds = 0.01;
+
+    // How long the chain keeps sounding after its input goes silent. The
+    // filter runs at filterRate, and oversampling it delays the output by
+    // oversamplingLatency samples.
+    double getTailSeconds(double sampleRate, JUCEAudioProcessor::PitchShiftQuality quality,
+                          bool flangerEnabled, float flangerDepth, float cutoff, float resonance, double filterRate,
+                          int oversamplingLatency)
+    {
+        double seconds = PitchShifter<float>::getTailSamples(quality, sampleRate) / sampleRate;
+
+        // The isolator's slowest poles are the Butterworth pair at its low
+        // crossover, twice over in the 4th order filters
+        seconds += 2.0 * std::log(1.0 / silenceThreshold)
+                   / (juce::MathConstants<double>::sqrt2 * juce::MathConstants<double>::pi
+                      * IsolatorEQ<float>::getLowCrossoverFrequency(sampleRate));
+
+        if (flangerEnabled)
+            seconds += flangerCentreDelaySeconds + flangerModulationSeconds * juce::jlimit(0.0f, 1.0f, flangerDepth);
+
+        // The filter rings out as exp(-decayRate * t). Underdamped poles decay
+        // at w / (2 * resonance); overdamped, the slower of the two sets it.
+        // Resonance also lifts the ringing above the input level.
+        const double frequency = juce::jlimit(10.0, sampleRate * 0.49, static_cast<double>(cutoff));
+        const double w = 2.0 * filterRate * std::tan(juce::MathConstants<double>::pi * frequency / filterRate);
+        const double q = juce::jmax(0.01, static_cast<double>(resonance));
+        const double damping = 0.5 / q;
+        const double decayRate = damping < 1.0 ? damping * w : w * (damping - std::sqrt(damping * damping - 1.0));
+        seconds += std::log(juce::jmax(1.0, q) / silenceThreshold) / decayRate;
+
+        return seconds + oversamplingLatency / sampleRate;
+    }
+
+    // Vectorised max-abs over every channel, stopping at the first loud one
+    template <typename SampleType>
+    bool isSilent(const juce::AudioBuffer<SampleType>& buffer, int numChannels, int numSamples)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            if (buffer.getMagnitude(channel, 0, numSamples) > static_cast<SampleType>(silenceThreshold))
+                return false;
+
+        return true;
+    }
+
+    bool isStateParameter(int parameter)
+    {
+        for (int id : JUCEAudioProcessor::stateParameterIds)
+            if (id == parameter)
+                return true;
+
+        return false;
+    }
+}
+
+template <typename SampleType>
+JUCEAudioProcessor::EffectChain<SampleType>::EffectChain()
+{
+    // Long enough for the flanger's delay line to fill at full depth
+    flanger().setWarmUpTime(flangerCentreDelaySeconds + flangerModulationSeconds);
+    filterStage().setWarmUpTime(filterWarmUpSeconds);
+
+    auto& chorus = flanger().getProcessor();
+    chorus.setRate(SampleType(1));
+    chorus.setDepth(SampleType(0.5));
+    chorus.setMix(SampleType(0.5));
+    filter().setCutoffFrequency(SampleType(1000));
+    filter().setResonance(SampleType(1));
+}
+
 JUCEAudioProcessor::JUCEAudioProcessor()
     : AudioProcessor(BusesProperties()
         .withInput("Input", juce::AudioChannelSet::stereo(), true)
         .withOutput("Output", juce::AudioChannelSet::stereo(), true))
 {
-    // Initialize effects
-    flanger.setRate(1.0f);
-    flanger.setDepth(0.5f);
-    flanger.setMix(0.5f);
-    filter.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
-    filter.setCutoffFrequency(1000.0f);
-    filter.setResonance(1.0f);
-    
-    // Initialize pitch shifting
-    pitchDelay.setMaximumDelayInSamples(1024);
-    pitchGain.setGainLinear(1.0f);
+    std::copy(std::begin(defaultParameterValues), std::end(defaultParameterValues), controlValues.begin());
+    setPitchShiftQuality(PitchShiftQuality::normal);
 }
 
 JUCEAudioProcessor::~JUCEAudioProcessor() = default;
@@ -52,9 +189,49 @@ bool JUCEAudioProcessor::isMidiEffect() const
     return false;
 }
 
+bool JUCEAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
+{
+    const auto output = layouts.getMainOutputChannelSet();
+    const auto input = layouts.getMainInputChannelSet();
+    const bool isStems = output.isDiscreteLayout() && output.size() % 2 == 0 && output.size() <= maxChannels;
+
+    if (output != juce::AudioChannelSet::mono() && output != juce::AudioChannelSet::stereo() && !isStems)
+        return false;
+
+    return input.isDisabled() || input == output;
+}
+
+bool JUCEAudioProcessor::setNumStems(int numStems)
+{
+    if (numStems < 1 || numStems > maxStems)
+        return false;
+
+    const auto channels = numStems == 1 ? juce::AudioChannelSet::stereo()
+                                        : juce::AudioChannelSet::discreteChannels(2 * numStems);
+    BusesLayout layout;
+    layout.inputBuses.add(channels);
+    layout.outputBuses.add(channels);
+    return setBusesLayout(layout);
+}
+
+int JUCEAudioProcessor::getNumStems() const
+{
+    return juce::jmax(1, getMainBusNumOutputChannels() / 2);
+}
+
 double JUCEAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // For the settings last queued from the control thread
+    const auto parameter = [this](ParameterId id) { return controlValues[static_cast<size_t>(id)]; };
+
+    const double sampleRate = getSampleRate() > 0.0 ? getSampleRate() : 44100.0;
+    const bool oversampled = filterOversampled.load();
+
+    return getTailSeconds(sampleRate, static_cast<PitchShiftQuality>(pitchShiftQuality.load()),
+                          parameter(flangerEnabledId) != 0.0f, parameter(flangerDepthId),
+                          parameter(filterCutoffId), parameter(filterResonanceId),
+                          oversampled ? sampleRate * filterOversamplingFactor : sampleRate,
+                          oversampled ? filterOversamplingLatency : 0);
 }
 
 int JUCEAudioProcessor::getNumPrograms()
@@ -85,26 +262,141 @@ void JUCEAudioProcessor::changeProgramName(int index, const juce::String& newNam
 
 void JUCEAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
-    juce::ignoreUnused(destData);
+    juce::MemoryOutputStream stream(destData, false);
+    stream.writeInt(stateMagic);
+    stream.writeByte(static_cast<char>(stateVersion));
+    stream.writeByte(static_cast<char>(numStateParameters));
+
+    for (int parameter : stateParameterIds) {
+        stream.writeByte(static_cast<char>(parameter));
+        stream.writeFloat(controlValues[static_cast<size_t>(parameter)]);
+    }
 }
 
 void JUCEAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
-    juce::ignoreUnused(data, sizeInBytes);
+    restoreState(data, sizeInBytes);
+}
+
+bool JUCEAudioProcessor::restoreState(const void* data, int sizeInBytes)
+{
+    if (data == nullptr || sizeInBytes < stateHeaderSize)
+        return false;
+
+    juce::MemoryInputStream stream(data, static_cast<size_t>(sizeInBytes), false);
+
+    if (stream.readInt() != stateMagic || stream.readByte() < 1)
+        return false;
+
+    const int numEntries = static_cast<uint8_t>(stream.readByte());
+
+    if (sizeInBytes < stateHeaderSize + numEntries * stateEntrySize)
+        return false;
+
+    // A setting listed twice takes its last value
+    float values[numParameterIds] = {};
+    uint32_t found = 0;
+    static_assert(numParameterIds <= 32, "found is a 32-bit mask");
+
+    for (int i = 0; i < numEntries; ++i) {
+        const int parameter = static_cast<uint8_t>(stream.readByte());
+        const float value = stream.readFloat();
+
+        if (!isStateParameter(parameter))
+            continue;
+
+        if (!std::isfinite(value))
+            return false;
+
+        values[parameter] = value;
+        found |= 1u << parameter;
+    }
+
+    int parameters[numParameterIds];
+    int numChanges = 0;
+
+    for (int parameter = 0; parameter < numParameterIds; ++parameter)
+        if ((found & (1u << parameter)) != 0) {
+            parameters[numChanges] = parameter;
+            values[numChanges++] = values[parameter];
+        }
+
+    setParameters(parameters, values, numChanges);
+    return true;
+}
+
+bool JUCEAudioProcessor::storePreset(int slot)
+{
+    if (!juce::isPositiveAndBelow(slot, numPresetSlots))
+        return false;
+
+    for (int i = 0; i < numStateParameters; ++i)
+        presets[static_cast<size_t>(slot)][static_cast<size_t>(i)] = controlValues[static_cast<size_t>(stateParameterIds[i])];
+
+    storedPresets |= 1u << slot;
+    return true;
+}
+
+bool JUCEAudioProcessor::recallPreset(int slot)
+{
+    if (!hasPreset(slot))
+        return false;
+
+    setParameters(stateParameterIds, presets[static_cast<size_t>(slot)].data(), numStateParameters);
+    return true;
+}
+
+bool JUCEAudioProcessor::hasPreset(int slot) const
+{
+    return juce::isPositiveAndBelow(slot, numPresetSlots) && (storedPresets & (1u << slot)) != 0;
 }
 
 void JUCEAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
+    applyPendingParameters();
+
     juce::dsp::ProcessSpec spec;
     spec.sampleRate = sampleRate;
     spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 2;
+    numPreparedChannels = juce::jmax(1, getMainBusNumOutputChannels());
+    spec.numChannels = static_cast<juce::uint32>(numPreparedChannels);
 
-    flanger.prepare(spec);
-    filter.prepare(spec);
-    volumeGain.prepare(spec);
-    pitchDelay.prepare(spec);
-    pitchGain.prepare(spec);
+    const auto prepareEffects = [&](auto& effects)
+    {
+        effects.pitchShifter().setQuality(static_cast<PitchShiftQuality>(pitchShiftQuality.load()));
+        effects.oversampledFilter().setFactor(filterOversamplingFactor);
+        effects.stages.prepare(spec);
+        filterOversamplingLatency = effects.oversampledFilter().getLatencySamples();
+
+        // Start out in the current mode, without a crossfade
+        effects.filterStage().setSecondSelected(filterOversampled.load());
+        effects.filterStage().reset();
+    };
+
+    // The largest power of two that fits, and at least one smoothing sub-block
+    const auto sampleBytes = static_cast<int>(isUsingDoublePrecision() ? sizeof(double) : sizeof(float));
+    cacheSubBlockSize = juce::jmax(smoothingSubBlockSize,
+                                   juce::nextPowerOfTwo(cacheSubBlockBytes / (sampleBytes * numPreparedChannels) + 1) / 2);
+
+    if (isUsingDoublePrecision())
+        prepareEffects(doubleEffects);
+    else
+        prepareEffects(floatEffects);
+
+    updateLatency();
+
+    if (isUsingDoublePrecision() || numPreparedChannels > 2)
+        meteringBuffer.setSize(2, samplesPerBlock);
+    else
+        meteringBuffer.setSize(0, 0);
+
+    scratchEngine.prepare(sampleRate);
+    outputMeter.prepare(sampleRate, samplesPerBlock);
+    spectrumAnalyser.prepare(sampleRate);
+    performanceMonitor.prepare(sampleRate, samplesPerBlock);
+    resetSmoothers();
+    silentSamples = 0;
+    idle = false;
 }
 
 void JUCEAudioProcessor::releaseResources()
@@ -112,71 +404,465 @@ void JUCEAudioProcessor::releaseResources()
     // Clean up resources if needed
 }
 
+bool JUCEAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
 void JUCEAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
-    juce::ScopedNoDenormals noDenormals;
     juce::ignoreUnused(midiMessages);
+    process(buffer);
+}
+
+void JUCEAudioProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused(midiMessages);
+    process(buffer);
+}
+
+template <typename SampleType>
+void JUCEAudioProcessor::process(juce::AudioBuffer<SampleType>& buffer)
+{
+    juce::ScopedNoDenormals noDenormals;
     
-    // Apply flanger
-    if (flangerEnabled) {
-        juce::dsp::AudioBlock<float> block(buffer);
-        juce::dsp::ProcessContextReplacing<float> context(block);
-        flanger.process(context);
+    // The other chain isn't prepared - call setProcessingPrecision() before prepareToPlay()
+    if (isUsingDoublePrecision() != std::is_same_v<SampleType, double>) {
+        jassertfalse;
+        buffer.clear();
+        return;
     }
     
-    // Apply filter
-    juce::dsp::AudioBlock<float> block(buffer);
-    juce::dsp::ProcessContextReplacing<float> context(block);
-    filter.process(context);
+    auto& effects = getEffects<SampleType>();
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = juce::jmin(buffer.getNumChannels(), numPreparedChannels);
+    PerformanceMonitor::ScopedBlockTimer timer(performanceMonitor, numSamples);
+    
+    // Outputs without an input start out silent
+    for (int channel = getTotalNumInputChannels(); channel < numChannels; ++channel)
+        buffer.clear(channel, 0, numSamples);
+    
+    applyPendingParameters();
     
-    // Apply volume
-    volumeGain.process(context);
+    const auto quality = static_cast<PitchShiftQuality>(pitchShiftQuality.load(std::memory_order_relaxed));
+    
+    if (quality != effects.pitchShifter().getQuality())
+        effects.pitchShifter().setQuality(quality);
+
+    // A change of filter mode crossfades between the two filters
+    effects.filterStage().setSecondSelected(filterOversampled.load(std::memory_order_relaxed));
+    
+    timer.finishStage(PerformanceMonitor::parametersStage);
+    scratchEngine.process(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+    timer.finishStage(PerformanceMonitor::scratchStage);
+
+    // Silence in with nothing left ringing can only give silence out, so the
+    // ramps just move on and the meters decay without running any stage
+    if (updateIdleState(buffer, numChannels, numSamples)) {
+        updateSmoothedParameters(effects, numSamples);
+        timer.finishStage(PerformanceMonitor::parametersStage);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            buffer.clear(channel, 0, numSamples);
+
+        outputMeter.processSilence(numSamples);
+        spectrumAnalyser.pushSilence(numSamples);
+        timer.finishStage(PerformanceMonitor::meteringStage);
+        timer.setIdle();
+        return;
+    }
+
+    auto block = juce::dsp::AudioBlock<SampleType>(buffer).getSubsetChannelBlock(0, static_cast<size_t>(numChannels));
+    
+    // Each sub-block goes through every stage before the next one starts.
+    // While a parameter ramps they are short, so coefficients are only
+    // recomputed once per sub-block; otherwise as long as fits in L1.
+    const int stepSize = isSmoothing() ? smoothingSubBlockSize : cacheSubBlockSize;
+    
+    for (int start = 0; start < numSamples; start += stepSize) {
+        const int length = juce::jmin(stepSize, numSamples - start);
+        auto subBlock = block.getSubBlock(static_cast<size_t>(start), static_cast<size_t>(length));
+        juce::dsp::ProcessContextReplacing<SampleType> context(subBlock);
+        
+        const auto startVolume = static_cast<SampleType>(smoothedVolume.getCurrentValue());
+        updateSmoothedParameters(effects, length);
+        const auto endVolume = static_cast<SampleType>(smoothedVolume.getCurrentValue());
+        timer.finishStage(PerformanceMonitor::parametersStage);
+        
+        // Apply pitch shift
+        effects.pitchShifter().process(context);
+        timer.finishStage(PerformanceMonitor::pitchShiftStage);
+
+        // Apply isolator EQ
+        effects.isolator().process(context);
+        timer.finishStage(PerformanceMonitor::eqStage);
+        
+        // Apply flanger, while it is on or fading out
+        if (effects.flanger().isActive()) {
+            effects.flanger().process(context);
+            timer.finishStage(PerformanceMonitor::flangerStage);
+        }
+        
+        // Apply filter
+        effects.filterStage().process(context);
+
+        timer.finishStage(PerformanceMonitor::filterStage);
+        
+        // Apply volume
+        for (int channel = 0; channel < numChannels; ++channel) {
+            if (startVolume != endVolume)
+                buffer.applyGainRamp(channel, start, length, startVolume, endVolume);
+            else if (endVolume != SampleType(1))
+                buffer.applyGain(channel, start, length, endVolume);
+        }
+        
+        timer.finishStage(PerformanceMonitor::volumeStage);
+    }
+
+    measureOutput(buffer, numChannels, numSamples);
+    timer.finishStage(PerformanceMonitor::meteringStage);
+}
+
+template <typename SampleType>
+bool JUCEAudioProcessor::updateIdleState(const juce::AudioBuffer<SampleType>& buffer, int numChannels, int numSamples)
+{
+    if (!isSilent(buffer, numChannels, numSamples)) {
+        silentSamples = 0;
+        idle = false;
+        return false;
+    }
+
+    // The tail is counted from the last sound, before this block
+    const double sampleRate = getSampleRate();
+    const auto quality = static_cast<PitchShiftQuality>(pitchShiftQuality.load(std::memory_order_relaxed));
+    auto& effects = getEffects<SampleType>();
+    const bool oversampled = effects.filterStage().isSecondSelected() || effects.filterStage().isSwitching();
+    const double tailSamples = getTailSeconds(sampleRate, quality, effects.flanger().isActive(),
+                                              flangerDepth, filterCutoff, filterResonance,
+                                              oversampled ? sampleRate * filterOversamplingFactor : sampleRate,
+                                              oversampled ? filterOversamplingLatency : 0) * sampleRate;
+
+    idle = silentSamples >= tailSamples;
+    silentSamples = juce::jmin(silentSamples, std::numeric_limits<int>::max() - numSamples) + numSamples;
+    return idle;
+}
+
+template <typename SampleType>
+void JUCEAudioProcessor::measureOutput(const juce::AudioBuffer<SampleType>& buffer, int numChannels, int numSamples)
+{
+    if constexpr (std::is_same_v<SampleType, float>) {
+        if (numChannels <= 2) {
+            outputMeter.process(buffer.getArrayOfReadPointers(), numChannels, numSamples);
+            spectrumAnalyser.push(buffer.getArrayOfReadPointers(), numChannels, numSamples);
+            return;
+        }
+    }
+    
+    // Everything else is metered as a float stereo mix: left stem channels
+    // summed into the left channel, right into the right
+    const int numMixChannels = juce::jmin(2, numChannels);
+    jassert(meteringBuffer.getNumSamples() >= numSamples);
+    
+    for (int channel = 0; channel < numMixChannels; ++channel) {
+        auto* mix = meteringBuffer.getWritePointer(channel);
+        
+        for (int source = channel; source < numChannels; source += 2) {
+            const auto* samples = buffer.getReadPointer(source);
+            
+            if constexpr (std::is_same_v<SampleType, float>) {
+                if (source == channel)
+                    juce::FloatVectorOperations::copy(mix, samples, numSamples);
+                else
+                    juce::FloatVectorOperations::add(mix, samples, numSamples);
+            } else if (source == channel) {
+                for (int i = 0; i < numSamples; ++i)
+                    mix[i] = static_cast<float>(samples[i]);
+            } else {
+                for (int i = 0; i < numSamples; ++i)
+                    mix[i] += static_cast<float>(samples[i]);
+            }
+        }
+    }
+    
+    outputMeter.process(meteringBuffer.getArrayOfReadPointers(), numMixChannels, numSamples);
+    spectrumAnalyser.push(meteringBuffer.getArrayOfReadPointers(), numMixChannels, numSamples);
+}
+
+void JUCEAudioProcessor::setSmoothingTime(float seconds)
+{
+    smoothingSeconds.store(juce::jmax(0.0f, seconds));
+}
+
+void JUCEAudioProcessor::setPitchShiftQuality(PitchShiftQuality quality)
+{
+    pitchShiftQuality.store(static_cast<int>(quality));
+    updateLatency();
+}
+
+bool JUCEAudioProcessor::setFilterOversamplingFactor(int factor)
+{
+    if (!OversampledStage<float, MultichannelFilter<float>>::isValidFactor(factor))
+        return false;
+
+    filterOversamplingFactor = factor;
+    return true;
+}
+
+int JUCEAudioProcessor::getFilterOversamplingFactor() const
+{
+    return filterOversamplingFactor;
+}
+
+void JUCEAudioProcessor::setFilterOversampled(bool shouldOversample)
+{
+    filterOversampled.store(shouldOversample);
+    updateLatency();
+}
+
+bool JUCEAudioProcessor::isFilterOversampled() const
+{
+    return filterOversampled.load();
+}
+
+void JUCEAudioProcessor::updateLatency()
+{
+    const auto quality = static_cast<PitchShiftQuality>(pitchShiftQuality.load());
+    setLatencySamples(PitchShifter<float>::getLatencySamples(quality, getSampleRate() > 0.0 ? getSampleRate() : 44100.0)
+                      + (filterOversampled.load() ? filterOversamplingLatency : 0));
+}
+
+void JUCEAudioProcessor::resetSmoothers()
+{
+    const double sampleRate = getSampleRate() > 0.0 ? getSampleRate() : 44100.0;
+    appliedSmoothingSeconds = smoothingSeconds.load();
+
+    smoothedPitch.reset(sampleRate, appliedSmoothingSeconds);
+    smoothedFlangerRate.reset(sampleRate, appliedSmoothingSeconds);
+    smoothedFlangerDepth.reset(sampleRate, appliedSmoothingSeconds);
+    smoothedCutoff.reset(sampleRate, appliedSmoothingSeconds);
+    smoothedResonance.reset(sampleRate, appliedSmoothingSeconds);
+    smoothedVolume.reset(sampleRate, appliedSmoothingSeconds);
+    smoothedEqLow.reset(sampleRate, appliedSmoothingSeconds);
+    smoothedEqMid.reset(sampleRate, appliedSmoothingSeconds);
+    smoothedEqHigh.reset(sampleRate, appliedSmoothingSeconds);
+    effectsNeedUpdate = true;
+}
+
+bool JUCEAudioProcessor::isSmoothing() const
+{
+    return smoothedPitch.isSmoothing() || smoothedFlangerRate.isSmoothing() || smoothedFlangerDepth.isSmoothing()
+        || smoothedCutoff.isSmoothing() || smoothedResonance.isSmoothing()
+        || smoothedVolume.isSmoothing() || smoothedEqLow.isSmoothing() || smoothedEqMid.isSmoothing()
+        || smoothedEqHigh.isSmoothing();
+}
+
+template <typename SampleType>
+void JUCEAudioProcessor::updateSmoothedParameters(EffectChain<SampleType>& effects, int numSamples)
+{
+    if (!effectsNeedUpdate && !isSmoothing())
+        return;
+
+    currentPitch = smoothedPitch.skip(numSamples);
+    flangerRate = smoothedFlangerRate.skip(numSamples);
+    flangerDepth = smoothedFlangerDepth.skip(numSamples);
+    filterCutoff = smoothedCutoff.skip(numSamples);
+    filterResonance = smoothedResonance.skip(numSamples);
+    currentVolume = smoothedVolume.skip(numSamples);
+    eqLow = smoothedEqLow.skip(numSamples);
+    eqMid = smoothedEqMid.skip(numSamples);
+    eqHigh = smoothedEqHigh.skip(numSamples);
+
+    effects.pitchShifter().setPitchRatio(static_cast<SampleType>(std::pow(2.0f, currentPitch / 12.0f)));
+    using Isolator = IsolatorEQ<SampleType>;
+    effects.isolator().setGain(Isolator::lowBand, static_cast<SampleType>(eqLow));
+    effects.isolator().setGain(Isolator::midBand, static_cast<SampleType>(eqMid));
+    effects.isolator().setGain(Isolator::highBand, static_cast<SampleType>(eqHigh));
+    effects.flanger().setEnabled(flangerEnabled);
+    effects.flanger().getProcessor().setRate(static_cast<SampleType>(flangerRate));
+    effects.flanger().getProcessor().setDepth(static_cast<SampleType>(flangerDepth));
+    // Both filters follow the settings, so switching between them is seamless
+    const auto cutoff = static_cast<SampleType>(juce::jmin(filterCutoff, static_cast<float>(getSampleRate() * 0.49)));
+    effects.filter().setCutoffFrequency(cutoff);
+    effects.filter().setResonance(static_cast<SampleType>(filterResonance));
+    effects.oversampledFilter().getProcessor().setCutoffFrequency(cutoff);
+    effects.oversampledFilter().getProcessor().setResonance(static_cast<SampleType>(filterResonance));
+
+    effectsNeedUpdate = isSmoothing();
+}
+
+void JUCEAudioProcessor::setParameter(ParameterId parameter, float value)
+{
+    controlValues[static_cast<size_t>(parameter)] = value;
+    parameterQueue.push(parameter, value);
+}
+
+void JUCEAudioProcessor::setParameters(const int* parameters, const float* values, int numChanges)
+{
+    for (int i = 0; i < numChanges; ++i)
+        controlValues[static_cast<size_t>(parameters[i])] = values[i];
+
+    parameterQueue.pushBatch(parameters, values, numChanges);
 }
 
 void JUCEAudioProcessor::setPitchBend(float semitones)
 {
-    currentPitch = semitones;
-    float pitchRatio = std::pow(2.0f, semitones / 12.0f);
-    pitchGain.setGainLinear(pitchRatio);
+    setParameter(pitchBendId, semitones);
 }
 
 void JUCEAudioProcessor::setFlangerEnabled(bool enabled)
 {
-    flangerEnabled = enabled;
+    setParameter(flangerEnabledId, enabled ? 1.0f : 0.0f);
 }
 
 void JUCEAudioProcessor::setFlangerRate(float rate)
 {
-    flangerRate = rate;
-    flanger.setRate(rate);
+    setParameter(flangerRateId, rate);
 }
 
 void JUCEAudioProcessor::setFlangerDepth(float depth)
 {
-    flangerDepth = depth;
-    flanger.setDepth(depth);
+    setParameter(flangerDepthId, depth);
 }
 
 void JUCEAudioProcessor::setFilterCutoff(float cutoff)
 {
-    filterCutoff = cutoff;
-    filter.setCutoffFrequency(cutoff);
+    setParameter(filterCutoffId, cutoff);
 }
 
 void JUCEAudioProcessor::setFilterResonance(float resonance)
 {
-    filterResonance = resonance;
-    filter.setResonance(resonance);
+    setParameter(filterResonanceId, resonance);
 }
 
-void JUCEAudioProcessor::setJogWheelPosition(float position)
+void JUCEAudioProcessor::setJogWheelPosition(float revolutions)
 {
-    jogWheelPosition = position;
-    // Implement jog wheel logic here
+    setParameter(jogWheelPositionId, revolutions);
 }
 
 void JUCEAudioProcessor::setVolume(float volume)
 {
-    currentVolume = volume;
-    volumeGain.setGainLinear(volume);
-}
\ No newline at end of file
+    setParameter(volumeId, volume);
+}
+
+void JUCEAudioProcessor::setEqLow(float gain)
+{
+    setParameter(eqLowId, gain);
+}
+
+void JUCEAudioProcessor::setEqMid(float gain)
+{
+    setParameter(eqMidId, gain);
+}
+
+void JUCEAudioProcessor::setEqHigh(float gain)
+{
+    setParameter(eqHighId, gain);
+}
+
+void JUCEAudioProcessor::setJogWheelTouched(bool touched)
+{
+    setParameter(jogWheelTouchedId, touched ? 1.0f : 0.0f);
+}
+
+void JUCEAudioProcessor::setPlaying(bool shouldPlay)
+{
+    setParameter(playingId, shouldPlay ? 1.0f : 0.0f);
+}
+
+void JUCEAudioProcessor::setPlaybackRate(float rate)
+{
+    setParameter(playbackRateId, rate);
+}
+
+void JUCEAudioProcessor::seek(float seconds)
+{
+    setParameter(seekPositionId, seconds);
+}
+
+void JUCEAudioProcessor::loadTrack(juce::AudioBuffer<float>&& samples, double trackSampleRate)
+{
+    scratchEngine.loadTrack(std::move(samples), trackSampleRate);
+}
+
+void JUCEAudioProcessor::unloadTrack()
+{
+    scratchEngine.unloadTrack();
+}
+
+double JUCEAudioProcessor::getPlayPositionSeconds() const
+{
+    return scratchEngine.getPositionSeconds();
+}
+
+double JUCEAudioProcessor::getTrackLengthSeconds() const
+{
+    return scratchEngine.getTrackLengthSeconds();
+}
+
+void JUCEAudioProcessor::applyPendingParameters()
+{
+    if (smoothingSeconds.load(std::memory_order_relaxed) != appliedSmoothingSeconds)
+        resetSmoothers();
+
+    // Before the drain, so play/seek queued right after loading a track apply to it
+    scratchEngine.handleTrackChange();
+    parameterQueue.drain([this](int parameter, float value) { applyParameter(parameter, value); });
+}
+
+void JUCEAudioProcessor::applyParameter(int parameter, float value)
+{
+    switch (parameter) {
+        case pitchBendId:
+            smoothedPitch.setTargetValue(juce::jlimit(-24.0f, 24.0f, value));
+            break;
+        case flangerEnabledId:
+            flangerEnabled = value != 0.0f;
+            break;
+        case flangerRateId:
+            smoothedFlangerRate.setTargetValue(juce::jmax(0.0f, value));
+            break;
+        case flangerDepthId:
+            smoothedFlangerDepth.setTargetValue(juce::jlimit(0.0f, 1.0f, value));
+            break;
+        case filterCutoffId:
+            // The multiplicative ramp and the filter both need a positive cutoff
+            smoothedCutoff.setTargetValue(juce::jmax(10.0f, value));
+            break;
+        case filterResonanceId:
+            smoothedResonance.setTargetValue(juce::jmax(0.01f, value));
+            break;
+        case jogWheelPositionId:
+            scratchEngine.setJogPosition(value);
+            break;
+        case volumeId:
+            smoothedVolume.setTargetValue(juce::jmax(0.0f, value));
+            break;
+        case jogWheelTouchedId:
+            scratchEngine.setTouched(value != 0.0f);
+            break;
+        case playingId:
+            scratchEngine.setPlaying(value != 0.0f);
+            break;
+        case playbackRateId:
+            scratchEngine.setPlaybackRate(value);
+            break;
+        case seekPositionId:
+            scratchEngine.seek(value);
+            break;
+        case eqLowId:
+            smoothedEqLow.setTargetValue(juce::jlimit(0.0f, 2.0f, value));
+            break;
+        case eqMidId:
+            smoothedEqMid.setTargetValue(juce::jlimit(0.0f, 2.0f, value));
+            break;
+        case eqHighId:
+            smoothedEqHigh.setTargetValue(juce::jlimit(0.0f, 2.0f, value));
+            break;
+        default:
+            jassertfalse;
+            break;
+    }
+
+    // Without a ramp the new value has to reach the effects straight away
+    effectsNeedUpdate = true;
+}
@@ -12,11 +12,58 @@
 #include <juce_dsp/juce_dsp.h>
 #include <juce_analytics/juce_analytics.h>
 
-#include <napi.h>
+#include "bypass_crossfade.h"
+#include "crossfade_switch.h"
+#include "isolator_eq.h"
+#include "level_meter.h"
+#include "multichannel_filter.h"
+#include "oversampled_stage.h"
+#include "parameter_queue.h"
+#include "performance_monitor.h"
+#include "pitch_shifter.h"
+#include "scratch_engine.h"
+#include "spectrum_analyser.h"
 
 class JUCEAudioProcessor : public juce::AudioProcessor
 {
 public:
+    // Every parameter that can change while audio is running
+    enum ParameterId
+    {
+        pitchBendId,
+        flangerEnabledId,
+        flangerRateId,
+        flangerDepthId,
+        filterCutoffId,
+        filterResonanceId,
+        jogWheelPositionId,
+        volumeId,
+        jogWheelTouchedId,
+        playingId,
+        playbackRateId,
+        seekPositionId,
+        eqLowId,
+        eqMidId,
+        eqHighId,
+        numParameterIds
+    };
+
+    // Parameter names as used from JS, e.g. "filterCutoff" - returns -1 for unknown names
+    static const char* getParameterIdName(int parameter);
+    static int getParameterIdForName(juce::StringRef name);
+
+    // The effect settings, which getStateInformation() saves and presets hold
+    static constexpr int stateParameterIds[] = {
+        pitchBendId, flangerEnabledId, flangerRateId, flangerDepthId, filterCutoffId, filterResonanceId, volumeId,
+        eqLowId, eqMidId, eqHighId
+    };
+    static constexpr int numStateParameters = static_cast<int>(std::size(stateParameterIds));
+    static constexpr int numPresetSlots = 16;
+
+    // Stem mode runs up to this many stereo stems side by side
+    static constexpr int maxStems = 8;
+    static constexpr int maxChannels = 2 * maxStems;
+
     JUCEAudioProcessor();
     ~JUCEAudioProcessor() override;
 
@@ -38,34 +85,237 @@ public:
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
 
+    // Mono, stereo, or stereo stems side by side as discrete channels. The
+    // input, when enabled, must match the output.
+    bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
+
     // AudioProcessorGraph overrides
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
     void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) override;
 
-    // Custom methods for DJ effects
+    // The whole chain can also run in double precision, for offline renders.
+    // Pick the precision with setProcessingPrecision() before prepareToPlay();
+    // the meters still read a float copy of the output.
+    bool supportsDoublePrecisionProcessing() const override;
+    void processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages) override;
+
+    // Custom methods for DJ effects. These can be called from any single control
+    // thread; the changes are queued and picked up at the start of the next block.
+    void setParameter(ParameterId parameter, float value);
+
+    // Queues several changes that take effect together, in the same block
+    void setParameters(const int* parameters, const float* values, int numChanges);
     void setPitchBend(float semitones);
     void setFlangerEnabled(bool enabled);
     void setFlangerRate(float rate);
     void setFlangerDepth(float depth);
     void setFilterCutoff(float cutoff);
     void setFilterResonance(float resonance);
-    void setJogWheelPosition(float position);
+    void setJogWheelPosition(float revolutions);
     void setVolume(float volume);
+    void setJogWheelTouched(bool touched);
+    void setPlaying(bool shouldPlay);
+    void setPlaybackRate(float rate);
+    void seek(float seconds);
+
+    // Isolator EQ band gains: 0 kills the band, 1 leaves it as it is, up to 2
+    // (+6 dB). At 1 the bands add back up to an allpass, not to the input.
+    void setEqLow(float gain);
+    void setEqMid(float gain);
+    void setEqHigh(float gain);
+
+    // Deck playback. While a track is loaded it replaces the input and the jog
+    // wheel scratches it; without one the input is processed as before.
+    void loadTrack(juce::AudioBuffer<float>&& samples, double trackSampleRate);
+    void unloadTrack();
+    double getPlayPositionSeconds() const;
+    double getTrackLengthSeconds() const;
+
+    // setStateInformation(), returning false if data isn't a saved state. The
+    // state is checked in full before any of it is applied.
+    bool restoreState(const void* data, int sizeInBytes);
+
+    // Preset bank, control thread only. storePreset() copies the current effect
+    // settings into a slot; recallPreset() queues all of them as one batch, so
+    // the audio thread switches the whole setup at once without parsing or
+    // allocating. Both return false for a slot out of range, recall also for
+    // an empty one.
+    bool storePreset(int slot);
+    bool recallPreset(int slot);
+    bool hasPreset(int slot) const;
+
+    // Levels of the processed output, measured at the end of every block
+    LevelMeter& getOutputMeter() { return outputMeter; }
+
+    // Spectrum of the processed output, analysed off the audio thread once enabled
+    SpectrumAnalyser& getSpectrumAnalyser() { return spectrumAnalyser; }
+
+    // Load, deadline misses and timing histograms of processBlock
+    PerformanceMonitor& getPerformanceMonitor() { return performanceMonitor; }
+
+    // Stem mode: 2 * numStems channels, taken as stereo stems that each run
+    // through their own effect state with the same settings, and are metered
+    // as one stereo mix. 1 is plain stereo. Control thread, while not
+    // processing; takes effect from the next prepareToPlay(). Returns false
+    // for a count out of range.
+    bool setNumStems(int numStems);
+    int getNumStems() const;
+
+    // True once the input has been silent for longer than the effects ring on,
+    // from then on blocks skip every stage and come out as digital silence.
+    // Audio thread - other threads can count idle blocks in the performance stats.
+    bool isIdle() const noexcept { return idle; }
+
+    // Time over which continuous parameters ramp to a new value (0 jumps instantly)
+    void setSmoothingTime(float seconds);
+
+    // Quality/CPU tradeoff of the pitch shifter. Also updates the reported
+    // latency, so call it from the control thread.
+    using PitchShiftQuality = PitchShifter<float>::Quality;
+    void setPitchShiftQuality(PitchShiftQuality quality);
+
+    // Oversampled filter mode, against aliasing and warping with high
+    // resonance near Nyquist. The factor, 2 or 4, is per instance: control
+    // thread, while not processing, and takes effect from the next
+    // prepareToPlay(). Returns false for any other factor.
+    bool setFilterOversamplingFactor(int factor);
+    int getFilterOversamplingFactor() const;
+
+    // Switches the mode at any time from the control thread, and reports the
+    // added latency. Only costs CPU while on.
+    void setFilterOversampled(bool shouldOversample);
+    bool isFilterOversampled() const;
+
+    // Filter and flanger coefficients are only recomputed once per this many
+    // samples while a parameter is ramping
+    static constexpr int smoothingSubBlockSize = 32;
+
+    // Otherwise every stage runs over sub-blocks sized so that all channels of
+    // one fit in this many bytes, which keeps the data in L1 from one stage to
+    // the next instead of streaming the whole buffer through memory per stage
+    static constexpr int cacheSubBlockBytes = 16384;
+    static constexpr float defaultSmoothingSeconds = 0.05f;
 
 private:
+    // The effects that run at the processing precision, in processing order.
+    // Only the chain for the precision prepareToPlay() was last called with is
+    // prepared. The isolator always runs, as at unity gain it still shifts the
+    // phase and a dry path would not line up with it. The flanger fades in and
+    // out when it is switched. The filter runs in one of two ways, at the
+    // sample rate or oversampled, and crossfades from one to the other when
+    // the mode changes.
+    template <typename SampleType>
+    struct EffectChain
+    {
+        enum { pitchShifterIndex, isolatorIndex, flangerIndex, filterIndex };
+
+        using FilterStage = CrossfadeSwitch<SampleType, MultichannelFilter<SampleType>,
+                                            OversampledStage<SampleType, MultichannelFilter<SampleType>>>;
+
+        EffectChain();
+
+        PitchShifter<SampleType>& pitchShifter() noexcept { return stages.template get<pitchShifterIndex>(); }
+        IsolatorEQ<SampleType>& isolator() noexcept { return stages.template get<isolatorIndex>(); }
+        BypassCrossfade<SampleType, juce::dsp::Chorus<SampleType>>& flanger() noexcept { return stages.template get<flangerIndex>(); }
+        FilterStage& filterStage() noexcept { return stages.template get<filterIndex>(); }
+        MultichannelFilter<SampleType>& filter() noexcept { return filterStage().getFirst(); }
+        OversampledStage<SampleType, MultichannelFilter<SampleType>>& oversampledFilter() noexcept { return filterStage().getSecond(); }
+
+        juce::dsp::ProcessorChain<PitchShifter<SampleType>,
+                                  IsolatorEQ<SampleType>,
+                                  BypassCrossfade<SampleType, juce::dsp::Chorus<SampleType>>,
+                                  FilterStage> stages;
+    };
+
+    template <typename SampleType>
+    EffectChain<SampleType>& getEffects()
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleEffects;
+        else
+            return floatEffects;
+    }
+
+    template <typename SampleType>
+    void process(juce::AudioBuffer<SampleType>& buffer);
+
+    // Feeds the output to the level meter and spectrum analyser
+    template <typename SampleType>
+    void measureOutput(const juce::AudioBuffer<SampleType>& buffer, int numChannels, int numSamples);
+
+    // Tracks how long the input has been silent and returns true when the
+    // block can be skipped
+    template <typename SampleType>
+    bool updateIdleState(const juce::AudioBuffer<SampleType>& buffer, int numChannels, int numSamples);
+
+    // Applies a queued parameter change - audio thread only
+    void applyParameter(int parameter, float value);
+    void applyPendingParameters();
+
+    // Restarts every ramp with the current sample rate and smoothing time
+    void resetSmoothers();
+    bool isSmoothing() const;
+
+    // Advances the ramps by numSamples and pushes the new values into the effects
+    template <typename SampleType>
+    void updateSmoothedParameters(EffectChain<SampleType>& effects, int numSamples);
+
+    ParameterQueue<numParameterIds> parameterQueue;
+
+    // Latest value queued for each parameter, as seen from the control thread
+    std::array<float, numParameterIds> controlValues;
+
+    std::array<std::array<float, numStateParameters>, numPresetSlots> presets {};
+    uint32_t storedPresets = 0;
+    static_assert(numPresetSlots <= 32, "storedPresets is a 32-bit mask");
+
     // Audio effects - using proper JUCE classes
-    juce::dsp::Chorus<float> flanger;
-    juce::dsp::StateVariableTPTFilter<float> filter;
-    juce::dsp::Gain<float> volumeGain;
-    
-    // Simple pitch shifting using gain and delay
-    juce::dsp::DelayLine<float> pitchDelay;
-    juce::dsp::Gain<float> pitchGain;
-    
-    // Jog wheel state
-    float jogWheelPosition = 0.0f;
-    float jogWheelVelocity = 0.0f;
+    ScratchEngine scratchEngine;
+    EffectChain<float> floatEffects;
+    EffectChain<double> doubleEffects;
+    LevelMeter outputMeter;
+    SpectrumAnalyser spectrumAnalyser;
+    PerformanceMonitor performanceMonitor;
+
+    // Samples since the input was last above the silence threshold
+    int silentSamples = 0;
+    bool idle = false;
+
+    // Channels the effect state is sized for, from the bus layout
+    int numPreparedChannels = 2;
+
+    // Samples per sub-block when no parameter is ramping, from cacheSubBlockBytes
+    int cacheSubBlockSize = 512;
+
+    // Float stereo mix of stems or double precision output for the meters,
+    // sized in prepareToPlay()
+    juce::AudioBuffer<float> meteringBuffer;
+
+    // Ramps for continuous parameters. Cutoff ramps exponentially so sweeps
+    // sound even across the whole frequency range.
+    juce::SmoothedValue<float> smoothedPitch { 0.0f };
+    juce::SmoothedValue<float> smoothedFlangerRate { 1.0f };
+    juce::SmoothedValue<float> smoothedFlangerDepth { 0.5f };
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> smoothedCutoff { 1000.0f };
+    juce::SmoothedValue<float> smoothedResonance { 1.0f };
+    juce::SmoothedValue<float> smoothedVolume { 1.0f };
+    juce::SmoothedValue<float> smoothedEqLow { 1.0f };
+    juce::SmoothedValue<float> smoothedEqMid { 1.0f };
+    juce::SmoothedValue<float> smoothedEqHigh { 1.0f };
+    bool effectsNeedUpdate = true;
+
+    std::atomic<float> smoothingSeconds { defaultSmoothingSeconds };
+    float appliedSmoothingSeconds = defaultSmoothingSeconds;
+
+    std::atomic<int> pitchShiftQuality { static_cast<int>(PitchShiftQuality::normal) };
+
+    // Pitch shifter latency plus the filter oversampling while it is on
+    void updateLatency();
+
+    int filterOversamplingFactor = 2;
+    int filterOversamplingLatency = 0;
+    std::atomic<bool> filterOversampled { false };
     
     // Effect parameters
     bool flangerEnabled = false;
@@ -75,4 +325,7 @@ private:
     float filterResonance = 1.0f;
     float currentPitch = 0.0f;
     float currentVolume = 1.0f;
+    float eqLow = 1.0f;
+    float eqMid = 1.0f;
+    float eqHigh = 1.0f;
 };
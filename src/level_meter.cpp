@@ -0,0 +1,370 @@
+#include "level_meter.h"
+
+#include <juce_dsp/juce_dsp.h>
+
+#include <thread>
+
+namespace
+{
+    using Vector = juce::dsp::SIMDRegister<float>;
+
+    constexpr double rmsSeconds = 0.3;
+    constexpr double peakFallDecibelsPerSecond = 20.0;
+    constexpr double loudnessStepSeconds = 0.1;
+
+    // Blocks below this are never counted towards integrated loudness, and the
+    // relative gate drops blocks this far below the ungated average
+    constexpr float absoluteGate = -70.0f;
+    constexpr float relativeGate = -10.0f;
+
+    // Sum of a[i] * b[i]. Where a and b share an alignment it runs on SIMD
+    // registers, with scalar loops for the ends.
+    double sumOfProducts(const float* a, const float* b, int numSamples) noexcept
+    {
+        double sum = 0.0;
+        int i = 0;
+
+        for (; i < numSamples && !Vector::isSIMDAligned(a + i); ++i)
+            sum += static_cast<double>(a[i]) * b[i];
+
+        if (Vector::isSIMDAligned(b + i)) {
+            constexpr int width = static_cast<int>(Vector::size());
+            auto accumulator = Vector::expand(0.0f);
+
+            for (; i + width <= numSamples; i += width)
+                accumulator += Vector::fromRawArray(a + i) * Vector::fromRawArray(b + i);
+
+            sum += accumulator.sum();
+        }
+
+        for (; i < numSamples; ++i)
+            sum += static_cast<double>(a[i]) * b[i];
+
+        return sum;
+    }
+
+    float getPeak(const float* samples, int numSamples) noexcept
+    {
+        const auto range = juce::FloatVectorOperations::findMinAndMax(samples, numSamples);
+        return juce::jmax(0.0f, -range.getStart(), range.getEnd());
+    }
+
+    float toLoudness(double meanSquare) noexcept
+    {
+        return meanSquare > 0.0 ? static_cast<float>(-0.691 + 10.0 * std::log10(meanSquare)) : -INFINITY;
+    }
+}
+
+const char* LevelMeter::getSharedFieldName(int field)
+{
+    static const char* const names[] = {
+        "sequence",
+        "peakLeft",
+        "peakRight",
+        "rmsLeft",
+        "rmsRight",
+        "momentaryLoudness",
+        "shortTermLoudness",
+        "integratedLoudness",
+        "correlation"
+    };
+
+    static_assert(std::size(names) == numSharedFields, "Every shared field needs a name");
+
+    return juce::isPositiveAndBelow(field, numSharedFields) ? names[field] : nullptr;
+}
+
+void LevelMeter::Biquad::setCoefficients(double newB0, double newB1, double newB2, double newA1, double newA2) noexcept
+{
+    b0 = newB0;
+    b1 = newB1;
+    b2 = newB2;
+    a1 = newA1;
+    a2 = newA2;
+}
+
+LevelMeter::LevelMeter()
+{
+    prepare(44100.0, 512);
+}
+
+void LevelMeter::prepare(double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+    weighted.assign(static_cast<size_t>(juce::jmax(1, maximumBlockSize)), 0.0f);
+
+    // K-weighting for any sample rate: a high shelf modelling the head,
+    // then the revised low-frequency B-curve high-pass (BS.1770-4)
+    {
+        const double k = std::tan(juce::MathConstants<double>::pi * 1681.974450955533 / sampleRate);
+        const double q = 0.7071752369554196;
+        const double vh = std::pow(10.0, 3.999843853973347 / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+
+        for (auto& filter : shelf)
+            filter.setCoefficients((vh + vb * k / q + k * k) / a0, 2.0 * (k * k - vh) / a0,
+                                   (vh - vb * k / q + k * k) / a0, 2.0 * (k * k - 1.0) / a0,
+                                   (1.0 - k / q + k * k) / a0);
+    }
+
+    {
+        const double k = std::tan(juce::MathConstants<double>::pi * 38.13547087602444 / sampleRate);
+        const double q = 0.5003270373238773;
+        const double a0 = 1.0 + k / q + k * k;
+
+        for (auto& filter : highPass)
+            filter.setCoefficients(1.0, -2.0, 1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0);
+    }
+
+    for (int channel = 0; channel < 2; ++channel) {
+        shelf[channel].reset();
+        highPass[channel].reset();
+        peaks[channel] = 0.0f;
+        meanSquares[channel] = 0.0;
+    }
+
+    meanProduct = 0.0;
+    samplesPerStep = juce::jmax(1, juce::roundToInt(sampleRate * loudnessStepSeconds));
+    samplesInStep = 0;
+    stepEnergy = 0.0;
+    stepEnergies.fill(0.0);
+    numSteps = 0;
+    momentaryLoudness = -INFINITY;
+    shortTermLoudness = -INFINITY;
+    resetRequested.store(true);
+}
+
+void LevelMeter::process(const float* const* channels, int numChannels, int numSamples) noexcept
+{
+    if (numChannels <= 0 || numSamples <= 0)
+        return;
+
+    applyPendingReset();
+
+    const float* left = channels[0];
+    const float* right = numChannels > 1 ? channels[1] : channels[0];
+    const float* inputs[] = { left, right };
+
+    // Instant attack, then an exponential fall of a fixed number of dB per second
+    const float fall = static_cast<float>(std::pow(10.0, -peakFallDecibelsPerSecond / 20.0 * numSamples / sampleRate));
+    const double smoothing = std::exp(-numSamples / (rmsSeconds * sampleRate));
+
+    for (int channel = 0; channel < 2; ++channel) {
+        peaks[channel] = juce::jmax(getPeak(inputs[channel], numSamples), peaks[channel] * fall);
+
+        const double meanSquare = sumOfProducts(inputs[channel], inputs[channel], numSamples) / numSamples;
+        meanSquares[channel] = meanSquares[channel] * smoothing + meanSquare * (1.0 - smoothing);
+    }
+
+    meanProduct = meanProduct * smoothing + sumOfProducts(left, right, numSamples) / numSamples * (1.0 - smoothing);
+
+    // The loudness steps rarely line up with blocks, so split at step boundaries
+    for (int start = 0; start < numSamples;) {
+        const int length = juce::jmin(numSamples - start, samplesPerStep - samplesInStep,
+                                      static_cast<int>(weighted.size()));
+
+        measureLoudness(left + start, numChannels > 1 ? right + start : nullptr, length);
+        start += length;
+        samplesInStep += length;
+
+        if (samplesInStep == samplesPerStep)
+            finishLoudnessStep();
+    }
+
+    publish();
+}
+
+void LevelMeter::processSilence(int numSamples) noexcept
+{
+    if (numSamples <= 0)
+        return;
+
+    applyPendingReset();
+
+    const float fall = static_cast<float>(std::pow(10.0, -peakFallDecibelsPerSecond / 20.0 * numSamples / sampleRate));
+    const double smoothing = std::exp(-numSamples / (rmsSeconds * sampleRate));
+
+    for (int channel = 0; channel < 2; ++channel) {
+        peaks[channel] *= fall;
+        meanSquares[channel] *= smoothing;
+
+        // Whatever the K-weighting still rings with is far below the gate
+        shelf[channel].reset();
+        highPass[channel].reset();
+    }
+
+    meanProduct *= smoothing;
+
+    // Silence adds no energy, so only the step boundaries matter
+    for (int remaining = numSamples; remaining > 0;) {
+        const int length = juce::jmin(remaining, samplesPerStep - samplesInStep);
+        remaining -= length;
+        samplesInStep += length;
+
+        if (samplesInStep == samplesPerStep)
+            finishLoudnessStep();
+    }
+
+    publish();
+}
+
+void LevelMeter::applyPendingReset() noexcept
+{
+    if (resetRequested.exchange(false)) {
+        histogramEnergy.fill(0.0);
+        histogramCount.fill(0);
+        integratedLoudness = -INFINITY;
+    }
+}
+
+void LevelMeter::measureLoudness(const float* left, const float* right, int numSamples) noexcept
+{
+    const float* inputs[] = { left, right };
+
+    for (int channel = 0; channel < 2 && inputs[channel] != nullptr; ++channel) {
+        auto& stage1 = shelf[channel];
+        auto& stage2 = highPass[channel];
+
+        for (int i = 0; i < numSamples; ++i) {
+            const double x = inputs[channel][i];
+            const double y1 = stage1.b0 * x + stage1.s1;
+            stage1.s1 = stage1.b1 * x - stage1.a1 * y1 + stage1.s2;
+            stage1.s2 = stage1.b2 * x - stage1.a2 * y1;
+
+            const double y2 = stage2.b0 * y1 + stage2.s1;
+            stage2.s1 = stage2.b1 * y1 - stage2.a1 * y2 + stage2.s2;
+            stage2.s2 = stage2.b2 * y1 - stage2.a2 * y2;
+
+            weighted[static_cast<size_t>(i)] = static_cast<float>(y2);
+        }
+
+        stepEnergy += sumOfProducts(weighted.data(), weighted.data(), numSamples);
+    }
+}
+
+void LevelMeter::finishLoudnessStep() noexcept
+{
+    stepEnergies[static_cast<size_t>(numSteps % numLoudnessSteps)] = stepEnergy / samplesPerStep;
+    ++numSteps;
+    samplesInStep = 0;
+    stepEnergy = 0.0;
+
+    auto averageOfLast = [this](int count) {
+        double sum = 0.0;
+
+        for (int i = 1; i <= count; ++i)
+            sum += stepEnergies[static_cast<size_t>((numSteps - i) % numLoudnessSteps)];
+
+        return sum / count;
+    };
+
+    if (numSteps < numMomentarySteps)
+        return;
+
+    // Every 400 ms window, overlapping the last by 75%, is also a gating block
+    const double momentaryEnergy = averageOfLast(numMomentarySteps);
+    momentaryLoudness = toLoudness(momentaryEnergy);
+    shortTermLoudness = toLoudness(averageOfLast(juce::jmin(numSteps, numLoudnessSteps)));
+
+    if (momentaryLoudness >= absoluteGate) {
+        const int bin = juce::jlimit(0, numHistogramBins - 1,
+                                     static_cast<int>((momentaryLoudness - histogramFloor) * numHistogramBins
+                                                      / (histogramCeiling - histogramFloor)));
+        histogramEnergy[static_cast<size_t>(bin)] += momentaryEnergy;
+        ++histogramCount[static_cast<size_t>(bin)];
+        integratedLoudness = getIntegratedLoudness();
+    }
+}
+
+float LevelMeter::getIntegratedLoudness() const noexcept
+{
+    double energy = 0.0;
+    uint64_t count = 0;
+
+    for (int bin = 0; bin < numHistogramBins; ++bin) {
+        energy += histogramEnergy[static_cast<size_t>(bin)];
+        count += histogramCount[static_cast<size_t>(bin)];
+    }
+
+    if (count == 0)
+        return -INFINITY;
+
+    // Bins are 0.1 LU wide, so the relative gate is placed to within that
+    const float threshold = toLoudness(energy / static_cast<double>(count)) + relativeGate;
+    const int firstBin = juce::jlimit(0, numHistogramBins,
+                                      juce::roundToInt((threshold - histogramFloor) * numHistogramBins
+                                                       / (histogramCeiling - histogramFloor)));
+    energy = 0.0;
+    count = 0;
+
+    for (int bin = firstBin; bin < numHistogramBins; ++bin) {
+        energy += histogramEnergy[static_cast<size_t>(bin)];
+        count += histogramCount[static_cast<size_t>(bin)];
+    }
+
+    return count > 0 ? toLoudness(energy / static_cast<double>(count)) : -INFINITY;
+}
+
+void LevelMeter::publish() noexcept
+{
+    auto& levels = slots[static_cast<size_t>(writeSlot)];
+
+    for (int channel = 0; channel < 2; ++channel) {
+        levels.peak[channel] = peaks[channel];
+        levels.rms[channel] = static_cast<float>(std::sqrt(meanSquares[channel]));
+    }
+
+    const double power = meanSquares[0] * meanSquares[1];
+    levels.correlation = power > 1.0e-20 ? static_cast<float>(juce::jlimit(-1.0, 1.0, meanProduct / std::sqrt(power)))
+                                         : 0.0f;
+    levels.momentaryLoudness = momentaryLoudness;
+    levels.shortTermLoudness = shortTermLoudness;
+    levels.integratedLoudness = integratedLoudness;
+
+    // Seqlock write: the sequence is odd while the fields change. The flag
+    // tells setSharedOutput() that the old destination may still be in use.
+    writingShared.store(true);
+
+    if (auto* shared = sharedOutput.load()) {
+        auto* counter = reinterpret_cast<std::atomic<uint32_t>*>(shared + sequenceField);
+        counter->store(++sequence, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        shared[peakLeftField] = levels.peak[0];
+        shared[peakRightField] = levels.peak[1];
+        shared[rmsLeftField] = levels.rms[0];
+        shared[rmsRightField] = levels.rms[1];
+        shared[momentaryLoudnessField] = levels.momentaryLoudness;
+        shared[shortTermLoudnessField] = levels.shortTermLoudness;
+        shared[integratedLoudnessField] = levels.integratedLoudness;
+        shared[correlationField] = levels.correlation;
+
+        counter->store(++sequence, std::memory_order_release);
+    }
+
+    writingShared.store(false, std::memory_order_release);
+
+    writeSlot = middleSlot.exchange(writeSlot | freshFlag) & ~freshFlag;
+}
+
+LevelMeter::Levels LevelMeter::getLevels() noexcept
+{
+    if ((middleSlot.load(std::memory_order_relaxed) & freshFlag) != 0)
+        readSlot = middleSlot.exchange(readSlot) & ~freshFlag;
+
+    return slots[static_cast<size_t>(readSlot)];
+}
+
+void LevelMeter::resetIntegratedLoudness() noexcept
+{
+    resetRequested.store(true);
+}
+
+void LevelMeter::setSharedOutput(float* destination) noexcept
+{
+    sharedOutput.exchange(destination);
+
+    while (writingShared.load())
+        std::this_thread::yield();
+}
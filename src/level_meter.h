@@ -0,0 +1,130 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+// Stereo output metering: peak and RMS per channel, EBU R128 loudness
+// (momentary, short-term and gated integrated) and phase correlation.
+// Everything is computed on the audio thread with SIMD kernels and without
+// allocating, then published two ways:
+//  - through a triple buffer, read with getLevels() on one other thread
+//  - optionally straight into memory owned by the reader, such as a JS
+//    SharedArrayBuffer, guarded by a sequence counter (a seqlock), so the
+//    reader can poll it at display rate without calling into native code
+class LevelMeter
+{
+public:
+    struct Levels
+    {
+        float peak[2] {};                       // linear, instant attack, falling 20 dB/s
+        float rms[2] {};                        // linear, 300 ms integration
+        float momentaryLoudness = -INFINITY;    // LUFS over the last 400 ms
+        float shortTermLoudness = -INFINITY;    // LUFS over the last 3 s
+        float integratedLoudness = -INFINITY;   // gated LUFS since the last reset
+        float correlation = 0.0f;               // -1 (out of phase) to 1 (mono)
+    };
+
+    // Layout of the shared output, in floats. The sequence field holds a
+    // uint32 that is odd while the values are being written.
+    enum SharedField
+    {
+        sequenceField,
+        peakLeftField,
+        peakRightField,
+        rmsLeftField,
+        rmsRightField,
+        momentaryLoudnessField,
+        shortTermLoudnessField,
+        integratedLoudnessField,
+        correlationField,
+        numSharedFields
+    };
+
+    static const char* getSharedFieldName(int field);
+
+    LevelMeter();
+
+    void prepare(double sampleRate, int maximumBlockSize);
+
+    // Audio thread. A mono buffer is metered as both channels.
+    void process(const float* const* channels, int numChannels, int numSamples) noexcept;
+
+    // Audio thread. Same as process() on numSamples of digital silence, but
+    // only decays the levels instead of filtering and summing zeros.
+    void processSilence(int numSamples) noexcept;
+
+    // Latest levels - from a single reader thread
+    Levels getLevels() noexcept;
+
+    // Starts integrated loudness over at the next block
+    void resetIntegratedLoudness() noexcept;
+
+    // Where to also write the levels, numSharedFields floats, or nullptr.
+    // Returns once the audio thread has stopped writing to the previous one.
+    void setSharedOutput(float* destination) noexcept;
+
+private:
+    // K-weighting stage from ITU-R BS.1770, direct form II transposed
+    struct Biquad
+    {
+        void setCoefficients(double b0, double b1, double b2, double a1, double a2) noexcept;
+        void reset() noexcept { s1 = s2 = 0.0; }
+
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+        double s1 = 0.0, s2 = 0.0;
+    };
+
+    // Mean square loudness histogram for the integrated gate, in 0.1 LU bins
+    static constexpr float histogramFloor = -70.0f;
+    static constexpr float histogramCeiling = 10.0f;
+    static constexpr int numHistogramBins = 800;
+
+    // Short-term loudness spans this many 100 ms steps, momentary four of them
+    static constexpr int numLoudnessSteps = 30;
+    static constexpr int numMomentarySteps = 4;
+
+    void applyPendingReset() noexcept;
+    void measureLoudness(const float* left, const float* right, int numSamples) noexcept;
+    void finishLoudnessStep() noexcept;
+    float getIntegratedLoudness() const noexcept;
+    void publish() noexcept;
+
+    double sampleRate = 44100.0;
+
+    Biquad shelf[2], highPass[2];
+    std::vector<float> weighted;
+
+    float peaks[2] {};
+    double meanSquares[2] {};
+    double meanProduct = 0.0;
+
+    int samplesPerStep = 4410;
+    int samplesInStep = 0;
+    double stepEnergy = 0.0;
+    std::array<double, numLoudnessSteps> stepEnergies {};
+    int numSteps = 0;
+    float momentaryLoudness = -INFINITY;
+    float shortTermLoudness = -INFINITY;
+
+    std::array<double, numHistogramBins> histogramEnergy {};
+    std::array<uint32_t, numHistogramBins> histogramCount {};
+    float integratedLoudness = -INFINITY;
+    std::atomic<bool> resetRequested { false };
+
+    // Triple buffer: the writer fills its slot and swaps it with the middle
+    // one, flagging it as fresh; the reader swaps a fresh middle for its own
+    static constexpr int freshFlag = 4;
+    std::array<Levels, 3> slots;
+    int writeSlot = 0;
+    std::atomic<int> middleSlot { 1 };
+    int readSlot = 2;
+
+    std::atomic<float*> sharedOutput { nullptr };
+    std::atomic<bool> writingShared { false };
+    uint32_t sequence = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LevelMeter)
+};
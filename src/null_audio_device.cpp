@@ -0,0 +1,196 @@
+#include "null_audio_device.h"
+
+namespace
+{
+    constexpr int numNullChannels = 8;
+
+    class NullAudioIODevice : public juce::AudioIODevice,
+                              private juce::Thread
+    {
+    public:
+        NullAudioIODevice()
+            : juce::AudioIODevice(NullAudioIODeviceType::deviceName, NullAudioIODeviceType::typeName),
+              juce::Thread("Null Audio Device")
+        {
+        }
+
+        ~NullAudioIODevice() override
+        {
+            close();
+        }
+
+        juce::StringArray getOutputChannelNames() override { return getChannelNames("Output"); }
+        juce::StringArray getInputChannelNames() override  { return getChannelNames("Input"); }
+
+        juce::Array<double> getAvailableSampleRates() override { return { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 }; }
+        juce::Array<int> getAvailableBufferSizes() override    { return { 32, 64, 128, 256, 512, 1024, 2048, 4096 }; }
+        int getDefaultBufferSize() override                    { return 256; }
+
+        juce::String open(const juce::BigInteger& inputChannels,
+                          const juce::BigInteger& outputChannels,
+                          double sampleRate,
+                          int bufferSizeSamples) override
+        {
+            close();
+
+            activeInputs = inputChannels;
+            activeInputs.setRange(numNullChannels, activeInputs.getHighestBit() + 1, false);
+            activeOutputs = outputChannels;
+            activeOutputs.setRange(numNullChannels, activeOutputs.getHighestBit() + 1, false);
+
+            currentSampleRate = sampleRate > 0.0 ? sampleRate : 44100.0;
+            currentBufferSize = bufferSizeSamples > 0 ? bufferSizeSamples : getDefaultBufferSize();
+
+            numInputs = activeInputs.countNumberOfSetBits();
+            numOutputs = activeOutputs.countNumberOfSetBits();
+
+            inputBuffer.setSize(juce::jmax(1, numInputs), currentBufferSize);
+            outputBuffer.setSize(juce::jmax(1, numOutputs), currentBufferSize);
+            inputBuffer.clear();
+
+            deviceOpen = true;
+            return {};
+        }
+
+        void close() override
+        {
+            stop();
+            deviceOpen = false;
+        }
+
+        bool isOpen() override { return deviceOpen; }
+
+        void start(juce::AudioIODeviceCallback* newCallback) override
+        {
+            if (!deviceOpen || newCallback == nullptr || isThreadRunning())
+                return;
+
+            callback = newCallback;
+            callback->audioDeviceAboutToStart(this);
+
+            // Real-time scheduling needs privileges the process may not have
+            if (!startRealtimeThread(juce::Thread::RealtimeOptions{}
+                                         .withApproximateAudioProcessingTime(currentBufferSize, currentSampleRate)))
+                startThread(juce::Thread::Priority::highest);
+        }
+
+        void stop() override
+        {
+            if (!isThreadRunning())
+                return;
+
+            stopThread(2000);
+
+            if (auto* oldCallback = std::exchange(callback, nullptr))
+                oldCallback->audioDeviceStopped();
+        }
+
+        bool isPlaying() override { return isThreadRunning(); }
+        juce::String getLastError() override { return {}; }
+
+        int getCurrentBufferSizeSamples() override { return currentBufferSize; }
+        double getCurrentSampleRate() override { return currentSampleRate; }
+        int getCurrentBitDepth() override { return 32; }
+
+        juce::BigInteger getActiveOutputChannels() const override { return activeOutputs; }
+        juce::BigInteger getActiveInputChannels() const override  { return activeInputs; }
+
+        int getOutputLatencyInSamples() override { return 0; }
+        int getInputLatencyInSamples() override  { return 0; }
+
+        int getXRunCount() const noexcept override { return xruns.load(); }
+
+    private:
+        static juce::StringArray getChannelNames(const juce::String& prefix)
+        {
+            juce::StringArray names;
+
+            for (int i = 0; i < numNullChannels; ++i)
+                names.add(prefix + " " + juce::String(i + 1));
+
+            return names;
+        }
+
+        // Calls back once per buffer period, like a sound card would. If a callback
+        // overruns its deadline the schedule is reset and counted as an xrun.
+        void run() override
+        {
+            const double blockMs = 1000.0 * currentBufferSize / currentSampleRate;
+            double nextDeadline = juce::Time::getMillisecondCounterHiRes() + blockMs;
+            juce::AudioIODeviceCallbackContext context;
+
+            while (!threadShouldExit()) {
+                callback->audioDeviceIOCallbackWithContext(inputBuffer.getArrayOfReadPointers(),
+                                                           numInputs,
+                                                           outputBuffer.getArrayOfWritePointers(),
+                                                           numOutputs,
+                                                           currentBufferSize,
+                                                           context);
+
+                const double now = juce::Time::getMillisecondCounterHiRes();
+
+                if (now > nextDeadline) {
+                    ++xruns;
+                    nextDeadline = now;
+                }
+
+                if (nextDeadline - now >= 1.0)
+                    wait(static_cast<int>(nextDeadline - now));
+
+                nextDeadline += blockMs;
+            }
+        }
+
+        juce::AudioIODeviceCallback* callback = nullptr;
+        juce::AudioBuffer<float> inputBuffer, outputBuffer;
+        juce::BigInteger activeInputs, activeOutputs;
+        int numInputs = 0, numOutputs = 0;
+        double currentSampleRate = 44100.0;
+        int currentBufferSize = 256;
+        bool deviceOpen = false;
+        std::atomic<int> xruns { 0 };
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NullAudioIODevice)
+    };
+}
+
+NullAudioIODeviceType::NullAudioIODeviceType()
+    : juce::AudioIODeviceType(typeName)
+{
+}
+
+void NullAudioIODeviceType::scanForDevices()
+{
+}
+
+juce::StringArray NullAudioIODeviceType::getDeviceNames(bool) const
+{
+    return { deviceName };
+}
+
+int NullAudioIODeviceType::getDefaultDeviceIndex(bool) const
+{
+    return 0;
+}
+
+int NullAudioIODeviceType::getIndexOfDevice(juce::AudioIODevice* device, bool) const
+{
+    return device != nullptr && device->getName() == deviceName ? 0 : -1;
+}
+
+bool NullAudioIODeviceType::hasSeparateInputsAndOutputs() const
+{
+    return false;
+}
+
+juce::AudioIODevice* NullAudioIODeviceType::createDevice(const juce::String& outputDeviceName,
+                                                         const juce::String& inputDeviceName)
+{
+    if (outputDeviceName.isNotEmpty() && outputDeviceName != deviceName)
+        return nullptr;
+
+    if (inputDeviceName.isNotEmpty() && inputDeviceName != deviceName)
+        return nullptr;
+
+    return new NullAudioIODevice();
+}
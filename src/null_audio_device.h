@@ -0,0 +1,26 @@
+#pragma once
+
+#include <juce_audio_devices/juce_audio_devices.h>
+
+// A device type with a single silent device that drives its callback from a
+// high-priority thread at the pace of a real sound card. It lets the native
+// playback engine run headless, e.g. in CI or on machines without audio
+// hardware.
+class NullAudioIODeviceType : public juce::AudioIODeviceType
+{
+public:
+    static constexpr const char* typeName = "Null";
+    static constexpr const char* deviceName = "Null Audio Device";
+
+    NullAudioIODeviceType();
+
+    void scanForDevices() override;
+    juce::StringArray getDeviceNames(bool wantInputNames) const override;
+    int getDefaultDeviceIndex(bool forInput) const override;
+    int getIndexOfDevice(juce::AudioIODevice* device, bool asInput) const override;
+    bool hasSeparateInputsAndOutputs() const override;
+    juce::AudioIODevice* createDevice(const juce::String& outputDeviceName,
+                                      const juce::String& inputDeviceName) override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NullAudioIODeviceType)
+};
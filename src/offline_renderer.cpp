@@ -0,0 +1,359 @@
+#include "offline_renderer.h"
+
+#include <algorithm>
+#include <array>
+
+namespace
+{
+    // Audio moves between the pipeline stages in chunks of this many samples
+    constexpr int chunkSize = 16384;
+    constexpr int numChunks = 4;
+
+    // Progress is reported in steps of at least this much
+    constexpr double progressInterval = 0.01;
+
+    // Runs one pipeline stage
+    class StageThread : public juce::Thread
+    {
+    public:
+        StageThread(const juce::String& name, std::function<void()> stageToRun)
+            : juce::Thread(name), stage(std::move(stageToRun)) {}
+
+        ~StageThread() override { stopThread(-1); }
+
+        void run() override { stage(); }
+
+    private:
+        std::function<void()> stage;
+    };
+
+    // A ring of chunks passed from the decoder to the processor to the encoder.
+    // Each stage owns the chunks between its own counter and the next stage's,
+    // and waits on its event until the stage before it has moved on.
+    struct Pipeline
+    {
+        struct Chunk
+        {
+            juce::AudioBuffer<float> buffer;
+            int numSamples = 0;
+        };
+
+        explicit Pipeline(int numChannels)
+        {
+            for (auto& chunk : chunks)
+                chunk.buffer.setSize(numChannels, chunkSize);
+        }
+
+        Chunk& getChunk(int index) { return chunks[static_cast<size_t>(index % numChunks)]; }
+
+        // Returns false if another stage failed or the stage is being stopped
+        bool waitFor(std::atomic<int>& counter, int value, juce::WaitableEvent& event)
+        {
+            while (counter.load() < value) {
+                if (failed.load() || juce::Thread::currentThreadShouldExit())
+                    return false;
+
+                event.wait(100);
+            }
+
+            return !failed.load();
+        }
+
+        void advance(std::atomic<int>& counter, juce::WaitableEvent& event)
+        {
+            ++counter;
+            event.signal();
+        }
+
+        void fail(const juce::String& message)
+        {
+            {
+                const juce::SpinLock::ScopedLockType sl(errorLock);
+
+                if (error.isEmpty())
+                    error = message;
+            }
+
+            failed.store(true);
+            decoded.signal();
+            processed.signal();
+            written.signal();
+        }
+
+        std::array<Chunk, numChunks> chunks;
+        std::atomic<int> numDecoded { 0 }, numProcessed { 0 }, numWritten { 0 };
+        juce::WaitableEvent decoded, processed, written;
+        std::atomic<bool> failed { false };
+        juce::SpinLock errorLock;
+        juce::String error;
+    };
+
+    int getNearestBitDepth(juce::AudioFormat& format, int bitsPerSample)
+    {
+        const auto depths = format.getPossibleBitDepths();
+        int nearest = depths.isEmpty() ? bitsPerSample : depths[0];
+
+        for (int depth : depths)
+            if (std::abs(depth - bitsPerSample) < std::abs(nearest - bitsPerSample))
+                nearest = depth;
+
+        return nearest;
+    }
+
+    // Calls the progress callback whenever another progressInterval is done
+    struct ProgressReporter
+    {
+        void update(double progress)
+        {
+            if (callback && (progress >= lastReported + progressInterval || progress >= 1.0)) {
+                lastReported = progress;
+                callback(progress);
+            }
+        }
+
+        const OfflineRenderer::ProgressCallback& callback;
+        double lastReported = 0.0;
+    };
+
+    // Processes float audio in place, a block at a time, at the precision the
+    // processor was prepared for. In double precision each block is converted
+    // once on the way in and once on the way out, and the whole chain in
+    // between runs in double.
+    class BlockProcessor
+    {
+    public:
+        BlockProcessor(JUCEAudioProcessor& processorToUse, int channelsToProcess, int blockSize)
+            : processor(processorToUse), numChannels(channelsToProcess)
+        {
+            if (processor.isUsingDoublePrecision())
+                doubleBlock.setSize(numChannels, blockSize);
+        }
+
+        void process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+        {
+            if (!processor.isUsingDoublePrecision()) {
+                floatBlock.setDataToReferTo(buffer.getArrayOfWritePointers(), numChannels, startSample, numSamples);
+                processor.processBlock(floatBlock, midiBuffer);
+                return;
+            }
+
+            doubleBlock.setSize(numChannels, numSamples, false, false, true);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                std::copy_n(buffer.getReadPointer(channel, startSample), numSamples, doubleBlock.getWritePointer(channel));
+
+            processor.processBlock(doubleBlock, midiBuffer);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                std::transform(doubleBlock.getReadPointer(channel), doubleBlock.getReadPointer(channel) + numSamples,
+                               buffer.getWritePointer(channel, startSample),
+                               [](double sample) { return static_cast<float>(sample); });
+        }
+
+    private:
+        JUCEAudioProcessor& processor;
+        const int numChannels;
+        juce::AudioBuffer<float> floatBlock;
+        juce::AudioBuffer<double> doubleBlock;
+        juce::MidiBuffer midiBuffer;
+    };
+}
+
+juce::ThreadPool& OfflineRenderer::getRenderPool()
+{
+    static juce::ThreadPool renderPool(juce::ThreadPoolOptions{}
+                                           .withThreadName("JUCE Offline Render")
+                                           .withNumberOfThreads(juce::jmax(1, juce::SystemStats::getNumCpus())));
+    return renderPool;
+}
+
+void OfflineRenderer::prepareProcessor(JUCEAudioProcessor& processor, double sampleRate, const Options& options)
+{
+    const int blockSize = juce::jmax(1, options.blockSize);
+
+    processor.setNonRealtime(true);
+    processor.setProcessingPrecision(options.doublePrecision ? juce::AudioProcessor::doublePrecision
+                                                             : juce::AudioProcessor::singlePrecision);
+    processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+}
+
+OfflineRenderer::Result OfflineRenderer::renderFile(JUCEAudioProcessor& processor, const juce::File& input,
+                                                    const juce::File& output, const Options& options,
+                                                    const ProgressCallback& progressCallback)
+{
+    Result result;
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(input));
+
+    if (reader == nullptr) {
+        result.error = "Cannot read " + input.getFullPathName();
+        return result;
+    }
+
+    auto* format = formatManager.findFormatForFileExtension(output.getFileExtension());
+
+    if (format == nullptr) {
+        result.error = "Unsupported output format: " + output.getFileName();
+        return result;
+    }
+
+    // Only the first two channels of a multichannel file go through the stereo chain
+    result.sampleRate = reader->sampleRate;
+    result.numChannels = juce::jlimit(1, maxChannels, static_cast<int>(reader->numChannels));
+    result.numSamples = reader->lengthInSamples;
+
+    output.deleteFile();
+    std::unique_ptr<juce::FileOutputStream> stream(output.createOutputStream());
+
+    if (stream == nullptr || stream->failedToOpen()) {
+        result.error = "Cannot write " + output.getFullPathName();
+        return result;
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), result.sampleRate,
+                                                                            static_cast<unsigned int>(result.numChannels),
+                                                                            getNearestBitDepth(*format, options.bitsPerSample),
+                                                                            {}, 0));
+
+    if (writer == nullptr) {
+        result.error = "Cannot encode " + output.getFileName() + " at this sample rate and channel count";
+        return result;
+    }
+
+    // The writer owns the stream from here on
+    stream.release();
+
+    const int blockSize = juce::jmax(1, options.blockSize);
+    prepareProcessor(processor, result.sampleRate, options);
+
+    // Run on past the end of the input for as long as the processor delays it,
+    // and drop as much from the start of the output
+    const int latency = processor.getLatencySamples();
+    const juce::int64 totalSamples = result.numSamples + latency;
+    const int totalChunks = static_cast<int>((totalSamples + chunkSize - 1) / chunkSize);
+
+    Pipeline pipeline(result.numChannels);
+
+    StageThread decoder("JUCE Offline Decoder", [&] {
+        for (int index = 0; index < totalChunks; ++index) {
+            if (!pipeline.waitFor(pipeline.numWritten, index - numChunks + 1, pipeline.written))
+                return;
+
+            auto& chunk = pipeline.getChunk(index);
+            const juce::int64 start = static_cast<juce::int64>(index) * chunkSize;
+            chunk.numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(chunkSize), totalSamples - start));
+
+            // Reads past the end of the file are filled with silence
+            if (!reader->read(&chunk.buffer, 0, chunk.numSamples, start, true, true)) {
+                pipeline.fail("Error decoding " + input.getFileName());
+                return;
+            }
+
+            pipeline.advance(pipeline.numDecoded, pipeline.decoded);
+        }
+    });
+
+    StageThread encoder("JUCE Offline Encoder", [&] {
+        for (int index = 0; index < totalChunks; ++index) {
+            if (!pipeline.waitFor(pipeline.numProcessed, index + 1, pipeline.processed))
+                return;
+
+            auto& chunk = pipeline.getChunk(index);
+            const juce::int64 start = static_cast<juce::int64>(index) * chunkSize;
+            const int skip = static_cast<int>(juce::jlimit(static_cast<juce::int64>(0),
+                                                           static_cast<juce::int64>(chunk.numSamples),
+                                                           latency - start));
+
+            if (skip < chunk.numSamples && !writer->writeFromAudioSampleBuffer(chunk.buffer, skip, chunk.numSamples - skip)) {
+                pipeline.fail("Error encoding " + output.getFileName());
+                return;
+            }
+
+            pipeline.advance(pipeline.numWritten, pipeline.written);
+        }
+    });
+
+    decoder.startThread();
+    encoder.startThread();
+
+    BlockProcessor blockProcessor(processor, result.numChannels, blockSize);
+    ProgressReporter progress { progressCallback };
+
+    for (int index = 0; index < totalChunks; ++index) {
+        if (!pipeline.waitFor(pipeline.numDecoded, index + 1, pipeline.decoded))
+            break;
+
+        auto& chunk = pipeline.getChunk(index);
+
+        for (int start = 0; start < chunk.numSamples; start += blockSize)
+            blockProcessor.process(chunk.buffer, start, juce::jmin(blockSize, chunk.numSamples - start));
+
+        pipeline.advance(pipeline.numProcessed, pipeline.processed);
+        progress.update(static_cast<double>(index + 1) / totalChunks);
+    }
+
+    decoder.waitForThreadToExit(-1);
+    encoder.waitForThreadToExit(-1);
+
+    if (pipeline.failed.load()) {
+        writer.reset();
+        output.deleteFile();
+        result.error = pipeline.error;
+        return result;
+    }
+
+    // Deleting the writer finalises the file header
+    writer.reset();
+    return result;
+}
+
+OfflineRenderer::Result OfflineRenderer::renderBuffer(JUCEAudioProcessor& processor, juce::AudioBuffer<float>& buffer,
+                                                      double sampleRate, const Options& options,
+                                                      const ProgressCallback& progressCallback)
+{
+    Result result;
+    result.sampleRate = sampleRate;
+    result.numChannels = juce::jmin(maxChannels, buffer.getNumChannels());
+    result.numSamples = buffer.getNumSamples();
+
+    const int blockSize = juce::jmax(1, options.blockSize);
+    prepareProcessor(processor, sampleRate, options);
+
+    const int numSamples = buffer.getNumSamples();
+    const int latency = processor.getLatencySamples();
+    const int totalSamples = numSamples + latency;
+
+    juce::AudioBuffer<float> block(result.numChannels, blockSize);
+    BlockProcessor blockProcessor(processor, result.numChannels, blockSize);
+    ProgressReporter progress { progressCallback };
+
+    // Each block is copied out before it is processed, so writing the delayed
+    // output back never overwrites input that hasn't been read yet
+    for (int start = 0; start < totalSamples; start += blockSize) {
+        const int length = juce::jmin(blockSize, totalSamples - start);
+        const int numInput = juce::jlimit(0, length, numSamples - start);
+
+        block.setSize(result.numChannels, length, false, false, true);
+        block.clear();
+
+        for (int channel = 0; channel < result.numChannels; ++channel)
+            if (numInput > 0)
+                block.copyFrom(channel, 0, buffer, channel, start, numInput);
+
+        blockProcessor.process(block, 0, length);
+
+        const int skip = juce::jlimit(0, length, latency - start);
+
+        for (int channel = 0; channel < result.numChannels; ++channel)
+            if (skip < length)
+                buffer.copyFrom(channel, start + skip - latency, block, channel, skip, length - skip);
+
+        progress.update(static_cast<double>(start + length) / totalSamples);
+    }
+
+    return result;
+}
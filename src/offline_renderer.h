@@ -0,0 +1,54 @@
+#pragma once
+
+#include "juce_audio_processor.h"
+
+#include <functional>
+
+// Renders audio through a processor faster than real time, for batch jobs
+// such as bouncing recorded sets or stems. Files go through a three-stage
+// pipeline: a decoder thread reads ahead into a small ring of chunks, the
+// calling thread processes them and an encoder thread writes them out, so
+// decoding, processing and encoding overlap. The processor's latency is
+// compensated, so the output lines up with the input sample for sample.
+//
+// Each render blocks its calling thread. Run separate renders on
+// getRenderPool() to spread them across cores.
+class OfflineRenderer
+{
+public:
+    struct Options
+    {
+        int blockSize = 512;
+        int bitsPerSample = 24; // the nearest depth the output format supports is used
+        bool doublePrecision = false; // run the effect chain in double precision
+    };
+
+    struct Result
+    {
+        juce::String error; // empty on success
+        juce::int64 numSamples = 0;
+        double sampleRate = 0.0;
+        int numChannels = 0;
+    };
+
+    // Called on the processing thread with the fraction rendered so far
+    using ProgressCallback = std::function<void(double progress)>;
+
+    static constexpr int maxChannels = 2;
+
+    // Decodes input, processes it and encodes it into output, whose format is
+    // picked from its file extension (.wav, .aiff, .flac, ...). output is overwritten.
+    static Result renderFile(JUCEAudioProcessor& processor, const juce::File& input, const juce::File& output,
+                             const Options& options, const ProgressCallback& progressCallback);
+
+    // Processes a buffer in place
+    static Result renderBuffer(JUCEAudioProcessor& processor, juce::AudioBuffer<float>& buffer, double sampleRate,
+                               const Options& options, const ProgressCallback& progressCallback);
+
+    // Separate from the block processing pool, so long renders never hold up
+    // processAudioAsync. Sized to the number of CPU cores.
+    static juce::ThreadPool& getRenderPool();
+
+private:
+    static void prepareProcessor(JUCEAudioProcessor& processor, double sampleRate, const Options& options);
+};
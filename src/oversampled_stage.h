@@ -0,0 +1,71 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+#include <memory>
+
+// Runs a processor at 2x or 4x the sample rate, between the up and down
+// sampling of juce::dsp::Oversampling with polyphase IIR half-band filters,
+// so nonlinear or high-resonance stages don't alias and filters don't warp
+// near Nyquist. The processor is prepared at the oversampled rate. The
+// oversampling adds a whole number of samples of latency, reported by
+// getLatencySamples(). Fits into a juce::dsp::ProcessorChain.
+template <typename SampleType, typename Processor>
+class OversampledStage
+{
+public:
+    static bool isValidFactor(int factor) noexcept { return factor == 2 || factor == 4; }
+
+    Processor& getProcessor() noexcept { return processor; }
+
+    // Control thread, before prepare()
+    void setFactor(int newFactor) noexcept
+    {
+        jassert(isValidFactor(newFactor));
+        factor = newFactor;
+    }
+
+    int getFactor() const noexcept { return factor; }
+
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        oversampling = std::make_unique<juce::dsp::Oversampling<SampleType>>(
+            spec.numChannels, static_cast<size_t>(factor == 4 ? 2 : 1),
+            juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR, true, true);
+        oversampling->initProcessing(spec.maximumBlockSize);
+
+        processor.prepare({ spec.sampleRate * factor, spec.maximumBlockSize * static_cast<juce::uint32>(factor),
+                            spec.numChannels });
+    }
+
+    void reset() noexcept
+    {
+        processor.reset();
+
+        if (oversampling != nullptr)
+            oversampling->reset();
+    }
+
+    // Samples at the base rate, 0 until prepared
+    int getLatencySamples() const noexcept
+    {
+        return oversampling != nullptr ? juce::roundToInt(oversampling->getLatencyInSamples()) : 0;
+    }
+
+    // Replacing contexts only
+    template <typename ProcessContext>
+    void process(const ProcessContext& context) noexcept
+    {
+        const auto& inputBlock = context.getInputBlock();
+        auto upsampled = oversampling->processSamplesUp(inputBlock).getSubsetChannelBlock(0, inputBlock.getNumChannels());
+        processor.process(juce::dsp::ProcessContextReplacing<SampleType>(upsampled));
+
+        auto& outputBlock = context.getOutputBlock();
+        oversampling->processSamplesDown(outputBlock);
+    }
+
+private:
+    Processor processor;
+    std::unique_ptr<juce::dsp::Oversampling<SampleType>> oversampling;
+    int factor = 2;
+};
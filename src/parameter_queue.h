@@ -0,0 +1,109 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Wait-free single-producer/single-consumer queue of parameter changes. The
+// JS thread pushes commands and the audio thread drains them at the top of
+// each block, so neither side ever takes a lock.
+//
+// If the FIFO fills up (e.g. while nothing is being processed), the newest
+// value of each parameter is parked in an overflow slot instead. Once a value
+// has overflowed, later changes keep going to the overflow slots until the
+// consumer has picked them up, which preserves the order of the changes.
+template <int numParameters>
+class ParameterQueue
+{
+public:
+    static_assert(numParameters <= 64, "The overflow mask holds up to 64 parameters");
+
+    explicit ParameterQueue(int capacity = 1024)
+        : fifo(capacity), commands(static_cast<size_t>(capacity))
+    {
+    }
+
+    // Producer side
+    void push(int parameter, float value) noexcept
+    {
+        jassert(parameter >= 0 && parameter < numParameters);
+
+        if (overflowMask.load(std::memory_order_acquire) == 0) {
+            const auto scope = fifo.write(1);
+
+            if (scope.blockSize1 > 0) {
+                commands[static_cast<size_t>(scope.startIndex1)] = { parameter, value };
+                return;
+            }
+        }
+
+        overflowValues[parameter].store(value, std::memory_order_relaxed);
+        overflowMask.fetch_or(uint64_t(1) << parameter, std::memory_order_release);
+    }
+
+    // Producer side - pushes several changes that the consumer picks up
+    // together, in the same drain
+    void pushBatch(const int* parameters, const float* values, int numChanges) noexcept
+    {
+        if (overflowMask.load(std::memory_order_acquire) == 0 && fifo.getFreeSpace() >= numChanges) {
+            const auto scope = fifo.write(numChanges);
+            int i = 0;
+
+            for (int j = 0; j < scope.blockSize1; ++j, ++i)
+                commands[static_cast<size_t>(scope.startIndex1 + j)] = { parameters[i], values[i] };
+
+            for (int j = 0; j < scope.blockSize2; ++j, ++i)
+                commands[static_cast<size_t>(scope.startIndex2 + j)] = { parameters[i], values[i] };
+
+            return;
+        }
+
+        uint64_t mask = 0;
+
+        for (int i = 0; i < numChanges; ++i) {
+            jassert(parameters[i] >= 0 && parameters[i] < numParameters);
+            overflowValues[parameters[i]].store(values[i], std::memory_order_relaxed);
+            mask |= uint64_t(1) << parameters[i];
+        }
+
+        overflowMask.fetch_or(mask, std::memory_order_release);
+    }
+
+    // Consumer side - calls apply(parameter, value) for every pending change
+    template <typename Callback>
+    void drain(Callback&& apply) noexcept
+    {
+        {
+            const auto scope = fifo.read(fifo.getNumReady());
+
+            for (int i = 0; i < scope.blockSize1; ++i)
+                apply(commands[static_cast<size_t>(scope.startIndex1 + i)].parameter,
+                      commands[static_cast<size_t>(scope.startIndex1 + i)].value);
+
+            for (int i = 0; i < scope.blockSize2; ++i)
+                apply(commands[static_cast<size_t>(scope.startIndex2 + i)].parameter,
+                      commands[static_cast<size_t>(scope.startIndex2 + i)].value);
+        }
+
+        for (auto pending = overflowMask.exchange(0, std::memory_order_acquire); pending != 0; pending &= pending - 1) {
+            const int parameter = juce::countNumberOfBits(static_cast<juce::uint64>((pending & (~pending + 1)) - 1));
+            apply(parameter, overflowValues[parameter].load(std::memory_order_relaxed));
+        }
+    }
+
+private:
+    struct Command
+    {
+        int parameter;
+        float value;
+    };
+
+    juce::AbstractFifo fifo;
+    std::vector<Command> commands;
+    std::atomic<float> overflowValues[numParameters] {};
+    std::atomic<uint64_t> overflowMask { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE(ParameterQueue)
+};
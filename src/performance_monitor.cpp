@@ -0,0 +1,219 @@
+#include "performance_monitor.h"
+
+namespace
+{
+    // Single writer, so a load and a store are enough - no read-modify-write
+    void increment(std::atomic<uint64_t>& counter, uint64_t amount) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    void raiseTo(std::atomic<uint64_t>& maximum, uint64_t value) noexcept
+    {
+        if (value > maximum.load(std::memory_order_relaxed))
+            maximum.store(value, std::memory_order_relaxed);
+    }
+
+    uint64_t toNanoseconds(std::chrono::steady_clock::duration duration) noexcept
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+    }
+
+    double toMicroseconds(uint64_t nanoseconds) noexcept
+    {
+        return static_cast<double>(nanoseconds) / 1000.0;
+    }
+}
+
+const char* PerformanceMonitor::getStageName(int stage)
+{
+    static const char* const names[] = {
+        "parameters",
+        "scratch",
+        "pitchShift",
+        "eq",
+        "flanger",
+        "filter",
+        "volume",
+        "metering"
+    };
+
+    static_assert(std::size(names) == numStages, "Every stage needs a name");
+
+    return juce::isPositiveAndBelow(stage, numStages) ? names[stage] : nullptr;
+}
+
+int PerformanceMonitor::Histogram::getBucket(uint64_t nanoseconds) noexcept
+{
+    if (nanoseconds < static_cast<uint64_t>(subBucketCount))
+        return static_cast<int>(nanoseconds);
+
+    int magnitude = 0;
+
+    while ((nanoseconds >> (magnitude + 1)) != 0)
+        ++magnitude;
+
+    const int shift = magnitude - subBucketBits;
+    const int subBucket = static_cast<int>((nanoseconds >> shift) & (subBucketCount - 1));
+    return juce::jmin(numBuckets - 1, (shift + 1) * subBucketCount + subBucket);
+}
+
+uint64_t PerformanceMonitor::Histogram::getBucketLowerBound(int bucket) noexcept
+{
+    if (bucket < subBucketCount)
+        return static_cast<uint64_t>(bucket);
+
+    const int shift = bucket / subBucketCount - 1;
+    const auto subBucket = static_cast<uint64_t>(bucket % subBucketCount);
+    return (static_cast<uint64_t>(subBucketCount) + subBucket) << shift;
+}
+
+void PerformanceMonitor::Histogram::record(uint64_t nanoseconds) noexcept
+{
+    auto& count = counts[static_cast<size_t>(getBucket(nanoseconds))];
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void PerformanceMonitor::Histogram::clear() noexcept
+{
+    for (auto& count : counts)
+        count.store(0, std::memory_order_relaxed);
+}
+
+void PerformanceMonitor::prepare(double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+    blockSize = maximumBlockSize;
+    reset();
+}
+
+void PerformanceMonitor::reset() noexcept
+{
+    loadMeasurer.reset(sampleRate, blockSize);
+    resetRequested.store(true);
+}
+
+void PerformanceMonitor::clearIfRequested() noexcept
+{
+    if (!resetRequested.exchange(false))
+        return;
+
+    blockTimes.clear();
+    jitter.clear();
+    numBlocks.store(0, std::memory_order_relaxed);
+    numIdleBlocks.store(0, std::memory_order_relaxed);
+    totalNanoseconds.store(0, std::memory_order_relaxed);
+    maxNanoseconds.store(0, std::memory_order_relaxed);
+    maxJitterNanoseconds.store(0, std::memory_order_relaxed);
+
+    for (auto& total : stageTotals)
+        total.store(0, std::memory_order_relaxed);
+
+    lastBlockDuration = 0;
+}
+
+PerformanceMonitor::ScopedBlockTimer::ScopedBlockTimer(PerformanceMonitor& owner, int samplesInBlock) noexcept
+    : monitor(owner), numSamples(samplesInBlock), start(Clock::now()), lastMark(start)
+{
+}
+
+PerformanceMonitor::ScopedBlockTimer::~ScopedBlockTimer()
+{
+    monitor.finishBlock(start, Clock::now(), numSamples, stageNanoseconds, idle);
+}
+
+void PerformanceMonitor::ScopedBlockTimer::finishStage(Stage stage) noexcept
+{
+    const auto now = Clock::now();
+    stageNanoseconds[static_cast<size_t>(stage)] += toNanoseconds(now - lastMark);
+    lastMark = now;
+}
+
+void PerformanceMonitor::finishBlock(Clock::time_point start, Clock::time_point end, int numSamples,
+                                     const std::array<uint64_t, numStages>& stageNanoseconds, bool idle) noexcept
+{
+    clearIfRequested();
+
+    const auto nanoseconds = toNanoseconds(end - start);
+    loadMeasurer.registerRenderTime(static_cast<double>(nanoseconds) * 1.0e-6, numSamples);
+
+    blockTimes.record(nanoseconds);
+    increment(numBlocks, 1);
+    increment(totalNanoseconds, nanoseconds);
+    raiseTo(maxNanoseconds, nanoseconds);
+
+    if (idle)
+        increment(numIdleBlocks, 1);
+
+    for (size_t stage = 0; stage < stageNanoseconds.size(); ++stage)
+        increment(stageTotals[stage], stageNanoseconds[stage]);
+
+    // The callback should come exactly one block of audio after the previous one
+    if (lastBlockDuration > 0) {
+        const auto interval = static_cast<int64_t>(toNanoseconds(start - lastBlockStart));
+        const auto deviation = static_cast<uint64_t>(std::abs(interval - static_cast<int64_t>(lastBlockDuration)));
+        jitter.record(deviation);
+        raiseTo(maxJitterNanoseconds, deviation);
+    }
+
+    lastBlockStart = start;
+    lastBlockDuration = static_cast<uint64_t>(numSamples * 1.0e9 / sampleRate);
+}
+
+PerformanceMonitor::Percentiles PerformanceMonitor::getPercentiles(const Histogram& histogram, uint64_t maxNanoseconds)
+{
+    std::array<uint32_t, Histogram::numBuckets> counts;
+    uint64_t total = 0;
+
+    for (int bucket = 0; bucket < Histogram::numBuckets; ++bucket)
+        total += (counts[static_cast<size_t>(bucket)] = histogram.getCount(bucket));
+
+    Percentiles percentiles;
+    percentiles.max = toMicroseconds(maxNanoseconds);
+
+    if (total == 0)
+        return percentiles;
+
+    // Report the top of the bucket holding each rank, capped at the exact maximum
+    const auto valueAt = [&](double fraction)
+    {
+        const auto rank = static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(total)));
+        uint64_t seen = 0;
+
+        for (int bucket = 0; bucket < Histogram::numBuckets; ++bucket) {
+            seen += counts[static_cast<size_t>(bucket)];
+
+            if (seen >= juce::jmax<uint64_t>(1, rank))
+                return toMicroseconds(juce::jmin(Histogram::getBucketUpperBound(bucket), maxNanoseconds));
+        }
+
+        return percentiles.max;
+    };
+
+    percentiles.median = valueAt(0.5);
+    percentiles.p99 = valueAt(0.99);
+    percentiles.p999 = valueAt(0.999);
+    return percentiles;
+}
+
+PerformanceMonitor::Stats PerformanceMonitor::getStats() const
+{
+    Stats stats;
+    stats.load = loadMeasurer.getLoadAsProportion();
+    stats.deadlineMisses = loadMeasurer.getXRunCount();
+    stats.numBlocks = numBlocks.load(std::memory_order_relaxed);
+    stats.numIdleBlocks = numIdleBlocks.load(std::memory_order_relaxed);
+    stats.budgetMicroseconds = blockSize * 1.0e6 / sampleRate;
+    stats.blockTime = getPercentiles(blockTimes, maxNanoseconds.load(std::memory_order_relaxed));
+    stats.callbackJitter = getPercentiles(jitter, maxJitterNanoseconds.load(std::memory_order_relaxed));
+
+    if (stats.numBlocks > 0) {
+        const auto blocks = static_cast<double>(stats.numBlocks);
+        stats.meanBlockMicroseconds = toMicroseconds(totalNanoseconds.load(std::memory_order_relaxed)) / blocks;
+
+        for (size_t stage = 0; stage < stageTotals.size(); ++stage)
+            stats.meanStageMicroseconds[stage] = toMicroseconds(stageTotals[stage].load(std::memory_order_relaxed)) / blocks;
+    }
+
+    return stats;
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Audio thread performance counters for one processor: the load and deadline
+// misses from juce::AudioProcessLoadMeasurer, plus histograms of how long each
+// block took and how far each callback strayed from the expected interval,
+// and the time spent in each effect stage. The audio thread only does relaxed
+// atomic stores, so a control thread can take a snapshot at any time.
+class PerformanceMonitor
+{
+public:
+    enum Stage
+    {
+        parametersStage,    // queued changes and parameter ramps
+        scratchStage,
+        pitchShiftStage,
+        eqStage,
+        flangerStage,
+        filterStage,
+        volumeStage,
+        meteringStage,
+        numStages
+    };
+
+    static const char* getStageName(int stage);
+
+    // Log-linear buckets in the style of an HDR histogram: values below
+    // subBucketCount nanoseconds get a bucket each, then every doubling is
+    // split into subBucketCount buckets, so any value is within about 6%.
+    class Histogram
+    {
+    public:
+        static constexpr int subBucketBits = 4;
+        static constexpr int subBucketCount = 1 << subBucketBits;
+        static constexpr int numBuckets = subBucketCount * 32; // up to ~34 s
+
+        static int getBucket(uint64_t nanoseconds) noexcept;
+        static uint64_t getBucketLowerBound(int bucket) noexcept;
+        static uint64_t getBucketUpperBound(int bucket) noexcept { return getBucketLowerBound(bucket + 1) - 1; }
+
+        // Single writer
+        void record(uint64_t nanoseconds) noexcept;
+        void clear() noexcept;
+
+        uint32_t getCount(int bucket) const noexcept { return counts[static_cast<size_t>(bucket)].load(std::memory_order_relaxed); }
+
+    private:
+        std::array<std::atomic<uint32_t>, numBuckets> counts {};
+    };
+
+    struct Percentiles
+    {
+        double median = 0.0;    // all in microseconds
+        double p99 = 0.0;
+        double p999 = 0.0;
+        double max = 0.0;
+    };
+
+    struct Stats
+    {
+        double load = 0.0;                  // smoothed share of the real-time budget, 0-1
+        int deadlineMisses = 0;             // blocks that took longer than they last
+        uint64_t numBlocks = 0;
+        uint64_t numIdleBlocks = 0;         // skipped as silent once the effect tails had decayed
+        double budgetMicroseconds = 0.0;    // duration of a prepared block of audio
+        double meanBlockMicroseconds = 0.0;
+        Percentiles blockTime;
+        Percentiles callbackJitter;         // |interval between blocks - block duration|
+        std::array<double, numStages> meanStageMicroseconds {};
+    };
+
+    // Control thread, while no audio is running
+    void prepare(double sampleRate, int maximumBlockSize);
+
+    // Starts all counters over from the next block - any control thread
+    void reset() noexcept;
+
+    // Times one processBlock call. Mark the end of each stage with
+    // finishStage(); the rest is recorded when the timer goes out of scope.
+    class ScopedBlockTimer
+    {
+    public:
+        ScopedBlockTimer(PerformanceMonitor& owner, int numSamples) noexcept;
+        ~ScopedBlockTimer();
+
+        void finishStage(Stage stage) noexcept;
+
+        // Counts the block as idle - its stages were skipped
+        void setIdle() noexcept { idle = true; }
+
+    private:
+        PerformanceMonitor& monitor;
+        const int numSamples;
+        const std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point lastMark;
+        std::array<uint64_t, numStages> stageNanoseconds {};
+        bool idle = false;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedBlockTimer)
+    };
+
+    // Any control thread. Percentiles are read from the histograms, so they are
+    // accurate to a bucket; a snapshot taken mid-block may lag by that block.
+    Stats getStats() const;
+
+    const Histogram& getBlockTimeHistogram() const noexcept { return blockTimes; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void finishBlock(Clock::time_point start, Clock::time_point end, int numSamples,
+                     const std::array<uint64_t, numStages>& stageNanoseconds, bool idle) noexcept;
+    void clearIfRequested() noexcept;
+
+    static Percentiles getPercentiles(const Histogram& histogram, uint64_t maxNanoseconds);
+
+    juce::AudioProcessLoadMeasurer loadMeasurer;
+    double sampleRate = 44100.0;
+    int blockSize = 512;
+
+    Histogram blockTimes;
+    Histogram jitter;
+    std::atomic<uint64_t> numBlocks { 0 };
+    std::atomic<uint64_t> numIdleBlocks { 0 };
+    std::atomic<uint64_t> totalNanoseconds { 0 };
+    std::atomic<uint64_t> maxNanoseconds { 0 };
+    std::atomic<uint64_t> maxJitterNanoseconds { 0 };
+    std::array<std::atomic<uint64_t>, numStages> stageTotals {};
+
+    // Audio thread only
+    Clock::time_point lastBlockStart;
+    uint64_t lastBlockDuration = 0;
+
+    std::atomic<bool> resetRequested { false };
+};
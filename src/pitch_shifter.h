@@ -0,0 +1,437 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+#include <vector>
+
+// Granular pitch shifter in the style of the juce::dsp processors. Overlapping
+// Hann-windowed read heads sweep through a delay line at the pitch ratio, which
+// changes the pitch without changing the duration. Above the fast quality every
+// new grain is aligned with the waveform of the grain it fades into (WSOLA),
+// which avoids cancellation and most of the phasiness on tonal material.
+//
+// The latency is constant for a given quality and sample rate. At a ratio of 1
+// the grains are crossfaded out in favour of a plain tap at the same delay, so
+// unity pitch is transparent apart from the latency.
+
+// Shared by every sample type, so float and double shifters take the same setting
+enum class PitchShifterQuality
+{
+    fast,   // 2 grains, linear interpolation
+    normal, // 2 waveform-aligned grains, cubic interpolation
+    high    // 4 longer waveform-aligned grains, cubic interpolation
+};
+
+template <typename SampleType>
+class PitchShifter
+{
+public:
+    using Quality = PitchShifterQuality;
+    using Vector = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr int numLanes = static_cast<int>(Vector::size());
+
+    // Changing the quality restarts the grains, so it may click while playing
+    void setQuality(Quality newQuality) noexcept
+    {
+        quality = newQuality;
+        updateGrainLayout();
+        reset();
+    }
+
+    Quality getQuality() const noexcept { return quality; }
+
+    // Pitch ratio, e.g. 2 for an octave up - cheap enough to call per sub-block
+    void setPitchRatio(SampleType newRatio) noexcept
+    {
+        ratio = newRatio;
+        phaseIncrement = (SampleType(1) - ratio) / static_cast<SampleType>(grainSize);
+        shiftMix.setTargetValue(ratio != SampleType(1) ? SampleType(1) : SampleType(0));
+    }
+
+    int getLatencySamples() const noexcept { return latency; }
+
+    static int getLatencySamples(Quality qualityToUse, double sampleRate) noexcept
+    {
+        return minimumDelay + (getGrainSize(qualityToUse, sampleRate) + getSearchRange(qualityToUse, sampleRate)) / 2;
+    }
+
+    // Longest delay any grain reads from, plus the interpolation taps - how long
+    // sound keeps coming out after the input has gone silent
+    static int getTailSamples(Quality qualityToUse, double sampleRate) noexcept
+    {
+        return minimumDelay + getGrainSize(qualityToUse, sampleRate) + getSearchRange(qualityToUse, sampleRate) + 4;
+    }
+
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        sampleRate = spec.sampleRate;
+        maximumBlockSize = static_cast<int>(spec.maximumBlockSize);
+
+        // Sized for the highest quality, so switching quality never allocates
+        const int longestDelay = minimumDelay + getGrainSize(Quality::high, sampleRate)
+                               + getSearchRange(Quality::high, sampleRate) + alignLength + 4;
+        const int historySize = juce::nextPowerOfTwo(longestDelay + maximumBlockSize);
+
+        history.setSize(static_cast<int>(spec.numChannels), historySize);
+        historyMask = static_cast<size_t>(historySize - 1);
+
+        delays.resize(static_cast<size_t>(maximumBlockSize));
+        gains.resize(static_cast<size_t>(maximumBlockSize));
+        mixGains.resize(static_cast<size_t>(maximumBlockSize));
+        dryGains.resize(static_cast<size_t>(maximumBlockSize));
+        grainSamples.resize(static_cast<size_t>(maximumBlockSize));
+
+        const auto numVectors = static_cast<size_t>((maximumBlockSize + numLanes - 1) / numLanes);
+
+        for (auto* taps : { &previousTaps, &currentTaps, &nextTaps, &followingTaps, &fractions, &interpolated })
+            taps->resize(numVectors);
+
+        referenceSegment.resize(static_cast<size_t>(alignLength));
+        searchSegment.resize(static_cast<size_t>(alignLength + getSearchRange(Quality::high, sampleRate)));
+        correlations.resize(static_cast<size_t>(getSearchRange(Quality::high, sampleRate) + 1));
+
+        for (int i = 0; i <= windowTableSize; ++i)
+            windowTable[i] = static_cast<SampleType>(0.5 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * i / windowTableSize));
+
+        shiftMix.reset(sampleRate, 0.05);
+        updateGrainLayout();
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        history.clear();
+        writePosition = 0;
+
+        for (int grain = 0; grain < maxGrains; ++grain) {
+            phases[grain] = (static_cast<SampleType>(grain) + SampleType(0.5)) / static_cast<SampleType>(numGrains);
+            offsets[grain] = 0;
+        }
+
+        shiftMix.setCurrentAndTargetValue(shiftMix.getTargetValue());
+    }
+
+    template <typename ProcessContext>
+    void process(const ProcessContext& context) noexcept
+    {
+        const auto& inputBlock = context.getInputBlock();
+        auto& outputBlock = context.getOutputBlock();
+        const auto numSamples = outputBlock.getNumSamples();
+
+        jassert(inputBlock.getNumChannels() == outputBlock.getNumChannels());
+        jassert(inputBlock.getNumSamples() == numSamples);
+        jassert(outputBlock.getNumChannels() <= static_cast<size_t>(history.getNumChannels()));
+
+        if (context.isBypassed) {
+            outputBlock.copyFrom(inputBlock);
+            return;
+        }
+
+        for (size_t start = 0; start < numSamples; start += static_cast<size_t>(maximumBlockSize)) {
+            const auto length = juce::jmin(static_cast<size_t>(maximumBlockSize), numSamples - start);
+            auto output = outputBlock.getSubBlock(start, length);
+            processChunk(inputBlock.getSubBlock(start, length), output, static_cast<int>(length));
+        }
+    }
+
+private:
+    static constexpr int maxGrains = 4;
+    static constexpr int minimumDelay = 2; // keeps cubic interpolation on samples already written
+    static constexpr int windowTableSize = 1024;
+    static constexpr int alignLength = 256;
+
+    static int getNumGrains(Quality qualityToUse) noexcept { return qualityToUse == Quality::high ? 4 : 2; }
+
+    static int getGrainSize(Quality qualityToUse, double rate) noexcept
+    {
+        const double seconds = qualityToUse == Quality::fast ? 0.025 : qualityToUse == Quality::normal ? 0.03 : 0.05;
+        return juce::roundToInt(seconds * rate);
+    }
+
+    // How far a new grain may be moved to line up with the one it fades into
+    static int getSearchRange(Quality qualityToUse, double rate) noexcept
+    {
+        return qualityToUse == Quality::fast ? 0 : getGrainSize(qualityToUse, rate) / 4;
+    }
+
+    void updateGrainLayout() noexcept
+    {
+        numGrains = getNumGrains(quality);
+        grainSize = getGrainSize(quality, sampleRate);
+        searchRange = getSearchRange(quality, sampleRate);
+        latency = getLatencySamples(quality, sampleRate);
+
+        // Equally spaced Hann windows add up to numGrains / 2
+        normalisation = SampleType(2) / static_cast<SampleType>(numGrains);
+        phaseIncrement = (SampleType(1) - ratio) / static_cast<SampleType>(grainSize);
+    }
+
+    SampleType getWindow(SampleType phase) const noexcept
+    {
+        const SampleType position = phase * static_cast<SampleType>(windowTableSize);
+        const int index = juce::jlimit(0, windowTableSize - 1, static_cast<int>(position));
+        const SampleType fraction = position - static_cast<SampleType>(index);
+        return windowTable[index] + fraction * (windowTable[index + 1] - windowTable[index]);
+    }
+
+    void processChunk(const juce::dsp::AudioBlock<const SampleType>& input,
+                      juce::dsp::AudioBlock<SampleType>& output,
+                      int numSamples) noexcept
+    {
+        const int numChannels = static_cast<int>(output.getNumChannels());
+        const int historySize = history.getNumSamples();
+
+        // Write the input first - the output may share its memory
+        for (int channel = 0; channel < numChannels; ++channel) {
+            const auto* source = input.getChannelPointer(static_cast<size_t>(channel));
+            auto* destination = history.getWritePointer(channel);
+            const int start = static_cast<int>(writePosition & historyMask);
+            const int firstPart = juce::jmin(numSamples, historySize - start);
+
+            juce::FloatVectorOperations::copy(destination + start, source, firstPart);
+            juce::FloatVectorOperations::copy(destination, source + firstPart, numSamples - firstPart);
+        }
+
+        const bool mixRamping = shiftMix.isSmoothing();
+        const SampleType mix = shiftMix.getCurrentValue();
+
+        if (mixRamping) {
+            for (int i = 0; i < numSamples; ++i) {
+                mixGains[static_cast<size_t>(i)] = shiftMix.getNextValue();
+                dryGains[static_cast<size_t>(i)] = SampleType(1) - mixGains[static_cast<size_t>(i)];
+            }
+        }
+
+        output.clear();
+
+        if (mixRamping || mix > SampleType(0)) {
+            for (int grain = 0; grain < numGrains; ++grain) {
+                computeGrainCurves(grain, numSamples);
+
+                if (mixRamping)
+                    juce::FloatVectorOperations::multiply(gains.data(), mixGains.data(), numSamples);
+
+                for (int channel = 0; channel < numChannels; ++channel) {
+                    readGrain(channel, numSamples);
+                    juce::FloatVectorOperations::addWithMultiply(output.getChannelPointer(static_cast<size_t>(channel)),
+                                                                 grainSamples.data(), gains.data(), numSamples);
+                }
+            }
+        }
+
+        if (mixRamping || mix < SampleType(1)) {
+            for (int channel = 0; channel < numChannels; ++channel) {
+                const auto* samples = history.getReadPointer(channel);
+                const size_t start = writePosition - static_cast<size_t>(latency);
+
+                for (int i = 0; i < numSamples; ++i)
+                    grainSamples[static_cast<size_t>(i)] = samples[(start + static_cast<size_t>(i)) & historyMask];
+
+                auto* destination = output.getChannelPointer(static_cast<size_t>(channel));
+
+                if (mixRamping)
+                    juce::FloatVectorOperations::addWithMultiply(destination, grainSamples.data(), dryGains.data(), numSamples);
+                else
+                    juce::FloatVectorOperations::addWithMultiply(destination, grainSamples.data(), SampleType(1) - mix, numSamples);
+            }
+        }
+
+        writePosition += static_cast<size_t>(numSamples);
+    }
+
+    // Fills delays and gains for one grain over the chunk and advances its phase.
+    // The delay and window only depend on the phase, so they are shared by all channels.
+    void computeGrainCurves(int grain, int numSamples) noexcept
+    {
+        auto& phase = phases[grain];
+        const auto size = static_cast<SampleType>(grainSize);
+        int done = 0;
+
+        while (done < numSamples) {
+            // Samples until the phase wraps and the grain restarts
+            int length = numSamples - done;
+
+            if (phaseIncrement < SampleType(0))
+                length = juce::jmin(length, static_cast<int>(std::ceil(phase / -phaseIncrement)));
+            else if (phaseIncrement > SampleType(0))
+                length = juce::jmin(length, static_cast<int>(std::ceil((SampleType(1) - phase) / phaseIncrement)));
+
+            length = juce::jmax(1, length);
+
+            const SampleType baseDelay = static_cast<SampleType>(minimumDelay) + offsets[grain];
+
+            for (int i = 0; i < length; ++i) {
+                const SampleType p = juce::jlimit(SampleType(0), SampleType(1), phase + phaseIncrement * static_cast<SampleType>(i));
+                delays[static_cast<size_t>(done + i)] = baseDelay + p * size;
+                gains[static_cast<size_t>(done + i)] = getWindow(p) * normalisation;
+            }
+
+            phase += phaseIncrement * static_cast<SampleType>(length);
+            done += length;
+
+            if (phase < SampleType(0) || phase >= SampleType(1)) {
+                phase -= std::floor(phase);
+                offsets[grain] = searchRange > 0 ? findAlignedOffset(grain, writePosition + static_cast<size_t>(done))
+                                                 : SampleType(0);
+            }
+        }
+    }
+
+    // Reads one channel of the current grain into grainSamples. The taps are
+    // gathered from the delay line first, then interpolated a register at a time.
+    void readGrain(int channel, int numSamples) noexcept
+    {
+        const auto* samples = history.getReadPointer(channel);
+        const auto historySize = static_cast<SampleType>(history.getNumSamples());
+        const bool cubic = quality != Quality::fast;
+
+        auto* previous = reinterpret_cast<SampleType*>(previousTaps.data());
+        auto* current = reinterpret_cast<SampleType*>(currentTaps.data());
+        auto* next = reinterpret_cast<SampleType*>(nextTaps.data());
+        auto* following = reinterpret_cast<SampleType*>(followingTaps.data());
+        auto* fraction = reinterpret_cast<SampleType*>(fractions.data());
+
+        for (int i = 0; i < numSamples; ++i) {
+            SampleType position = static_cast<SampleType>((writePosition + static_cast<size_t>(i)) & historyMask)
+                                - delays[static_cast<size_t>(i)];
+
+            if (position < SampleType(0))
+                position += historySize;
+
+            const auto index = static_cast<size_t>(position);
+            fraction[i] = position - static_cast<SampleType>(index);
+            current[i] = samples[index & historyMask];
+            next[i] = samples[(index + 1) & historyMask];
+
+            if (cubic) {
+                previous[i] = samples[(index - 1) & historyMask];
+                following[i] = samples[(index + 2) & historyMask];
+            }
+        }
+
+        const int numVectors = (numSamples + numLanes - 1) / numLanes;
+
+        if (cubic) {
+            const auto half = Vector::expand(SampleType(0.5));
+            const auto oneAndHalf = Vector::expand(SampleType(1.5));
+            const auto two = Vector::expand(SampleType(2));
+            const auto twoAndHalf = Vector::expand(SampleType(2.5));
+
+            for (int v = 0; v < numVectors; ++v) {
+                const auto xm1 = previousTaps[static_cast<size_t>(v)];
+                const auto x0 = currentTaps[static_cast<size_t>(v)];
+                const auto x1 = nextTaps[static_cast<size_t>(v)];
+                const auto x2 = followingTaps[static_cast<size_t>(v)];
+                const auto t = fractions[static_cast<size_t>(v)];
+                const auto c1 = half * (x1 - xm1);
+                const auto c2 = xm1 - twoAndHalf * x0 + two * x1 - half * x2;
+                const auto c3 = half * (x2 - xm1) + oneAndHalf * (x0 - x1);
+                interpolated[static_cast<size_t>(v)] = ((c3 * t + c2) * t + c1) * t + x0;
+            }
+        } else {
+            for (int v = 0; v < numVectors; ++v) {
+                const auto x0 = currentTaps[static_cast<size_t>(v)];
+                interpolated[static_cast<size_t>(v)] = x0 + fractions[static_cast<size_t>(v)] * (nextTaps[static_cast<size_t>(v)] - x0);
+            }
+        }
+
+        juce::FloatVectorOperations::copy(grainSamples.data(), reinterpret_cast<const SampleType*>(interpolated.data()), numSamples);
+    }
+
+    // Picks the start offset for a restarting grain whose recent past best
+    // matches that of the loudest grain, searched on the first channel
+    SampleType findAlignedOffset(int grain, size_t time) noexcept
+    {
+        int reference = -1;
+        SampleType loudest = SampleType(0);
+
+        for (int other = 0; other < numGrains; ++other) {
+            const SampleType window = getWindow(phases[other]);
+
+            if (other != grain && window > loudest) {
+                loudest = window;
+                reference = other;
+            }
+        }
+
+        if (reference < 0)
+            return SampleType(0);
+
+        const auto* samples = history.getReadPointer(0);
+        const auto referenceDelay = static_cast<size_t>(minimumDelay + offsets[reference] + phases[reference] * static_cast<SampleType>(grainSize));
+        const auto newestDelay = static_cast<size_t>(minimumDelay + searchRange + phases[grain] * static_cast<SampleType>(grainSize));
+        const size_t referenceStart = time - referenceDelay - static_cast<size_t>(alignLength);
+        const size_t searchStart = time - newestDelay - static_cast<size_t>(alignLength);
+
+        for (int i = 0; i < alignLength; ++i)
+            referenceSegment[static_cast<size_t>(i)] = samples[(referenceStart + static_cast<size_t>(i)) & historyMask];
+
+        for (int i = 0; i < alignLength + searchRange; ++i)
+            searchSegment[static_cast<size_t>(i)] = samples[(searchStart + static_cast<size_t>(i)) & historyMask];
+
+        // Correlations for every start in the search segment at once: one
+        // vectorised multiply-add per reference sample, across all the starts
+        const int numStarts = searchRange + 1;
+        juce::FloatVectorOperations::clear(correlations.data(), numStarts);
+
+        for (int i = 0; i < alignLength; ++i)
+            juce::FloatVectorOperations::addWithMultiply(correlations.data(), searchSegment.data() + i,
+                                                         referenceSegment[static_cast<size_t>(i)], numStarts);
+
+        // The energy of each candidate slides along with its start, so it is
+        // updated by the sample entering and the one leaving the window
+        SampleType energy = SampleType(0);
+
+        for (int i = searchRange; i < searchRange + alignLength; ++i)
+            energy += searchSegment[static_cast<size_t>(i)] * searchSegment[static_cast<size_t>(i)];
+
+        int bestOffset = 0;
+        SampleType bestScore = std::numeric_limits<SampleType>::lowest();
+
+        for (int offset = 0; offset <= searchRange; ++offset) {
+            const int start = searchRange - offset;
+
+            if (offset > 0) {
+                const auto entering = searchSegment[static_cast<size_t>(start)];
+                const auto leaving = searchSegment[static_cast<size_t>(start + alignLength)];
+                energy = juce::jmax(SampleType(0), energy + entering * entering - leaving * leaving);
+            }
+
+            const SampleType score = correlations[static_cast<size_t>(start)] / std::sqrt(energy + SampleType(1.0e-9));
+
+            if (score > bestScore) {
+                bestScore = score;
+                bestOffset = offset;
+            }
+        }
+
+        return static_cast<SampleType>(bestOffset);
+    }
+
+    Quality quality = Quality::normal;
+    double sampleRate = 44100.0;
+    int maximumBlockSize = 512;
+    int numGrains = 4;
+    int grainSize = 1764;
+    int searchRange = 0;
+    int latency = 0;
+    SampleType normalisation = SampleType(0.5);
+    SampleType ratio = SampleType(1);
+    SampleType phaseIncrement = SampleType(0);
+
+    juce::AudioBuffer<SampleType> history;
+    size_t historyMask = 0;
+    size_t writePosition = 0;
+
+    SampleType phases[maxGrains] {};
+    SampleType offsets[maxGrains] {};
+    SampleType windowTable[windowTableSize + 1] {};
+    juce::SmoothedValue<SampleType> shiftMix { SampleType(0) };
+
+    // Scratch space, sized in prepare()
+    std::vector<SampleType> delays, gains, mixGains, dryGains, grainSamples;
+    std::vector<SampleType> referenceSegment, searchSegment, correlations;
+
+    // Interpolation taps and results, in registers so they stay aligned
+    std::vector<Vector> previousTaps, currentTaps, nextTaps, followingTaps, fractions, interpolated;
+};
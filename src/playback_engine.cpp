@@ -0,0 +1,187 @@
+#include "playback_engine.h"
+#include "null_audio_device.h"
+
+PlaybackEngine::PlaybackEngine(juce::AudioProcessor& processorToPlay)
+    : processor(processorToPlay)
+{
+    // Make sure the platform's own device types exist before adding ours,
+    // otherwise the device manager would skip creating them
+    deviceManager.getAvailableDeviceTypes();
+    deviceManager.addAudioDeviceType(std::make_unique<NullAudioIODeviceType>());
+}
+
+PlaybackEngine::~PlaybackEngine()
+{
+    stop();
+}
+
+juce::AudioIODeviceType* PlaybackEngine::findDeviceType(const juce::String& typeName)
+{
+    const auto& types = deviceManager.getAvailableDeviceTypes();
+
+    if (typeName.isEmpty()) {
+        // Prefer the first hardware type that actually has a device
+        for (auto* type : types) {
+            type->scanForDevices();
+
+            if (type->getTypeName() != NullAudioIODeviceType::typeName && !type->getDeviceNames(false).isEmpty())
+                return type;
+        }
+
+        return nullptr;
+    }
+
+    for (auto* type : types)
+        if (type->getTypeName().equalsIgnoreCase(typeName))
+            return type;
+
+    return nullptr;
+}
+
+juce::String PlaybackEngine::start(const Options& options)
+{
+    stop();
+
+    auto* type = findDeviceType(options.deviceType);
+
+    if (type == nullptr)
+        return options.deviceType.isEmpty() ? juce::String("No audio device found")
+                                            : "Unknown audio device type: " + options.deviceType;
+
+    deviceManager.setCurrentAudioDeviceType(type->getTypeName(), false);
+    type->scanForDevices();
+
+    const auto outputNames = type->getDeviceNames(false);
+    const auto inputNames = type->getDeviceNames(true);
+
+    auto setup = deviceManager.getAudioDeviceSetup();
+    setup.outputDeviceName = options.outputDeviceName.isNotEmpty() ? options.outputDeviceName
+                                                                    : outputNames[type->getDefaultDeviceIndex(false)];
+    setup.inputDeviceName = options.numInputChannels <= 0 ? juce::String()
+                          : options.inputDeviceName.isNotEmpty() ? options.inputDeviceName
+                                                                 : inputNames[type->getDefaultDeviceIndex(true)];
+    setup.sampleRate = options.sampleRate;
+    setup.bufferSize = options.bufferSize;
+    setup.useDefaultInputChannels = false;
+    setup.useDefaultOutputChannels = false;
+    setup.inputChannels.clear();
+    setup.inputChannels.setRange(0, juce::jmax(0, options.numInputChannels), true);
+    setup.outputChannels.clear();
+    setup.outputChannels.setRange(0, juce::jmax(0, options.numOutputChannels), true);
+
+    auto error = deviceManager.setAudioDeviceSetup(setup, false);
+
+    if (error.isEmpty() && deviceManager.getCurrentAudioDevice() == nullptr)
+        error = "Could not open audio device " + setup.outputDeviceName;
+
+    if (error.isNotEmpty()) {
+        deviceManager.closeAudioDevice();
+        return error;
+    }
+
+    player.setProcessor(&processor);
+    deviceManager.addAudioCallback(this);
+    running = true;
+
+    return {};
+}
+
+void PlaybackEngine::stop()
+{
+    if (!running)
+        return;
+
+    deviceManager.removeAudioCallback(this);
+    deviceManager.closeAudioDevice();
+    player.setProcessor(nullptr);
+    running = false;
+
+    for (auto& peak : outputPeaks)
+        peak.store(0.0f);
+}
+
+bool PlaybackEngine::isRunning() const
+{
+    return running;
+}
+
+juce::AudioIODevice* PlaybackEngine::getCurrentDevice() const
+{
+    return deviceManager.getCurrentAudioDevice();
+}
+
+juce::StringArray PlaybackEngine::getDeviceTypeNames()
+{
+    juce::StringArray names;
+
+    for (auto* type : deviceManager.getAvailableDeviceTypes())
+        names.add(type->getTypeName());
+
+    return names;
+}
+
+juce::StringArray PlaybackEngine::getDeviceNames(const juce::String& typeName, bool wantInputNames)
+{
+    for (auto* type : deviceManager.getAvailableDeviceTypes()) {
+        if (type->getTypeName().equalsIgnoreCase(typeName)) {
+            type->scanForDevices();
+            return type->getDeviceNames(wantInputNames);
+        }
+    }
+
+    return {};
+}
+
+float PlaybackEngine::getOutputPeak(int channel)
+{
+    if (!juce::isPositiveAndBelow(channel, maxMeterChannels))
+        return 0.0f;
+
+    return outputPeaks[channel].exchange(0.0f);
+}
+
+double PlaybackEngine::getCpuUsage() const
+{
+    return deviceManager.getCpuUsage();
+}
+
+int PlaybackEngine::getXRunCount() const
+{
+    if (auto* device = deviceManager.getCurrentAudioDevice())
+        return device->getXRunCount();
+
+    return 0;
+}
+
+void PlaybackEngine::audioDeviceIOCallbackWithContext(const float* const* inputChannelData,
+                                                      int numInputChannels,
+                                                      float* const* outputChannelData,
+                                                      int numOutputChannels,
+                                                      int numSamples,
+                                                      const juce::AudioIODeviceCallbackContext& context)
+{
+    player.audioDeviceIOCallbackWithContext(inputChannelData, numInputChannels,
+                                            outputChannelData, numOutputChannels,
+                                            numSamples, context);
+
+    for (int channel = 0; channel < juce::jmin(numOutputChannels, maxMeterChannels); ++channel) {
+        if (outputChannelData[channel] == nullptr)
+            continue;
+
+        const auto range = juce::FloatVectorOperations::findMinAndMax(outputChannelData[channel], numSamples);
+        const float peak = juce::jmax(-range.getStart(), range.getEnd());
+        float held = outputPeaks[channel].load(std::memory_order_relaxed);
+
+        while (peak > held && !outputPeaks[channel].compare_exchange_weak(held, peak)) {}
+    }
+}
+
+void PlaybackEngine::audioDeviceAboutToStart(juce::AudioIODevice* device)
+{
+    player.audioDeviceAboutToStart(device);
+}
+
+void PlaybackEngine::audioDeviceStopped()
+{
+    player.audioDeviceStopped();
+}
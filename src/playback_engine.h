@@ -0,0 +1,61 @@
+#pragma once
+
+#include <juce_audio_devices/juce_audio_devices.h>
+#include <juce_audio_utils/juce_audio_utils.h>
+
+// Hosts a processor in an AudioProcessorPlayer attached to a native audio
+// device, so the whole effect chain runs on the device's real-time callback
+// thread. The JS side only sends parameter changes and polls the meters.
+class PlaybackEngine : private juce::AudioIODeviceCallback
+{
+public:
+    struct Options
+    {
+        juce::String deviceType;       // e.g. "ALSA", "JACK" or "Null" - empty picks the default type
+        juce::String outputDeviceName; // empty picks the type's default device
+        juce::String inputDeviceName;
+        double sampleRate = 0.0;       // 0 keeps the device's default
+        int bufferSize = 0;
+        int numInputChannels = 2;
+        int numOutputChannels = 2;
+    };
+
+    static constexpr int maxMeterChannels = 8;
+
+    explicit PlaybackEngine(juce::AudioProcessor& processorToPlay);
+    ~PlaybackEngine() override;
+
+    // Opens the device and starts playing. Returns an error message on failure.
+    juce::String start(const Options& options);
+    void stop();
+    bool isRunning() const;
+
+    juce::AudioIODevice* getCurrentDevice() const;
+    juce::StringArray getDeviceTypeNames();
+    juce::StringArray getDeviceNames(const juce::String& typeName, bool wantInputNames);
+
+    // Output peak of a channel since the previous call, held until it is read
+    float getOutputPeak(int channel);
+    double getCpuUsage() const;
+    int getXRunCount() const;
+
+private:
+    void audioDeviceIOCallbackWithContext(const float* const* inputChannelData,
+                                          int numInputChannels,
+                                          float* const* outputChannelData,
+                                          int numOutputChannels,
+                                          int numSamples,
+                                          const juce::AudioIODeviceCallbackContext& context) override;
+    void audioDeviceAboutToStart(juce::AudioIODevice* device) override;
+    void audioDeviceStopped() override;
+
+    juce::AudioIODeviceType* findDeviceType(const juce::String& typeName);
+
+    juce::AudioProcessor& processor;
+    juce::AudioDeviceManager deviceManager;
+    juce::AudioProcessorPlayer player;
+    std::atomic<float> outputPeaks[maxMeterChannels] {};
+    bool running = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PlaybackEngine)
+};
@@ -0,0 +1,79 @@
+#include "processing_queue.h"
+
+ProcessingQueue::ProcessingQueue()
+    : ProcessingQueue(getSharedPool())
+{
+}
+
+ProcessingQueue::ProcessingQueue(juce::ThreadPool& poolToUse)
+    : pool(poolToUse)
+{
+    idleEvent.signal();
+}
+
+ProcessingQueue::~ProcessingQueue()
+{
+    waitUntilIdle();
+
+    // Make sure the drain job has left the lock before it is destroyed
+    const juce::ScopedLock sl(lock);
+}
+
+juce::ThreadPool& ProcessingQueue::getSharedPool()
+{
+    static juce::ThreadPool sharedPool(juce::ThreadPoolOptions{}
+                                           .withThreadName("JUCE Audio Processing")
+                                           .withNumberOfThreads(juce::jmax(1, juce::SystemStats::getNumCpus())));
+    return sharedPool;
+}
+
+void ProcessingQueue::enqueue(Task task)
+{
+    const juce::ScopedLock sl(lock);
+
+    tasks.push_back(std::move(task));
+    ++numOutstanding;
+    idleEvent.reset();
+
+    // Only one drain job per queue, which is what keeps the tasks in order
+    if (!drainScheduled) {
+        drainScheduled = true;
+        pool.addJob([this] { drain(); });
+    }
+}
+
+bool ProcessingQueue::isBusy() const
+{
+    return numOutstanding.load() > 0;
+}
+
+void ProcessingQueue::waitUntilIdle()
+{
+    idleEvent.wait();
+}
+
+void ProcessingQueue::drain()
+{
+    for (;;) {
+        Task task;
+
+        {
+            const juce::ScopedLock sl(lock);
+
+            if (tasks.empty()) {
+                drainScheduled = false;
+
+                if (numOutstanding.load() == 0)
+                    idleEvent.signal();
+
+                return;
+            }
+
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+
+        task();
+        --numOutstanding;
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <deque>
+#include <functional>
+
+// Runs tasks for a single processor strictly in order on a shared, bounded
+// juce::ThreadPool. Each queue has at most one job on the pool at a time, so
+// the blocks of one instance stay sequential while separate instances are
+// spread across the pool's threads.
+class ProcessingQueue
+{
+public:
+    using Task = std::function<void()>;
+
+    ProcessingQueue();
+    explicit ProcessingQueue(juce::ThreadPool& poolToUse);
+    ~ProcessingQueue();
+
+    void enqueue(Task task);
+
+    // True while tasks are queued or running
+    bool isBusy() const;
+    void waitUntilIdle();
+
+    // One pool for the whole addon, sized to the number of CPU cores
+    static juce::ThreadPool& getSharedPool();
+
+private:
+    void drain();
+
+    juce::ThreadPool& pool;
+    juce::CriticalSection lock;
+    std::deque<Task> tasks;
+    bool drainScheduled = false;
+    std::atomic<int> numOutstanding { 0 };
+    juce::WaitableEvent idleEvent { true };
+
+    JUCE_DECLARE_NON_COPYABLE(ProcessingQueue)
+};
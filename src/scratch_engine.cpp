@@ -0,0 +1,227 @@
+#include "scratch_engine.h"
+
+namespace
+{
+    // The playhead catches up with the platter over this time, and its speed
+    // glides over the shorter one - together they are slightly overdamped
+    constexpr double followSeconds = 0.01;
+    constexpr double speedSmoothingSeconds = 0.002;
+
+    // A stopped platter is silent rather than holding the current sample as DC
+    constexpr double fullVolumeSpeed = 0.05;
+
+    // Speeds up to this use Lagrange interpolation, faster ones the band-limited sinc
+    constexpr double lagrangeMaximumStep = 1.25;
+}
+
+ScratchEngine::ScratchEngine()
+{
+    // Blackman-windowed sinc, sampled from 0 to sincZeroCrossings
+    const int tableSize = sincZeroCrossings * sincTableResolution;
+
+    for (int i = 0; i <= tableSize + 1; ++i) {
+        const double x = static_cast<double>(juce::jmin(i, tableSize)) / sincTableResolution;
+        const double sinc = x == 0.0 ? 1.0 : std::sin(juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+        const double phase = juce::MathConstants<double>::pi * x / sincZeroCrossings;
+        const double window = 0.42 + 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+        sincTable[i] = i > tableSize ? 0.0f : static_cast<float>(sinc * window);
+    }
+
+    prepare(outputSampleRate);
+}
+
+ScratchEngine::~ScratchEngine() = default;
+
+void ScratchEngine::loadTrack(juce::AudioBuffer<float>&& samples, double trackSampleRate)
+{
+    auto newTrack = std::make_unique<Track>();
+    newTrack->samples = std::move(samples);
+    newTrack->sampleRate = trackSampleRate > 0.0 ? trackSampleRate : 44100.0;
+    trackLengthSeconds.store(newTrack->samples.getNumSamples() / newTrack->sampleRate);
+
+    {
+        const juce::SpinLock::ScopedLockType sl(trackLock);
+        std::swap(track, newTrack);
+        trackChanged.store(true);
+    }
+
+    // The previous track is freed here, outside the lock
+}
+
+void ScratchEngine::unloadTrack()
+{
+    std::unique_ptr<Track> oldTrack;
+
+    {
+        const juce::SpinLock::ScopedLockType sl(trackLock);
+        std::swap(track, oldTrack);
+        trackChanged.store(true);
+    }
+
+    trackLengthSeconds.store(0.0);
+}
+
+double ScratchEngine::getTrackLengthSeconds() const
+{
+    return trackLengthSeconds.load();
+}
+
+double ScratchEngine::getPositionSeconds() const
+{
+    return positionSeconds.load();
+}
+
+void ScratchEngine::prepare(double sampleRate)
+{
+    outputSampleRate = sampleRate;
+    followCoefficient = 1.0 / followSeconds;
+    rateSmoothing = 1.0 - std::exp(-1.0 / (speedSmoothingSeconds * sampleRate));
+}
+
+// A new track starts stopped at its beginning
+void ScratchEngine::handleTrackChange() noexcept
+{
+    if (!trackChanged.exchange(false))
+        return;
+
+    position = target = 0.0;
+    speed = 0.0;
+    playing = false;
+    positionSeconds.store(0.0);
+}
+
+void ScratchEngine::setPlaying(bool shouldPlay) noexcept
+{
+    playing = shouldPlay;
+}
+
+void ScratchEngine::setTouched(bool isTouched) noexcept
+{
+    // Grabbing or releasing the platter never jumps the track
+    if (isTouched != touched)
+        target = position;
+
+    touched = isTouched;
+}
+
+void ScratchEngine::setPlaybackRate(double rate) noexcept
+{
+    playbackRate = juce::jlimit(-maximumSpeed, maximumSpeed, rate);
+}
+
+void ScratchEngine::seek(double seconds) noexcept
+{
+    position = target = juce::jmax(0.0, seconds);
+}
+
+void ScratchEngine::setJogPosition(double revolutions) noexcept
+{
+    if (jogPositionKnown)
+        target += (revolutions - lastJogPosition) * secondsPerRevolution * (touched ? 1.0 : nudgeSensitivity);
+
+    lastJogPosition = revolutions;
+    jogPositionKnown = true;
+}
+
+int ScratchEngine::computeWeights(double samplePosition, double step, int& firstIndex) noexcept
+{
+    const double base = std::floor(samplePosition);
+    const auto fraction = static_cast<float>(samplePosition - base);
+
+    if (step <= lagrangeMaximumStep) {
+        // 4-point, 3rd order Lagrange around the fractional position
+        const float f = fraction;
+        weights[0] = -f * (f - 1.0f) * (f - 2.0f) / 6.0f;
+        weights[1] = (f + 1.0f) * (f - 1.0f) * (f - 2.0f) / 2.0f;
+        weights[2] = -(f + 1.0f) * f * (f - 2.0f) / 2.0f;
+        weights[3] = (f + 1.0f) * f * (f - 1.0f) / 6.0f;
+        firstIndex = static_cast<int>(base) - 1;
+        return 4;
+    }
+
+    // Stretching the sinc by the step lowers its cutoff to the new Nyquist frequency
+    const double stretch = juce::jmin(step, static_cast<double>(maximumSincStretch));
+    const double halfWidth = sincZeroCrossings * stretch;
+    firstIndex = static_cast<int>(std::floor(samplePosition - halfWidth)) + 1;
+    const int numTaps = juce::jmin(maximumTaps, static_cast<int>(std::floor(samplePosition + halfWidth)) - firstIndex + 1);
+    const double tableScale = sincTableResolution / stretch;
+    float sum = 0.0f;
+
+    for (int i = 0; i < numTaps; ++i) {
+        const double tablePosition = std::abs(firstIndex + i - samplePosition) * tableScale;
+        const int index = juce::jmin(static_cast<int>(tablePosition), sincZeroCrossings * sincTableResolution);
+        const auto tableFraction = static_cast<float>(tablePosition - index);
+        weights[i] = sincTable[index] + tableFraction * (sincTable[index + 1] - sincTable[index]);
+        sum += weights[i];
+    }
+
+    // Unity gain at DC whatever the stretch
+    if (sum > 0.0f)
+        juce::FloatVectorOperations::multiply(weights, 1.0f / sum, numTaps);
+
+    return numTaps;
+}
+
+template <typename SampleType>
+bool ScratchEngine::process(SampleType* const* channels, int numChannels, int numSamples) noexcept
+{
+    const juce::SpinLock::ScopedTryLockType lock(trackLock);
+
+    // Only contended for the moment a new track is swapped in
+    if (!lock.isLocked()) {
+        for (int channel = 0; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::clear(channels[channel], numSamples);
+
+        return true;
+    }
+
+    if (track == nullptr)
+        return false;
+
+    const auto& samples = track->samples;
+    const int length = samples.getNumSamples();
+    const int numTrackChannels = samples.getNumChannels();
+    const double trackSampleRate = track->sampleRate;
+    const double secondsPerSample = 1.0 / outputSampleRate;
+    const double stepScale = trackSampleRate / outputSampleRate;
+
+    // The platter turns at the playback rate unless it is held
+    const double platterSpeed = playing && !touched ? playbackRate : 0.0;
+
+    for (int i = 0; i < numSamples; ++i) {
+        target += platterSpeed * secondsPerSample;
+
+        const double desiredSpeed = juce::jlimit(-maximumSpeed, maximumSpeed,
+                                                 platterSpeed + (target - position) * followCoefficient);
+        speed += (desiredSpeed - speed) * rateSmoothing;
+        position += speed * secondsPerSample;
+
+        int firstIndex = 0;
+        const int numTaps = computeWeights(position * trackSampleRate, std::abs(speed) * stepScale, firstIndex);
+        const auto gain = static_cast<float>(juce::jmin(1.0, std::abs(speed) / fullVolumeSpeed));
+        const bool inside = firstIndex >= 0 && firstIndex + numTaps <= length;
+
+        for (int channel = 0; channel < numChannels; ++channel) {
+            const float* data = samples.getReadPointer(juce::jmin(channel, numTrackChannels - 1));
+            float value = 0.0f;
+
+            if (inside) {
+                for (int tap = 0; tap < numTaps; ++tap)
+                    value += data[firstIndex + tap] * weights[tap];
+            } else {
+                // Reading past either end of the track gives silence
+                for (int tap = 0; tap < numTaps; ++tap)
+                    if (juce::isPositiveAndBelow(firstIndex + tap, length))
+                        value += data[firstIndex + tap] * weights[tap];
+            }
+
+            channels[channel][i] = static_cast<SampleType>(value * gain);
+        }
+    }
+
+    positionSeconds.store(position);
+    return true;
+}
+
+template bool ScratchEngine::process(float* const*, int, int) noexcept;
+template bool ScratchEngine::process(double* const*, int, int) noexcept;
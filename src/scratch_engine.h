@@ -0,0 +1,92 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <atomic>
+#include <memory>
+
+// Plays a deck's track from memory at a variable, possibly negative rate, the
+// way a turntable platter would. The playhead follows a target position that
+// advances at the playback rate and is moved by the jog wheel, and the actual
+// rate glides towards the one needed to reach it on every sample, so direction
+// changes stay smooth however fast the controller moves.
+//
+// Samples are read by random access: 4-point Lagrange interpolation up to
+// normal speed, and above it a windowed sinc whose cutoff follows the rate, so
+// fast scratches don't alias. The sinc is capped at maximumSincStretch times its
+// base width, which bounds the cost per sample.
+class ScratchEngine
+{
+public:
+    // A 12" at 33 1/3 rpm turns once every 1.8 seconds
+    static constexpr double secondsPerRevolution = 1.8;
+    static constexpr double maximumSpeed = 8.0;
+
+    // How far the jog wheel moves the track while the platter isn't touched
+    static constexpr double nudgeSensitivity = 0.1;
+
+    ScratchEngine();
+    ~ScratchEngine();
+
+    // Control thread - the track is swapped in without blocking the audio thread
+    void loadTrack(juce::AudioBuffer<float>&& samples, double trackSampleRate);
+    void unloadTrack();
+    double getTrackLengthSeconds() const;
+
+    // Playhead position as of the last processed block
+    double getPositionSeconds() const;
+
+    // Audio thread
+    void prepare(double sampleRate);
+    void handleTrackChange() noexcept;
+    void setPlaying(bool shouldPlay) noexcept;
+    void setTouched(bool isTouched) noexcept;
+    void setPlaybackRate(double rate) noexcept;
+    void seek(double seconds) noexcept;
+    void setJogPosition(double revolutions) noexcept;
+
+    // Renders the track into the channels. Returns false, leaving the channels
+    // untouched, when no track is loaded. Instantiated for float and double.
+    template <typename SampleType>
+    bool process(SampleType* const* channels, int numChannels, int numSamples) noexcept;
+
+private:
+    struct Track
+    {
+        juce::AudioBuffer<float> samples;
+        double sampleRate = 44100.0;
+    };
+
+    static constexpr int sincZeroCrossings = 8;
+    static constexpr int sincTableResolution = 64;
+    static constexpr int maximumSincStretch = 4;
+    static constexpr int maximumTaps = 2 * sincZeroCrossings * maximumSincStretch + 2;
+
+    // Fills weights for reading at a position in track samples, moving by step
+    // samples per output sample. Returns the number of taps.
+    int computeWeights(double samplePosition, double step, int& firstIndex) noexcept;
+
+    juce::SpinLock trackLock;
+    std::unique_ptr<Track> track;
+    std::atomic<bool> trackChanged { false };
+    std::atomic<double> trackLengthSeconds { 0.0 };
+    std::atomic<double> positionSeconds { 0.0 };
+
+    // Audio thread state. Positions are in seconds, speeds relative to normal.
+    double outputSampleRate = 44100.0;
+    double position = 0.0;
+    double target = 0.0;
+    double speed = 0.0;
+    double playbackRate = 1.0;
+    double lastJogPosition = 0.0;
+    bool jogPositionKnown = false;
+    bool playing = false;
+    bool touched = false;
+    double followCoefficient = 0.0;
+    double rateSmoothing = 0.0;
+
+    float sincTable[sincZeroCrossings * sincTableResolution + 2] {};
+    float weights[maximumTaps] {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ScratchEngine)
+};
@@ -0,0 +1,460 @@
+#include "shared_memory_channel.h"
+
+#if JUCE_WINDOWS
+ #include <windows.h>
+#else
+ #include <cerrno>
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+ #if JUCE_LINUX
+  #include <linux/futex.h>
+  #include <sys/syscall.h>
+  #include <ctime>
+ #endif
+#endif
+
+#include <cstring>
+
+namespace
+{
+    constexpr uint32_t regionMagic = 0x4a41504d; // "JAPM"
+    constexpr uint32_t regionVersion = 1;
+
+    // Fills the rest of a ring after a record that didn't fit before the end
+    constexpr uint32_t paddingType = 0xffffffff;
+
+    struct RecordHeader
+    {
+        uint32_t size;
+        uint32_t type;
+        uint32_t tag;
+        uint32_t reserved;
+    };
+
+    // Records are padded to a whole header, so any gap left at the end of a
+    // ring has room for the filler header and a header never wraps around
+    constexpr size_t recordAlignment = sizeof(RecordHeader);
+
+    static_assert((recordAlignment & (recordAlignment - 1)) == 0, "Record alignment must be a power of two");
+
+    size_t getRecordSize(size_t payloadSize)
+    {
+        return (sizeof(RecordHeader) + payloadSize + recordAlignment - 1) & ~(recordAlignment - 1);
+    }
+
+    bool isValidName(const juce::String& name)
+    {
+        return name.isNotEmpty() && name.length() <= SharedMemoryChannel::maxNameLength
+            && name.containsOnly("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_-");
+    }
+
+    size_t roundUpToPowerOfTwo(size_t bytes)
+    {
+        size_t capacity = 4096;
+
+        while (capacity < bytes)
+            capacity *= 2;
+
+        return capacity;
+    }
+}
+
+// Read and write positions only ever grow; they sit on separate cache lines so
+// the two processes don't contend for one
+struct SharedMemoryChannel::RingState
+{
+    alignas(64) std::atomic<uint64_t> writePosition;
+    alignas(64) std::atomic<uint64_t> readPosition;
+};
+
+struct SharedMemoryChannel::Direction
+{
+    RingState rings[2];
+
+    // Bumped after every write; the reader sleeps on it while it is unchanged
+    alignas(64) std::atomic<uint32_t> doorbell;
+    std::atomic<uint32_t> numWaiting;
+};
+
+// Lives at the start of the shared memory, followed by the ring data of
+// direction 0 (control, audio) and direction 1 (control, audio)
+struct SharedMemoryChannel::Region
+{
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint64_t controlCapacity;
+    uint64_t audioCapacity;
+    Direction directions[2];
+
+    static size_t getTotalSize(size_t controlCapacity, size_t audioCapacity)
+    {
+        return sizeof(Region) + 2 * (controlCapacity + audioCapacity);
+    }
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "Shared memory atomics must be lock-free to work across processes");
+
+// The mapped region and the OS handles behind it
+struct SharedMemoryChannel::Mapping
+{
+    ~Mapping()
+    {
+       #if JUCE_WINDOWS
+        if (address != nullptr)
+            UnmapViewOfFile(address);
+
+        if (handle != nullptr)
+            CloseHandle(handle);
+
+        for (auto* event : events)
+            if (event != nullptr)
+                CloseHandle(event);
+       #else
+        if (address != nullptr)
+            munmap(address, size);
+
+        if (unlinkOnClose)
+            shm_unlink(path.toRawUTF8());
+       #endif
+    }
+
+    bool map(const juce::String& name, size_t sizeToCreate, juce::String& error)
+    {
+        const bool create = sizeToCreate > 0;
+
+       #if JUCE_WINDOWS
+        const auto mappingName = "Local\\jap_" + name;
+
+        if (create) {
+            handle = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(static_cast<uint64_t>(sizeToCreate) >> 32),
+                                        static_cast<DWORD>(sizeToCreate & 0xffffffff), mappingName.toWideCharPointer());
+        } else {
+            handle = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, mappingName.toWideCharPointer());
+        }
+
+        if (handle == nullptr) {
+            error = "Cannot " + juce::String(create ? "create" : "open") + " shared memory " + name;
+            return false;
+        }
+
+        address = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+
+        if (address == nullptr) {
+            error = "Cannot map shared memory " + name;
+            return false;
+        }
+
+        MEMORY_BASIC_INFORMATION info;
+        VirtualQuery(address, &info, sizeof(info));
+        size = static_cast<size_t>(info.RegionSize);
+
+        // One auto-reset event per direction stands in for the futex
+        for (int direction = 0; direction < 2; ++direction) {
+            events[direction] = CreateEventW(nullptr, FALSE, FALSE, (mappingName + "_" + juce::String(direction)).toWideCharPointer());
+
+            if (events[direction] == nullptr) {
+                error = "Cannot create the doorbell for " + name;
+                return false;
+            }
+        }
+       #else
+        path = "/jap_" + name;
+
+        // Replace whatever a crashed creator may have left behind
+        if (create)
+            shm_unlink(path.toRawUTF8());
+
+        const int fd = shm_open(path.toRawUTF8(), create ? O_RDWR | O_CREAT | O_EXCL : O_RDWR, 0600);
+
+        if (fd < 0) {
+            error = "Cannot " + juce::String(create ? "create" : "open") + " shared memory " + name + ": " + juce::String(std::strerror(errno));
+            return false;
+        }
+
+        unlinkOnClose = create;
+        struct stat info;
+
+        if (create ? ftruncate(fd, static_cast<off_t>(sizeToCreate)) != 0 : fstat(fd, &info) != 0) {
+            error = "Cannot size shared memory " + name + ": " + juce::String(std::strerror(errno));
+            close(fd);
+            return false;
+        }
+
+        size = create ? sizeToCreate : static_cast<size_t>(info.st_size);
+        void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+
+        if (mapped == MAP_FAILED) {
+            error = "Cannot map shared memory " + name + ": " + juce::String(std::strerror(errno));
+            return false;
+        }
+
+        address = mapped;
+       #endif
+
+        return true;
+    }
+
+    void* address = nullptr;
+    size_t size = 0;
+
+   #if JUCE_WINDOWS
+    HANDLE handle = nullptr;
+    HANDLE events[2] = {};
+   #else
+    juce::String path;
+    bool unlinkOnClose = false;
+   #endif
+};
+
+std::unique_ptr<SharedMemoryChannel> SharedMemoryChannel::create(const juce::String& name, size_t controlBytes,
+                                                                 size_t audioBytes, juce::String& error)
+{
+    if (!isValidName(name)) {
+        error = "Channel names are 1 to 24 letters, digits, '_' or '-'";
+        return nullptr;
+    }
+
+    const size_t controlCapacity = roundUpToPowerOfTwo(controlBytes);
+    const size_t audioCapacity = roundUpToPowerOfTwo(audioBytes);
+    auto mapping = std::make_unique<Mapping>();
+
+    if (!mapping->map(name, Region::getTotalSize(controlCapacity, audioCapacity), error))
+        return nullptr;
+
+    auto* region = new (mapping->address) Region();
+    region->version = regionVersion;
+    region->controlCapacity = controlCapacity;
+    region->audioCapacity = audioCapacity;
+
+    for (auto& direction : region->directions) {
+        for (auto& ring : direction.rings) {
+            ring.writePosition.store(0);
+            ring.readPosition.store(0);
+        }
+
+        direction.doorbell.store(0);
+        direction.numWaiting.store(0);
+    }
+
+    // Published last, so an opener never sees a half-initialised region
+    region->magic.store(regionMagic, std::memory_order_release);
+
+    return std::unique_ptr<SharedMemoryChannel>(new SharedMemoryChannel(std::move(mapping), name, true));
+}
+
+std::unique_ptr<SharedMemoryChannel> SharedMemoryChannel::open(const juce::String& name, juce::String& error)
+{
+    if (!isValidName(name)) {
+        error = "Channel names are 1 to 24 letters, digits, '_' or '-'";
+        return nullptr;
+    }
+
+    auto mapping = std::make_unique<Mapping>();
+
+    if (!mapping->map(name, 0, error))
+        return nullptr;
+
+    auto* region = static_cast<Region*>(mapping->address);
+
+    if (mapping->size < sizeof(Region) || region->magic.load(std::memory_order_acquire) != regionMagic
+        || region->version != regionVersion
+        || mapping->size < Region::getTotalSize(region->controlCapacity, region->audioCapacity)) {
+        error = "Shared memory " + name + " is not a compatible channel";
+        return nullptr;
+    }
+
+    return std::unique_ptr<SharedMemoryChannel>(new SharedMemoryChannel(std::move(mapping), name, false));
+}
+
+SharedMemoryChannel::SharedMemoryChannel(std::unique_ptr<Mapping> mappingToUse, const juce::String& channelName, bool isCreator)
+    : mapping(std::move(mappingToUse)),
+      region(static_cast<Region*>(mapping->address)),
+      name(channelName),
+      creator(isCreator),
+      outgoing(isCreator ? 0 : 1),
+      incoming(isCreator ? 1 : 0)
+{
+}
+
+SharedMemoryChannel::~SharedMemoryChannel() = default;
+
+SharedMemoryChannel::RingState& SharedMemoryChannel::getRing(int direction, Ring ring) const noexcept
+{
+    return region->directions[direction].rings[ring];
+}
+
+uint8_t* SharedMemoryChannel::getRingData(int direction, Ring ring) const noexcept
+{
+    auto* data = reinterpret_cast<uint8_t*>(region + 1);
+    const size_t directionSize = static_cast<size_t>(region->controlCapacity + region->audioCapacity);
+    return data + static_cast<size_t>(direction) * directionSize + (ring == audioRing ? region->controlCapacity : 0);
+}
+
+size_t SharedMemoryChannel::getCapacity(Ring ring) const noexcept
+{
+    return static_cast<size_t>(ring == audioRing ? region->audioCapacity : region->controlCapacity);
+}
+
+size_t SharedMemoryChannel::getMaxMessageSize(Ring ring) const noexcept
+{
+    // A record may need padding up to the end of the ring first, so only half
+    // the ring is guaranteed to be usable for one record
+    return getCapacity(ring) / 2 - sizeof(RecordHeader);
+}
+
+bool SharedMemoryChannel::write(Ring ring, uint32_t type, uint32_t tag, const void* data, size_t size) noexcept
+{
+    if (size > getMaxMessageSize(ring))
+        return false;
+
+    auto& state = getRing(outgoing, ring);
+    uint8_t* buffer = getRingData(outgoing, ring);
+    const size_t capacity = getCapacity(ring);
+    const size_t recordSize = getRecordSize(size);
+
+    const uint64_t writePosition = state.writePosition.load(std::memory_order_relaxed);
+    const uint64_t readPosition = state.readPosition.load(std::memory_order_acquire);
+    const size_t offset = static_cast<size_t>(writePosition & (capacity - 1));
+    const size_t spaceToEnd = capacity - offset;
+    const size_t padding = recordSize > spaceToEnd ? spaceToEnd : 0;
+
+    if (capacity - static_cast<size_t>(writePosition - readPosition) < padding + recordSize)
+        return false;
+
+    if (padding > 0) {
+        const RecordHeader filler { static_cast<uint32_t>(padding - sizeof(RecordHeader)), paddingType, 0, 0 };
+        std::memcpy(buffer + offset, &filler, sizeof(filler));
+    }
+
+    const size_t recordOffset = padding > 0 ? 0 : offset;
+    const RecordHeader header { static_cast<uint32_t>(size), type, tag, 0 };
+    std::memcpy(buffer + recordOffset, &header, sizeof(header));
+
+    if (size > 0)
+        std::memcpy(buffer + recordOffset + sizeof(header), data, size);
+
+    state.writePosition.store(writePosition + padding + recordSize, std::memory_order_release);
+    ringDoorbell(outgoing);
+    return true;
+}
+
+int64_t SharedMemoryChannel::getNextMessageSize(Ring ring) const noexcept
+{
+    auto& state = getRing(incoming, ring);
+    const uint8_t* buffer = getRingData(incoming, ring);
+    const size_t capacity = getCapacity(ring);
+
+    uint64_t readPosition = state.readPosition.load(std::memory_order_relaxed);
+    const uint64_t writePosition = state.writePosition.load(std::memory_order_acquire);
+
+    while (readPosition != writePosition) {
+        RecordHeader header;
+        std::memcpy(&header, buffer + (readPosition & (capacity - 1)), sizeof(header));
+
+        if (header.type != paddingType)
+            return header.size;
+
+        readPosition += sizeof(RecordHeader) + header.size;
+    }
+
+    return -1;
+}
+
+bool SharedMemoryChannel::read(Ring ring, uint32_t& type, uint32_t& tag, void* destination, size_t destinationSize) noexcept
+{
+    auto& state = getRing(incoming, ring);
+    const uint8_t* buffer = getRingData(incoming, ring);
+    const size_t capacity = getCapacity(ring);
+
+    uint64_t readPosition = state.readPosition.load(std::memory_order_relaxed);
+    const uint64_t writePosition = state.writePosition.load(std::memory_order_acquire);
+
+    while (readPosition != writePosition) {
+        const size_t offset = static_cast<size_t>(readPosition & (capacity - 1));
+        RecordHeader header;
+        std::memcpy(&header, buffer + offset, sizeof(header));
+
+        if (header.type == paddingType) {
+            readPosition += sizeof(RecordHeader) + header.size;
+            continue;
+        }
+
+        if (header.size > destinationSize)
+            return false;
+
+        std::memcpy(destination, buffer + offset + sizeof(header), header.size);
+        type = header.type;
+        tag = header.tag;
+
+        state.readPosition.store(readPosition + getRecordSize(header.size), std::memory_order_release);
+        return true;
+    }
+
+    state.readPosition.store(readPosition, std::memory_order_release);
+    return false;
+}
+
+void SharedMemoryChannel::ringDoorbell(int direction) noexcept
+{
+    auto& target = region->directions[direction];
+    target.doorbell.fetch_add(1);
+
+    // The system call is skipped while nobody sleeps
+    if (target.numWaiting.load() == 0)
+        return;
+
+   #if JUCE_WINDOWS
+    SetEvent(mapping->events[direction]);
+   #elif JUCE_LINUX
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&target.doorbell), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+   #endif
+}
+
+void SharedMemoryChannel::wake() noexcept
+{
+    region->directions[incoming].numWaiting.fetch_add(1);
+    ringDoorbell(incoming);
+    region->directions[incoming].numWaiting.fetch_sub(1);
+}
+
+bool SharedMemoryChannel::wait(int timeoutMs) noexcept
+{
+    auto& direction = region->directions[incoming];
+    const auto hasMessage = [this] { return getNextMessageSize(controlRing) >= 0 || getNextMessageSize(audioRing) >= 0; };
+
+    const uint32_t doorbell = direction.doorbell.load(std::memory_order_acquire);
+
+    if (hasMessage())
+        return true;
+
+    if (timeoutMs == 0)
+        return false;
+
+    direction.numWaiting.fetch_add(1);
+
+   #if JUCE_WINDOWS
+    // A write between the check above and here leaves the event set, so it isn't missed
+    if (direction.doorbell.load() == doorbell)
+        WaitForSingleObject(mapping->events[incoming], timeoutMs < 0 ? INFINITE : static_cast<DWORD>(timeoutMs));
+   #elif JUCE_LINUX
+    // Returns straight away if the doorbell has moved on since it was read
+    timespec timeout { timeoutMs / 1000, (timeoutMs % 1000) * 1000000L };
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&direction.doorbell), FUTEX_WAIT, doorbell,
+            timeoutMs < 0 ? nullptr : &timeout, nullptr, 0);
+   #else
+    // No cross-process wait primitive on a plain word - poll the doorbell
+    const auto deadline = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(timeoutMs);
+
+    while (direction.doorbell.load() == doorbell
+           && (timeoutMs < 0 || juce::Time::getMillisecondCounter() < deadline))
+        juce::Thread::sleep(1);
+   #endif
+
+    direction.numWaiting.fetch_sub(1);
+    return hasMessage();
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// A two-way channel between two processes through a named shared memory
+// region, for moving audio and parameter changes without serialising them.
+// Each direction has two single-producer/single-consumer rings - a small one
+// for control messages and a larger one for audio blocks - so bulk audio never
+// delays a parameter change. Messages are copied straight into the ring, and
+// a reader blocked in wait() is woken through a doorbell word in the region
+// (a futex on Linux, a named event on Windows).
+//
+// The process that creates the channel writes to direction 0 and the one that
+// opens it to direction 1. Each end must only be used from one thread at a
+// time, apart from wait() and wake().
+class SharedMemoryChannel
+{
+public:
+    enum Ring
+    {
+        controlRing,
+        audioRing
+    };
+
+    static constexpr size_t defaultControlBytes = 64 * 1024;
+    static constexpr size_t defaultAudioBytes = 1024 * 1024;
+    static constexpr int maxNameLength = 24; // macOS limits shared memory names to 31 characters
+
+    // Creates the region, replacing a stale one with the same name left behind
+    // by a crashed process. Returns nullptr and sets error on failure.
+    static std::unique_ptr<SharedMemoryChannel> create(const juce::String& name, size_t controlBytes,
+                                                       size_t audioBytes, juce::String& error);
+
+    // Attaches to a region created by another process
+    static std::unique_ptr<SharedMemoryChannel> open(const juce::String& name, juce::String& error);
+
+    // Unmaps the region - the creator also removes its name
+    ~SharedMemoryChannel();
+
+    // Appends a message to the outgoing ring. Returns false, without blocking,
+    // if it doesn't fit until the other side has read more.
+    bool write(Ring ring, uint32_t type, uint32_t tag, const void* data, size_t size) noexcept;
+
+    // Size of the next incoming message, or -1 if the ring is empty
+    int64_t getNextMessageSize(Ring ring) const noexcept;
+
+    // Copies the next incoming message into destination, which must hold at
+    // least getNextMessageSize() bytes. Returns false if the ring is empty.
+    bool read(Ring ring, uint32_t& type, uint32_t& tag, void* destination, size_t capacity) noexcept;
+
+    // Largest message that fits in a ring
+    size_t getMaxMessageSize(Ring ring) const noexcept;
+
+    // Blocks until a message is waiting in either incoming ring, the timeout
+    // (in ms, -1 for none) runs out or wake() is called. Returns true if a
+    // message is waiting.
+    bool wait(int timeoutMs) noexcept;
+
+    // Releases this end's wait(), e.g. before shutting down a reader thread
+    void wake() noexcept;
+
+    bool isCreator() const noexcept { return creator; }
+    const juce::String& getName() const noexcept { return name; }
+
+private:
+    struct Region;
+    struct RingState;
+    struct Direction;
+    struct Mapping;
+
+    SharedMemoryChannel(std::unique_ptr<Mapping> mapping, const juce::String& name, bool creator);
+
+    RingState& getRing(int direction, Ring ring) const noexcept;
+    uint8_t* getRingData(int direction, Ring ring) const noexcept;
+    size_t getCapacity(Ring ring) const noexcept;
+    void ringDoorbell(int direction) noexcept;
+
+    std::unique_ptr<Mapping> mapping;
+    Region* region = nullptr;
+    juce::String name;
+    bool creator = false;
+    int outgoing = 0;
+    int incoming = 1;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedMemoryChannel)
+};
@@ -0,0 +1,250 @@
+#include "spectrum_analyser.h"
+
+namespace
+{
+    constexpr double levelReleaseSeconds = 0.25;
+    constexpr double peakHoldSeconds = 1.0;
+    constexpr double peakFallDecibelsPerSecond = 20.0;
+
+    float toDecibels(float magnitude) noexcept
+    {
+        // The window is normalised, so a full-scale sine peaks at fftSize / 2
+        return juce::Decibels::gainToDecibels(magnitude * (2.0f / SpectrumAnalyser::fftSize),
+                                              SpectrumAnalyser::minimumDecibels);
+    }
+}
+
+float SpectrumAnalyser::getBandFrequency(int band)
+{
+    const float ratio = maximumFrequency / minimumFrequency;
+    return minimumFrequency * std::pow(ratio, (static_cast<float>(band) + 0.5f) / numBands);
+}
+
+SpectrumAnalyser::SpectrumAnalyser()
+    : juce::Thread("JUCE Audio Processor Spectrum")
+{
+    for (auto& channel : fifoChannels)
+        channel.resize(static_cast<size_t>(fifoSize));
+
+    history.resize(static_cast<size_t>(fftSize));
+    fftData.resize(static_cast<size_t>(2 * fftSize));
+    prepare(sampleRate);
+}
+
+SpectrumAnalyser::~SpectrumAnalyser()
+{
+    stopThread(2000);
+}
+
+void SpectrumAnalyser::prepare(double newSampleRate)
+{
+    const bool wasRunning = isThreadRunning();
+    stopThread(2000);
+
+    sampleRate = newSampleRate;
+
+    const float binsPerHz = static_cast<float>(fftSize / sampleRate);
+    const int lastUsableBin = fftSize / 2;
+    const float ratio = maximumFrequency / minimumFrequency;
+    bandRanges.resize(static_cast<size_t>(numBands));
+
+    for (int band = 0; band < numBands; ++band) {
+        const float low = minimumFrequency * std::pow(ratio, static_cast<float>(band) / numBands);
+        const float high = minimumFrequency * std::pow(ratio, static_cast<float>(band + 1) / numBands);
+        auto& range = bandRanges[static_cast<size_t>(band)];
+
+        range.firstBin = static_cast<int>(std::ceil(low * binsPerHz));
+        range.lastBin = juce::jmin(lastUsableBin, static_cast<int>(std::floor(high * binsPerHz)));
+        range.centreBin = juce::jmin(static_cast<float>(lastUsableBin), getBandFrequency(band) * binsPerHz);
+    }
+
+    const double frameSeconds = hopSize / sampleRate;
+    levelRelease = static_cast<float>(std::exp(-frameSeconds / levelReleaseSeconds));
+    peakFallPerFrame = static_cast<float>(peakFallDecibelsPerSecond * frameSeconds);
+    numPeakHoldFrames = juce::roundToInt(peakHoldSeconds / frameSeconds);
+
+    fifo.read(fifo.getNumReady());
+    std::fill(history.begin(), history.end(), 0.0f);
+    levels.fill(minimumDecibels);
+    peaks.fill(minimumDecibels);
+    peakHoldFrames.fill(0);
+
+    {
+        const juce::ScopedLock sl(frameLock);
+        published.levels.fill(minimumDecibels);
+        published.peaks.fill(minimumDecibels);
+    }
+
+    if (wasRunning)
+        startThread(juce::Thread::Priority::low);
+}
+
+void SpectrumAnalyser::setEnabled(bool shouldBeEnabled)
+{
+    if (shouldBeEnabled == isEnabled())
+        return;
+
+    if (shouldBeEnabled) {
+        // Whatever was queued before the last stop is stale. It is dropped here,
+        // while neither thread touches the FIFO, rather than when the worker
+        // starts, which could be after the first new blocks have arrived.
+        fifo.read(fifo.getNumReady());
+        enabled.store(true);
+        startThread(juce::Thread::Priority::low);
+    } else {
+        enabled.store(false);
+        stopThread(2000);
+    }
+}
+
+void SpectrumAnalyser::push(const float* const* channels, int numChannels, int numSamples) noexcept
+{
+    if (!enabled.load(std::memory_order_relaxed) || numChannels < 1)
+        return;
+
+    const auto scope = fifo.write(juce::jmin(numSamples, fifo.getFreeSpace()));
+    const float* inputs[] = { channels[0], channels[numChannels > 1 ? 1 : 0] };
+
+    for (int channel = 0; channel < 2; ++channel) {
+        auto* destination = fifoChannels[static_cast<size_t>(channel)].data();
+
+        if (scope.blockSize1 > 0)
+            std::memcpy(destination + scope.startIndex1, inputs[channel], sizeof(float) * static_cast<size_t>(scope.blockSize1));
+
+        if (scope.blockSize2 > 0)
+            std::memcpy(destination + scope.startIndex2, inputs[channel] + scope.blockSize1,
+                        sizeof(float) * static_cast<size_t>(scope.blockSize2));
+    }
+}
+
+void SpectrumAnalyser::pushSilence(int numSamples) noexcept
+{
+    if (!enabled.load(std::memory_order_relaxed))
+        return;
+
+    const auto scope = fifo.write(juce::jmin(numSamples, fifo.getFreeSpace()));
+
+    for (auto& channel : fifoChannels) {
+        if (scope.blockSize1 > 0)
+            std::fill_n(channel.data() + scope.startIndex1, scope.blockSize1, 0.0f);
+
+        if (scope.blockSize2 > 0)
+            std::fill_n(channel.data() + scope.startIndex2, scope.blockSize2, 0.0f);
+    }
+}
+
+void SpectrumAnalyser::run()
+{
+    while (!threadShouldExit()) {
+        wait(pollIntervalMs);
+
+        bool analysed = false;
+
+        while (fifo.getNumReady() >= hopSize && !threadShouldExit()) {
+            // Slide the history along by one hop, appending the mid signal
+            std::memmove(history.data(), history.data() + hopSize, sizeof(float) * static_cast<size_t>(fftSize - hopSize));
+            auto* destination = history.data() + (fftSize - hopSize);
+
+            {
+                const auto scope = fifo.read(hopSize);
+                const auto* left = fifoChannels[0].data();
+                const auto* right = fifoChannels[1].data();
+
+                for (auto [start, size] : { std::pair(scope.startIndex1, scope.blockSize1),
+                                            std::pair(scope.startIndex2, scope.blockSize2) }) {
+                    juce::FloatVectorOperations::add(destination, left + start, right + start, size);
+                    juce::FloatVectorOperations::multiply(destination, 0.5f, size);
+                    destination += size;
+                }
+            }
+
+            analyseFrame();
+            analysed = true;
+        }
+
+        if (analysed)
+            publish();
+    }
+}
+
+void SpectrumAnalyser::analyseFrame()
+{
+    std::copy(history.begin(), history.end(), fftData.begin());
+    window.multiplyWithWindowingTable(fftData.data(), static_cast<size_t>(fftSize));
+    fft.performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+    for (int band = 0; band < numBands; ++band) {
+        const auto& range = bandRanges[static_cast<size_t>(band)];
+        float magnitude = 0.0f;
+
+        if (range.firstBin <= range.lastBin) {
+            magnitude = juce::FloatVectorOperations::findMaximum(fftData.data() + range.firstBin,
+                                                                 range.lastBin - range.firstBin + 1);
+        } else {
+            const int lower = static_cast<int>(range.centreBin);
+            const int upper = juce::jmin(lower + 1, fftSize / 2);
+            const float fraction = range.centreBin - static_cast<float>(lower);
+            magnitude = fftData[static_cast<size_t>(lower)] * (1.0f - fraction) + fftData[static_cast<size_t>(upper)] * fraction;
+        }
+
+        const float decibels = toDecibels(magnitude);
+        auto& level = levels[static_cast<size_t>(band)];
+        auto& peak = peaks[static_cast<size_t>(band)];
+        auto& holdFrames = peakHoldFrames[static_cast<size_t>(band)];
+
+        level = decibels > level ? decibels : decibels + (level - decibels) * levelRelease;
+
+        if (decibels >= peak) {
+            peak = decibels;
+            holdFrames = numPeakHoldFrames;
+        } else if (holdFrames > 0) {
+            --holdFrames;
+        } else {
+            peak = juce::jmax(minimumDecibels, level, peak - peakFallPerFrame);
+        }
+    }
+}
+
+void SpectrumAnalyser::publish()
+{
+    const juce::ScopedLock sl(frameLock);
+
+    published.levels = levels;
+    published.peaks = peaks;
+
+    if (sharedOutput != nullptr) {
+        // Seqlock write: the sequence is odd while the frame changes
+        auto* counter = reinterpret_cast<std::atomic<uint32_t>*>(sharedOutput + sequenceField);
+        counter->store(++sequence, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::copy(levels.begin(), levels.end(), sharedOutput + levelsField);
+        std::copy(peaks.begin(), peaks.end(), sharedOutput + peaksField);
+
+        counter->store(++sequence, std::memory_order_release);
+    }
+}
+
+SpectrumAnalyser::Frame SpectrumAnalyser::getFrame() const
+{
+    const juce::ScopedLock sl(frameLock);
+    return published;
+}
+
+void SpectrumAnalyser::setSharedOutput(float* destination)
+{
+    const juce::ScopedLock sl(frameLock);
+    sharedOutput = destination;
+
+    // Start the new buffer off with the current frame
+    if (destination != nullptr) {
+        auto* counter = reinterpret_cast<std::atomic<uint32_t>*>(destination + sequenceField);
+        counter->store(++sequence, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::copy(published.levels.begin(), published.levels.end(), destination + levelsField);
+        std::copy(published.peaks.begin(), published.peaks.end(), destination + peaksField);
+
+        counter->store(++sequence, std::memory_order_release);
+    }
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+// Display-ready spectrum of an audio stream. The audio thread only copies its
+// samples into a lock-free FIFO; a low-priority worker thread runs overlapping
+// Hann-windowed FFTs on them, folds the bins into log-spaced bands, applies
+// smoothing and peak hold and publishes fixed-size frames:
+//  - as a copy read with getFrame() from any control thread
+//  - optionally straight into memory owned by the reader, such as a JS
+//    SharedArrayBuffer, guarded by a sequence counter like LevelMeter's
+// The analyser is idle, and costs the audio thread one atomic load per block,
+// until it is enabled.
+class SpectrumAnalyser : private juce::Thread
+{
+public:
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = fftSize / 4;
+    static constexpr int numBands = 64;
+    static constexpr float minimumFrequency = 20.0f;
+    static constexpr float maximumFrequency = 20000.0f;
+    static constexpr float minimumDecibels = -100.0f;
+
+    // Layout of the shared output, in floats. The sequence field holds a
+    // uint32 that is odd while a frame is being written.
+    enum SharedField
+    {
+        sequenceField = 0,
+        levelsField = 1,
+        peaksField = levelsField + numBands,
+        numSharedFields = peaksField + numBands
+    };
+
+    // Band levels in dBFS, where a full-scale sine reads 0
+    struct Frame
+    {
+        std::array<float, numBands> levels;     // fast attack, falling with a 250 ms time constant
+        std::array<float, numBands> peaks;      // held for a second, then falling 20 dB/s
+    };
+
+    // Geometric centre of a band, in Hz
+    static float getBandFrequency(int band);
+
+    SpectrumAnalyser();
+    ~SpectrumAnalyser() override;
+
+    // Control thread, while no audio is being pushed
+    void prepare(double sampleRate);
+
+    // Starts or stops the worker thread - control thread only
+    void setEnabled(bool shouldBeEnabled);
+    bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+
+    // Audio thread. Stereo is analysed as its mid signal, mono as it is, and
+    // samples that don't fit while the worker is behind are dropped.
+    void push(const float* const* channels, int numChannels, int numSamples) noexcept;
+
+    // Audio thread. Same as pushing numSamples of digital silence.
+    void pushSilence(int numSamples) noexcept;
+
+    // Latest published frame - any control thread
+    Frame getFrame() const;
+
+    // Where to also write frames, numSharedFields floats, or nullptr. Returns
+    // once the worker has stopped writing to the previous one.
+    void setSharedOutput(float* destination);
+
+private:
+    static constexpr int fifoSize = 8 * fftSize;
+    static constexpr int pollIntervalMs = 10;
+
+    // FFT bins feeding one band: the loudest bin in [firstBin, lastBin], or,
+    // for bands narrower than a bin, the spectrum interpolated at centreBin
+    struct BandRange
+    {
+        int firstBin = 0;
+        int lastBin = -1;
+        float centreBin = 0.0f;
+    };
+
+    void run() override;
+    void analyseFrame();
+    void publish();
+
+    juce::dsp::FFT fft { fftOrder };
+    juce::dsp::WindowingFunction<float> window { static_cast<size_t>(fftSize),
+                                                 juce::dsp::WindowingFunction<float>::hann, true };
+
+    // Filled by the audio thread, one ring per channel sharing the same indices
+    juce::AbstractFifo fifo { fifoSize };
+    std::array<std::vector<float>, 2> fifoChannels;
+    std::atomic<bool> enabled { false };
+
+    // Worker thread state
+    double sampleRate = 44100.0;
+    std::vector<BandRange> bandRanges;
+    std::vector<float> history;         // the last fftSize samples, oldest first
+    std::vector<float> fftData;         // 2 * fftSize, as performFrequencyOnlyForwardTransform() needs
+    std::array<float, numBands> levels;
+    std::array<float, numBands> peaks;
+    std::array<int, numBands> peakHoldFrames {};
+    float levelRelease = 0.0f;
+    float peakFallPerFrame = 0.0f;
+    int numPeakHoldFrames = 0;
+
+    // Guards the published frame and the shared output
+    juce::CriticalSection frameLock;
+    Frame published;
+    float* sharedOutput = nullptr;
+    uint32_t sequence = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumAnalyser)
+};
@@ -1,6 +1,9 @@
 const { app, BrowserWindow } = require("electron");
 const path = require("path");
 
+// Run the mock implementation in the child process rather than the native addon
+process.env.JUCE_AUDIO_PROCESSOR_MOCK = "1";
+
 // Enhanced logging function
 function logMessage(message, level = "INFO") {
   const timestamp = new Date().toISOString();
@@ -1,4 +1,5 @@
 const JUCEAudioProcessor = require("../index");
+const AudioProcessorWrapper = require("../src/audio-processor-wrapper");
 
 console.log("Testing JUCE Audio Processor...");
 
@@ -19,7 +20,624 @@ try {
   processor.setJogWheelPosition(0.5);
 
   console.log("✓ All methods called successfully");
-  console.log("✓ JUCE Audio Processor is working correctly!");
+
+  // Test batched parameter changes in both forms
+  processor.setParameters({ filterCutoff: 800, filterResonance: 0.9, flangerEnabled: false });
+  processor.setParameters(
+    new Float32Array([JUCEAudioProcessor.Parameters.volume, 0.8, JUCEAudioProcessor.Parameters.flangerRate, 0.4])
+  );
+
+  let rejected = false;
+  try {
+    processor.setParameters({ notAParameter: 1 });
+  } catch (error) {
+    rejected = true;
+  }
+  if (!rejected) {
+    throw new Error("setParameters should reject unknown parameters");
+  }
+
+  // The last value of a repeated parameter ID wins
+  const repeated = new JUCEAudioProcessor();
+  const direct = new JUCEAudioProcessor();
+  const volumeId = JUCEAudioProcessor.Parameters.volume;
+  repeated.setParameters(new Float32Array([volumeId, 0.1, volumeId, 0.7]));
+  direct.setVolume(0.7);
+  if (Buffer.compare(Buffer.from(repeated.getState()), Buffer.from(direct.getState())) !== 0) {
+    throw new Error("the last value of a repeated parameter should win");
+  }
+
+  console.log("✓ Parameters set in batches");
+
+  // Test presets and saved state: recalling a preset brings back the state it was stored with
+  processor.storePreset(1);
+  const savedState = processor.getState();
+  processor.setFilterCutoff(300);
+
+  if (!processor.recallPreset(1) || processor.recallPreset(2) ||
+      Buffer.compare(Buffer.from(processor.getState()), Buffer.from(savedState)) !== 0) {
+    throw new Error("recallPreset should restore the stored settings");
+  }
+
+  processor.setState(savedState);
+  console.log("✓ Presets stored and recalled");
+
+  processor.setSmoothingTime(0.02);
+
+  // Test parameter smoothing: a volume step ramps steadily down over the
+  // smoothing time instead of jumping
+  const smoothed = new JUCEAudioProcessor();
+  smoothed.setSmoothingTime(0.02);
+  smoothed.prepareToPlay(48000, 256);
+  smoothed.setFilterCutoff(20000);
+  const steady = new Float32Array(2 * 256);
+  for (let block = 0; block < 40; block++) {
+    smoothed.processAudio(steady.fill(0.5));
+  }
+  const before = steady[255];
+  smoothed.setVolume(0.25);
+  const ramp = [];
+  for (let block = 0; block < 8; block++) {
+    smoothed.processAudio(steady.fill(0.5));
+    ramp.push(...steady.subarray(0, 256));
+  }
+  const rampLength = ramp.findIndex((sample) => Math.abs(sample - before * 0.25) < 1e-4);
+  if (Math.abs(ramp[0] - before) > 0.01 || ramp.some((sample, i) => i > 0 && sample > ramp[i - 1] + 1e-6) ||
+      rampLength < 0.9 * 960 || rampLength > 1.1 * 960) {
+    throw new Error(`a volume change should ramp over the smoothing time (${rampLength} samples)`);
+  }
+
+  console.log("✓ Volume ramped over the smoothing time");
+
+  // Test the pitch shifter quality modes and the reported latency
+  processor.setPitchShiftQuality("fast");
+  const fastLatency = processor.getLatencySamples();
+  processor.setPitchShiftQuality("high");
+  if (!(processor.getLatencySamples() > fastLatency)) {
+    throw new Error("higher pitch shift quality should report more latency");
+  }
+  processor.setPitchShiftQuality("normal");
+
+  // Test the pitch shifter: a 440 Hz sine an octave up comes out near 880 Hz,
+  // counted by upward zero crossings once the grains are running
+  const shifted = new JUCEAudioProcessor();
+  shifted.prepareToPlay(48000, 512);
+  shifted.setParameters({ filterCutoff: 20000, pitchBend: 12 });
+  const shiftedBlock = new Float32Array(2 * 512);
+  let crossings = 0;
+  let previousShifted = 0;
+  for (let block = 0; block < 60; block++) {
+    shiftedBlock.forEach((_, i) => (shiftedBlock[i] = 0.5 * Math.sin((2 * Math.PI * 440 * (block * 512 + (i % 512))) / 48000)));
+    shifted.processAudio(shiftedBlock);
+    for (let i = 0; i < 512 && block >= 20; i++) {
+      crossings += previousShifted < 0 && shiftedBlock[i] >= 0 ? 1 : 0;
+      previousShifted = shiftedBlock[i];
+    }
+  }
+  const shiftedFrequency = (crossings * 48000) / (40 * 512);
+  if (Math.abs(shiftedFrequency - 880) > 880 * 0.03) {
+    throw new Error(`+12 semitones should double the frequency (got ${shiftedFrequency} Hz)`);
+  }
+
+  console.log("✓ Pitch shifted up an octave");
+
+  // Test the log level round trip
+  JUCEAudioProcessor.setLogLevel("warning");
+  if (JUCEAudioProcessor.getLogLevel() !== "warning") {
+    throw new Error("log level should be configurable");
+  }
+  JUCEAudioProcessor.setLogLevel("info");
+
+  // Test in-place audio processing on planar, interleaved and per-channel buffers
+  processor.prepareToPlay(48000, 256);
+
+  const planar = new Float32Array(2 * 256).fill(0.25);
+  if (processor.processAudio(planar) !== planar) {
+    throw new Error("processAudio should return the buffer it was given");
+  }
+
+  const interleaved = new Float32Array(new SharedArrayBuffer(2 * 128 * 4));
+  processor.processAudio(interleaved, 2, true);
+
+  const channels = [new Float32Array(512), new Float32Array(512)];
+  processor.processAudio(channels);
+
+  // At half volume, with the filter open and past the pitch shifter's
+  // latency, each layout comes back scaled in place, left and right apart
+  const halved = new JUCEAudioProcessor();
+  halved.prepareToPlay(48000, 512);
+  halved.setParameters({ volume: 0.5, filterCutoff: 20000 });
+  const layouts = {
+    planar: {
+      create: () => new Float32Array(2 * 256).map((_, i) => (i < 256 ? 0.25 : -0.5)),
+      process: (buffer) => halved.processAudio(buffer),
+      lastSamples: (buffer) => [buffer[255], buffer[511]],
+    },
+    interleaved: {
+      create: () => new Float32Array(new SharedArrayBuffer(2 * 256 * 4)).map((_, i) => (i % 2 ? -0.5 : 0.25)),
+      process: (buffer) => halved.processAudio(buffer, 2, true),
+      lastSamples: (buffer) => [buffer[510], buffer[511]],
+    },
+    "per-channel": {
+      create: () => [new Float32Array(256).fill(0.25), new Float32Array(256).fill(-0.5)],
+      process: (buffer) => halved.processAudio(buffer),
+      lastSamples: (buffer) => [buffer[0][255], buffer[1][255]],
+    },
+  };
+  for (const [layout, { create, process, lastSamples }] of Object.entries(layouts)) {
+    let buffer;
+    for (let block = 0; block < 40; block++) {
+      buffer = create();
+      process(buffer);
+    }
+    const [left, right] = lastSamples(buffer);
+    if (Math.abs(left - 0.125) > 0.01 || Math.abs(right + 0.25) > 0.01) {
+      throw new Error(`processAudio should scale a ${layout} buffer in place (got ${left}, ${right})`);
+    }
+  }
+
+  // A block larger than the prepared size goes through in slices, carrying on
+  // from the blocks before instead of starting over
+  const oversized = new Float32Array(2 * 2048).map((_, i) => (i < 2048 ? 0.25 : -0.5));
+  halved.processAudio(oversized);
+  if (oversized.some((sample, i) => Math.abs(sample - (i < 2048 ? 0.125 : -0.25)) > 0.01)) {
+    throw new Error("a block larger than the prepared size should carry on without a reset");
+  }
+
+  console.log("✓ Audio processed in place");
+
+  // Test metering: a full-scale-ish block shows up in the levels and in the shared meter buffer
+  const meters = new Float32Array(JUCEAudioProcessor.MeterFields.length);
+  processor.setMeterBuffer(meters);
+  processor.processAudio(new Float32Array(2 * 512).fill(0.5));
+  const levels = processor.getLevels();
+  processor.setMeterBuffer(null);
+
+  if (levels.peak.length !== 2 || levels.correlation < -1 || levels.correlation > 1 ||
+      new Uint32Array(meters.buffer)[0] % 2 !== 0 || meters[JUCEAudioProcessor.MeterFields.peakLeft] !== levels.peak[0]) {
+    throw new Error("meters should match the levels of the last block");
+  }
+
+  console.log("✓ Levels metered");
+
+  // Test the performance counters: every processed block is timed
+  const performance = processor.getPerformanceStats();
+  if (performance.blocks < 1 || performance.blockTime.max < performance.blockTime.median ||
+      performance.histogram.reduce((total, [, count]) => total + count, 0) !== performance.blocks) {
+    throw new Error("performance stats should cover every processed block");
+  }
+  processor.resetPerformanceStats();
+  processor.processAudio(new Float32Array(2 * 256));
+  if (processor.getPerformanceStats().blocks !== 1) {
+    throw new Error("resetPerformanceStats() should start the counters over");
+  }
+
+  console.log("✓ Performance stats recorded");
+
+  // Test idle-skip: once silence has outlasted the effect tails, blocks are
+  // skipped and come out as digital silence, until sound comes back
+  processor.resetPerformanceStats();
+  const silence = new Float32Array(2 * 512);
+  for (let block = 0; block < 40; block++) {
+    processor.processAudio(silence.fill(1e-9));
+  }
+  const idleBlocks = processor.getPerformanceStats().idleBlocks;
+  if (idleBlocks < 20 || silence.some((sample) => sample !== 0)) {
+    throw new Error("silent blocks past the tail should be skipped and cleared");
+  }
+  processor.processAudio(silence.fill(0.5));
+  if (processor.getPerformanceStats().idleBlocks !== idleBlocks || silence.every((sample) => sample === 0)) {
+    throw new Error("sound should bring the processor out of idle");
+  }
+
+  console.log("✓ Silent blocks skipped once the tail has decayed");
+
+  // Test the flanger switch: it fades in and out, so a sine never jumps by
+  // more than its own slope
+  const switched = new JUCEAudioProcessor();
+  switched.setFilterCutoff(20000);
+  let largestStep = 0;
+  let previousSample = 0;
+  for (let block = 0; block < 40; block++) {
+    if (block % 10 === 0 && block > 0) {
+      switched.setFlangerEnabled(block !== 20);
+    }
+    const sine = new Float32Array(2 * 512).map((_, i) => 0.5 * Math.sin(0.02 * (block * 512 + (i % 512))));
+    switched.processAudio(sine);
+    for (let i = 0; i < 512; i++) {
+      if (block > 4) {
+        largestStep = Math.max(largestStep, Math.abs(sine[i] - previousSample));
+      }
+      previousSample = sine[i];
+    }
+  }
+  if (largestStep > 0.015) {
+    throw new Error(`switching the flanger should not click (step of ${largestStep})`);
+  }
+
+  console.log("✓ Flanger switched without clicks");
+
+  // Test the oversampled filter: the factor is per processor, and switching
+  // the mode on adds its latency until it is switched off again
+  const oversampled = new JUCEAudioProcessor();
+  oversampled.prepareToPlay(44100, 512);
+  const plainLatency = oversampled.getLatencySamples();
+  oversampled.setFilterOversamplingFactor(4);
+  oversampled.setFilterOversampled(true);
+  const oversampledBlock = new Float32Array(2 * 512).map((_, i) => Math.sin(i * 0.9) * 0.25);
+  oversampled.processAudio(oversampledBlock);
+  if (oversampled.getFilterOversamplingFactor() !== 4 || oversampled.getLatencySamples() <= plainLatency ||
+      oversampledBlock.some((sample) => !Number.isFinite(sample))) {
+    throw new Error("the oversampled filter should run and report its latency");
+  }
+  oversampled.setFilterOversampled(false);
+  let factorRejected = false;
+  try {
+    oversampled.setFilterOversamplingFactor(3);
+  } catch (error) {
+    factorRejected = error instanceof RangeError;
+  }
+  if (oversampled.getLatencySamples() !== plainLatency || !factorRejected) {
+    throw new Error("switching the oversampled filter off should remove its latency");
+  }
+
+  // Switching the mode while playing crossfades between the filters, so the
+  // change of latency doesn't make a sine jump by more than its own slope
+  const modeSwitched = new JUCEAudioProcessor();
+  modeSwitched.setFilterOversamplingFactor(4);
+  modeSwitched.prepareToPlay(44100, 512);
+  modeSwitched.setFilterResonance(0.7);
+  largestStep = 0;
+  for (let block = 0; block < 40; block++) {
+    if (block % 10 === 0 && block > 0) {
+      modeSwitched.setFilterOversampled(block !== 20);
+    }
+    const sine = new Float32Array(2 * 512).map((_, i) => 0.5 * Math.sin(0.1 * (block * 512 + (i % 512))));
+    modeSwitched.processAudio(sine);
+    for (let i = 0; i < 512; i++) {
+      if (block > 4) {
+        largestStep = Math.max(largestStep, Math.abs(sine[i] - previousSample));
+      }
+      previousSample = sine[i];
+    }
+  }
+  if (largestStep > 0.06) {
+    throw new Error(`switching the filter oversampling should not click (step of ${largestStep})`);
+  }
+
+  console.log("✓ Filter oversampled on demand");
+
+  // Test the isolator: killing the low band removes a bass sine, killing the
+  // high band leaves it alone
+  const isolated = new JUCEAudioProcessor();
+  isolated.prepareToPlay(44100, 512);
+  isolated.setFilterCutoff(20000);
+  const bassLevel = (low, high) => {
+    isolated.setParameters({ eqLow: low, eqHigh: high });
+    const bass = new Float32Array(2 * 512);
+    for (let block = 0; block < 20; block++) {
+      bass.forEach((_, i) => (bass[i] = 0.5 * Math.sin((2 * Math.PI * 60 * (block * 512 + (i % 512))) / 44100)));
+      isolated.processAudio(bass);
+    }
+    return Math.sqrt(bass.reduce((total, sample) => total + sample * sample, 0) / bass.length);
+  };
+  const killedLevel = bassLevel(0, 1);
+  const keptLevel = bassLevel(1, 0);
+  if (killedLevel > 0.02 || keptLevel < 0.3) {
+    throw new Error(`the isolator should kill only its own band (${killedLevel}, ${keptLevel})`);
+  }
+
+  // At unity gain the isolator still shifts the phase, most at its crossovers,
+  // so a band leaving or returning to 1 must not dip a sine at 300 Hz
+  const unity = new JUCEAudioProcessor();
+  unity.prepareToPlay(44100, 512);
+  unity.setFilterCutoff(20000);
+  const unityOutput = [];
+  for (let block = 0; block < 60; block++) {
+    if (block === 20 || block === 40) {
+      unity.setEqLow(block === 20 ? 0.99 : 1);
+    }
+    const sine = new Float32Array(2 * 512).map((_, i) => 0.5 * Math.sin((2 * Math.PI * 300 * (block * 512 + (i % 512))) / 44100));
+    unity.processAudio(sine);
+    if (block >= 10) {
+      unityOutput.push(...sine.subarray(0, 512));
+    }
+  }
+  // The peak over every period of the sine
+  let quietestPeriod = Infinity;
+  for (let start = 0; start + 147 <= unityOutput.length; start += 147) {
+    quietestPeriod = Math.min(quietestPeriod, Math.max(...unityOutput.slice(start, start + 147).map(Math.abs)));
+  }
+  if (quietestPeriod < 0.45) {
+    throw new Error(`a band moving away from unity should not notch the crossover (peak of ${quietestPeriod})`);
+  }
+
+  // Below 8 kHz the high crossover would sit above Nyquist; it is brought
+  // down instead, so a mono stream at a low rate stays finite
+  const lowRate = new JUCEAudioProcessor();
+  lowRate.prepareToPlay(6000, 256);
+  lowRate.setEqHigh(0.5);
+  let lowRateFinite = true;
+  for (let block = 0; block < 100; block++) {
+    const noise = new Float32Array(256).map(() => Math.random() - 0.5);
+    lowRate.processAudio(noise, 1);
+    lowRateFinite = lowRateFinite && noise.every(Number.isFinite);
+  }
+  if (!lowRateFinite) {
+    throw new Error("the isolator should stay stable at low sample rates");
+  }
+
+  console.log("✓ Isolator EQ kills a band");
+
+  // Test stem mode: every stem runs through effect state of its own, so each
+  // one comes out as it would from a stereo processor
+  const stems = new JUCEAudioProcessor();
+  const stemReference = new JUCEAudioProcessor();
+  stems.setStemCount(2);
+  for (const target of [stems, stemReference]) {
+    target.setParameters({ filterCutoff: 500, filterResonance: 1.5, flangerEnabled: true });
+  }
+  const stem = new Float32Array(2 * 256).map((_, i) => Math.sin(i * 0.07) * 0.5);
+  const stemBlock = new Float32Array(4 * 256);
+  stemBlock.set(stem.map((sample) => -sample), 0);
+  stemBlock.set(stem, 2 * 256);
+  stems.processAudio(stemBlock);
+  stemReference.processAudio(stem);
+  if (stems.getStemCount() !== 2 || stemBlock.subarray(2 * 256).some((sample, i) => sample !== stem[i])) {
+    throw new Error("each stem should be processed independently");
+  }
+
+  console.log("✓ Stems processed side by side");
+
+  // Test the spectrum analyser: a 1 kHz sine shows up in its band once the worker has caught up.
+  // It gets a processor of its own, as the audio device test below re-prepares the shared one.
+  const analysed = new JUCEAudioProcessor();
+  analysed.prepareToPlay(44100, 512);
+  const spectrumBuffer = new Float32Array(JUCEAudioProcessor.SpectrumFields.length);
+  analysed.setSpectrumEnabled(true);
+  analysed.setSpectrumBuffer(spectrumBuffer);
+  for (let block = 0; block < 20; block++) {
+    const sine = new Float32Array(2 * 512);
+    for (let i = 0; i < 512; i++) {
+      sine[i] = sine[512 + i] = 0.5 * Math.sin((2 * Math.PI * 1000 * (block * 512 + i)) / 44100);
+    }
+    analysed.processAudio(sine);
+  }
+
+  // Polls until a frame holding the sine has been published, and fails if none arrives in time
+  const spectrumAnalysed = new Promise((resolve, reject) => {
+    const deadline = Date.now() + 2000;
+    const poll = () => {
+      const { frequencies, peaks } = analysed.getSpectrum();
+      const loudest = peaks.indexOf(Math.max(...peaks));
+
+      if (peaks[loudest] > -100) {
+        analysed.setSpectrumBuffer(null);
+        analysed.setSpectrumEnabled(false);
+        resolve({ frequency: frequencies[loudest], numBands: peaks.length });
+      } else if (Date.now() > deadline) {
+        reject(new Error("the spectrum analyser should publish a frame within two seconds"));
+      } else {
+        setTimeout(poll, 10);
+      }
+    };
+    poll();
+  });
+
+  // Test track playback: a loaded track replaces the input and plays once started
+  const deck = new JUCEAudioProcessor();
+  const track = new Float32Array(2 * 24000).map((_, i) => Math.sin(i * 0.05));
+  deck.prepareToPlay(48000, 256);
+  deck.loadTrack(track, 48000);
+  deck.play();
+
+  for (let block = 0; block < 20; block++) {
+    deck.processAudio(planar.fill(0));
+  }
+
+  if (Math.abs(deck.getTrackLength() - 0.5) > 1e-6 || !(deck.getPlayPosition() > 0.05)) {
+    throw new Error("a loaded track should play from native memory");
+  }
+
+  deck.setJogWheelTouched(true);
+  deck.setJogWheelPosition(0);
+  deck.setJogWheelPosition(-0.01);
+  deck.unloadTrack();
+
+  console.log("✓ Track played with the jog wheel");
+
+  // Test the native playback engine on the headless null device
+  const device = processor.startAudioDevice({ type: "Null", bufferSize: 128 });
+  if (!processor.isAudioDeviceRunning() || device.bufferSize !== 128) {
+    throw new Error("null audio device should be running");
+  }
+  processor.setFilterCutoff(2000);
+  processor.getMeters();
+  processor.stopAudioDevice();
+
+  console.log("✓ Native playback engine started and stopped");
+
+  // Test the multi-deck engine: a deck hard left on the crossfader is silent at position 1
+  if (JUCEAudioProcessor.DeckEngine) {
+    const decks = new JUCEAudioProcessor.DeckEngine(2);
+    const master = new Float32Array(2 * 128);
+
+    decks.prepareToPlay(48000, 128);
+    decks.setDeckParameter(1, "volume", 0.5);
+    decks.setCrossfaderAssignment(0, "A");
+    decks.setCrossfader(1);
+    decks.process(new Float32Array(2 * 2 * 128).fill(0.5), master);
+
+    // Deck 0 plays into the closed side, deck 1 is silent; run past the latency and tail of the deck chains
+    for (let block = 0; block < 30; block++) {
+      decks.process([new Float32Array(256).fill(0.5), new Float32Array(256)], master);
+    }
+    if (master.some((sample) => sample !== 0)) {
+      throw new Error("a deck crossfaded out should contribute nothing to the master bus");
+    }
+
+    for (let block = 0; block < 20; block++) {
+      decks.process([new Float32Array(256).fill(0.5), new Float32Array(256).fill(0.5)], master);
+    }
+    if (decks.getNumDecks() !== 2 || master[255] === 0) {
+      throw new Error("deck engine should mix the decks onto the master bus");
+    }
+
+    let lengthRejected = false;
+    try {
+      decks.process([new Float32Array(512), new Float32Array(256)], master);
+    } catch (error) {
+      lengthRejected = error instanceof TypeError;
+    }
+    if (!lengthRejected) {
+      throw new Error("deck inputs longer than the output should be rejected");
+    }
+
+    console.log("✓ Decks mixed onto the master bus");
+  }
+
+  // Test the shared memory channel: both ends in one process, each reading what the other wrote
+  if (JUCEAudioProcessor.SharedMemoryChannel) {
+    const name = `test-${process.pid}`;
+    const server = JUCEAudioProcessor.SharedMemoryChannel.create(name, { audioBytes: 65536 });
+    const client = JUCEAudioProcessor.SharedMemoryChannel.open(name);
+    const received = new Float32Array(256);
+
+    client.send(new Float32Array([JUCEAudioProcessor.Parameters.volume, 0.25]));
+    server.send("ready");
+    server.writeAudio(new Float32Array(256).fill(0.5), 7);
+
+    const changes = server.receive();
+    const block = client.readAudio(received);
+
+    if (client.receive() !== "ready" || changes[1] !== 0.25 || block.tag !== 7 || received[255] !== 0.5 ||
+        client.readAudio(received) !== null || server.wait(0)) {
+      throw new Error("shared memory channel should pass messages both ways");
+    }
+
+    client.close();
+    server.close();
+
+    console.log("✓ Messages passed through shared memory");
+
+    // Messages of mixed sizes wrap around the smallest control ring many times over, and
+    // must neither spill into the audio ring next to it nor let the writer overrun the reader
+    const ring = JUCEAudioProcessor.SharedMemoryChannel.create(`${name}-wrap`, { controlBytes: 4096, audioBytes: 4096 });
+    const peer = JUCEAudioProcessor.SharedMemoryChannel.open(`${name}-wrap`);
+
+    ring.writeAudio(new Float32Array(16).fill(0.5), 3);
+
+    for (let i = 0; i < 3000; i++) {
+      const text = "x".repeat([0, 8, 1, 24, 0, 0, 13, 100][i % 8] + (i % 3));
+
+      if (!ring.send(text) || peer.receive() !== text) {
+        throw new Error(`message ${i} of ${text.length} bytes did not come back intact`);
+      }
+    }
+
+    let accepted = 0;
+
+    while (accepted < 1000 && ring.send("")) {
+      accepted++;
+    }
+
+    const pending = peer.readAudio(received);
+
+    if (peer.receive() !== "" || accepted !== 4096 / 16 || pending.tag !== 3 || pending.length !== 16 ||
+        received[15] !== 0.5 || peer.readAudio(received) !== null) {
+      throw new Error("a full control ring should hold one header-sized record per 16 bytes and leave the audio ring alone");
+    }
+
+    peer.close();
+    ring.close();
+
+    console.log("✓ Mixed message sizes wrapped around the shared memory ring");
+  }
+
+  // Test asynchronous processing on the native worker pool
+  const blocks = [new Float32Array(512), new Float32Array(512)];
+
+  // Test offline rendering: the rendered buffer keeps the length of the input
+  const recording = new Float32Array(2 * 10000).fill(0.5);
+  const interleavedRecording = new Float32Array(2 * 10000).map((_, i) => (i % 2 ? -0.25 : 0.5));
+
+  // Test the child process wrapper: concurrent calls to the same method each get their own reply,
+  // and a call made while the child is killed is answered by the standby. Calls made before the
+  // child is up go over IPC, and with the native addon later ones go through shared memory.
+  const wrapper = new AudioProcessorWrapper();
+  wrapper.setVolume(0.5);
+  wrapper.setFilterCutoff(800);
+
+  const wrapperCalls = Promise.all([
+    wrapper.processAudio(new Float32Array(4).fill(0.25), 1),
+    wrapper.processAudio(new Float32Array(8).fill(0.5), 1),
+  ])
+    .then((results) => {
+      if (JUCEAudioProcessor.SharedMemoryChannel && !wrapper.child.sharedMemory) {
+        throw new Error("the wrapper should open a shared memory channel to a native child");
+      }
+
+      wrapper.setVolume(0);
+      return Promise.all([...results, wrapper.processAudio(new Float32Array(32).fill(0.5), 1)]);
+    })
+    .then((results) => {
+      wrapper.child.kill("SIGKILL");
+      return Promise.all([...results, wrapper.processAudio(new Float32Array(16), 1)]);
+    })
+    .finally(() => wrapper.destroy());
+
+  Promise.all([
+    wrapperCalls,
+    processor.processAudioAsync(new Float32Array(512)),
+    processor.processAudioBatch(blocks),
+    JUCEAudioProcessor.renderBuffer(recording, 44100, { parameters: { volume: 0.5 } }),
+    spectrumAnalysed,
+    JUCEAudioProcessor.renderBuffer(recording, 44100, { parameters: { volume: 0.5 }, precision: "double" }),
+    JUCEAudioProcessor.renderBuffer(interleavedRecording, 44100, { interleaved: true }),
+    JUCEAudioProcessor.renderBuffer(new Float32Array(3), 44100).then(
+      () => false,
+      (error) => error instanceof TypeError
+    ),
+  ])
+    .then(([wrapped, single, batch, rendered, spectrum, renderedDouble, renderedInterleaved, raggedRejected]) => {
+      if (wrapped[0].length !== 4 || wrapped[1].length !== 8 || !(wrapped[2] instanceof Float32Array) ||
+          wrapped[2].length !== 32 || wrapped[3].length !== 16) {
+        throw new Error("wrapper calls should be answered by sequence number, even across a crash");
+      }
+
+      if (!(single instanceof Float32Array) || batch !== blocks) {
+        throw new Error("async processing should resolve with the given buffers");
+      }
+
+      if (rendered.length !== 2 || rendered[0].length !== 10000) {
+        throw new Error("offline rendering should keep the length of the input");
+      }
+
+      if (renderedDouble[0].length !== 10000 || rendered[0].some((sample, i) => Math.abs(sample - renderedDouble[0][i]) > 1e-4) ||
+          Math.abs(renderedDouble[0][9999]) < 0.1) {
+        throw new Error("a double precision render should match the single precision one");
+      }
+
+      if (renderedInterleaved.length !== 2 || renderedInterleaved[0].length !== 10000 ||
+          !(renderedInterleaved[0][9999] > 0.4) || !(renderedInterleaved[1][9999] < -0.2) || !raggedRejected) {
+        throw new Error("an interleaved render should split its channels, and a ragged buffer should be rejected");
+      }
+
+      if (spectrum.numBands !== JUCEAudioProcessor.SpectrumFields.numBands || spectrum.frequency < 700 ||
+          spectrum.frequency > 1400 || new Uint32Array(spectrumBuffer.buffer)[0] % 2 !== 0) {
+        throw new Error("the loudest spectrum band should hold the sine");
+      }
+
+      console.log("✓ Calls pipelined through the child process wrapper, across a crash");
+      console.log("✓ Audio processed asynchronously");
+      console.log("✓ Buffer rendered offline, in single and double precision");
+      console.log("✓ Spectrum analysed");
+      console.log("✓ JUCE Audio Processor is working correctly!");
+    })
+    .catch((error) => {
+      console.error("✗ Error testing async processing:", error.message);
+      process.exit(1);
+    });
 } catch (error) {
   console.error("✗ Error testing processor:", error.message);
   process.exit(1);